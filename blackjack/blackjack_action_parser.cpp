@@ -0,0 +1,714 @@
+// blackjack_action_parser.cpp
+// Analyse des messages texte des terminaux (WsHub) sans allocation.
+// - Un seul passage sur une std::string_view : aucune copie ni mise en minuscules du message.
+// - Accepte le mot brut ("tirer_carte", "PRET"...) ou un objet JSON plat
+//   {"action":"...","table":T,"siege":N,"seq":S,"jeton":"hex"} ; clés inconnues ignorées (valeurs imbriquées
+//   sautées), chaînes avec échappements (\" \\ \uXXXX) correctement délimitées.
+// - "telemetrie" porte en plus les champs numériques du relevé du terminal (TelemetrySample).
+// - L'action est rendue sous forme d'enum ; noms d'action et clés insensibles à la casse.
+// - Entrée malformée (tronquée, guillemet non fermé, ':' manquant...) -> WsAction::None.
+// À inclure avant blackjack_ws_hub.cpp.
+// C++17
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+enum class WsAction : uint8_t
+{
+  None, // message vide, inconnu ou malformé
+  TirerCarte,
+  Pret,
+  Stand,
+  Double,
+  Rejouer,
+  Rejoindre,
+  Resync,
+  Regarder,  // spectateur (lecture seule)
+  Reprendre, // reprise de session après reconnexion (jeton)
+  Telemetrie, // relevé périodique du terminal (sans effet sur la partie)
+};
+
+// Relevé de télémétrie d'un terminal sur sa dernière période d'envoi ; champ absent = 0
+struct TelemetrySample
+{
+  uint32_t loopAvgUs = 0;  // boucle_us : durée moyenne d'une itération de loop()
+  uint32_t loopMaxUs = 0;  // boucle_max_us
+  uint32_t jpegCount = 0;  // jpeg_n : cartes décodées et affichées sur la période
+  uint32_t jpegAvgUs = 0;  // jpeg_us
+  uint32_t jpegMaxUs = 0;  // jpeg_max_us
+  uint32_t heapFree = 0;   // tas_libre (octets)
+  uint32_t heapMin = 0;    // tas_min : plus bas niveau depuis le démarrage
+  int rssi = 0;            // rssi WiFi (dBm ; 0 = inconnu)
+  uint32_t reconnects = 0; // reconnexions WebSocket depuis le démarrage
+};
+
+struct ParsedAction
+{
+  WsAction action = WsAction::None;
+  int table = -1; // -1 : champ absent ou invalide
+  int siege = -1;
+  long long seq = -1;
+  uint64_t jeton = 0; // jeton de session (16 chiffres hexa) ; 0 : absent ou invalide
+  TelemetrySample telemetry; // action Telemetrie uniquement
+};
+
+namespace action_parser
+{
+  constexpr int kMaxDepth = 16; // imbrication max des valeurs ignorées
+
+  inline char lower(char c) { return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c; }
+
+  inline bool iequals(std::string_view a, std::string_view b)
+  {
+    if (a.size() != b.size())
+      return false;
+    for (size_t i = 0; i < a.size(); ++i)
+      if (lower(a[i]) != b[i])
+        return false;
+    return true;
+  }
+
+  inline WsAction actionFromName(std::string_view s)
+  {
+    // Tri sur la longueur d'abord : une seule comparaison complète au plus
+    switch (s.size())
+    {
+    case 4:
+      return iequals(s, "pret") ? WsAction::Pret : WsAction::None;
+    case 5:
+      return iequals(s, "stand") ? WsAction::Stand : WsAction::None;
+    case 6:
+      if (iequals(s, "double"))
+        return WsAction::Double;
+      return iequals(s, "resync") ? WsAction::Resync : WsAction::None;
+    case 7:
+      return iequals(s, "rejouer") ? WsAction::Rejouer : WsAction::None;
+    case 8:
+      return iequals(s, "regarder") ? WsAction::Regarder : WsAction::None;
+    case 9:
+      if (iequals(s, "rejoindre"))
+        return WsAction::Rejoindre;
+      return iequals(s, "reprendre") ? WsAction::Reprendre : WsAction::None;
+    case 10:
+      return iequals(s, "telemetrie") ? WsAction::Telemetrie : WsAction::None;
+    case 11:
+      return iequals(s, "tirer_carte") ? WsAction::TirerCarte : WsAction::None;
+    default:
+      return WsAction::None;
+    }
+  }
+
+  inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+  inline bool isHex(char c) { return (c >= '0' && c <= '9') || (lower(c) >= 'a' && lower(c) <= 'f'); }
+
+  // Curseur sur le message ; toutes les fonctions retournent false si le JSON est malformé
+  struct Cursor
+  {
+    std::string_view s;
+    size_t i = 0;
+
+    bool end() const { return i >= s.size(); }
+    char peek() const { return s[i]; }
+
+    void skipSpace()
+    {
+      while (i < s.size() && isSpace(s[i]))
+        ++i;
+    }
+
+    bool expect(char c)
+    {
+      skipSpace();
+      if (end() || s[i] != c)
+        return false;
+      ++i;
+      return true;
+    }
+
+    // Chaîne JSON ; out = contenu brut entre guillemets, escaped = contient des échappements
+    bool string(std::string_view &out, bool &escaped)
+    {
+      skipSpace();
+      if (end() || s[i] != '"')
+        return false;
+      const size_t start = ++i;
+      escaped = false;
+      while (i < s.size())
+      {
+        const char c = s[i];
+        if (c == '"')
+        {
+          out = s.substr(start, i - start);
+          ++i;
+          return true;
+        }
+        if (c == '\\')
+        {
+          escaped = true;
+          if (i + 1 >= s.size())
+            return false;
+          if (s[i + 1] == 'u')
+          {
+            for (size_t k = i + 2; k < i + 6; ++k)
+              if (k >= s.size() || !isHex(s[k]))
+                return false;
+            i += 6;
+          }
+          else
+          {
+            i += 2;
+          }
+          continue;
+        }
+        if ((unsigned char)c < 0x20)
+          return false; // caractère de contrôle non échappé
+        ++i;
+      }
+      return false; // guillemet fermant manquant
+    }
+
+    // Entier (partie fractionnaire / exposant acceptés mais ignorés) ; ok=false si hors plage
+    bool number(long long &out, bool &ok)
+    {
+      skipSpace();
+      const size_t start = i;
+      bool neg = false;
+      if (i < s.size() && s[i] == '-')
+      {
+        neg = true;
+        ++i;
+      }
+      if (end() || s[i] < '0' || s[i] > '9')
+        return false;
+      long long v = 0;
+      ok = true;
+      while (i < s.size() && s[i] >= '0' && s[i] <= '9')
+      {
+        if (v > 100000000000LL)
+          ok = false;
+        else
+          v = v * 10 + (s[i] - '0');
+        ++i;
+      }
+      if (i < s.size() && s[i] == '.')
+      {
+        ok = false; // pas d'entier
+        ++i;
+        while (i < s.size() && s[i] >= '0' && s[i] <= '9')
+          ++i;
+      }
+      if (i < s.size() && (s[i] == 'e' || s[i] == 'E'))
+      {
+        ok = false;
+        ++i;
+        if (i < s.size() && (s[i] == '+' || s[i] == '-'))
+          ++i;
+        while (i < s.size() && s[i] >= '0' && s[i] <= '9')
+          ++i;
+      }
+      out = neg ? -v : v;
+      return i > start;
+    }
+
+    bool literal(std::string_view word)
+    {
+      skipSpace();
+      if (s.substr(i, word.size()) != word)
+        return false;
+      i += word.size();
+      return true;
+    }
+
+    // Saute une valeur quelconque (objets / tableaux imbriqués compris)
+    bool skipValue(int depth = 0)
+    {
+      if (depth > kMaxDepth)
+        return false;
+      skipSpace();
+      if (end())
+        return false;
+      std::string_view sv;
+      bool esc;
+      long long n;
+      bool ok;
+      switch (peek())
+      {
+      case '"':
+        return string(sv, esc);
+      case '{':
+        ++i;
+        skipSpace();
+        if (!end() && peek() == '}')
+        {
+          ++i;
+          return true;
+        }
+        while (true)
+        {
+          if (!string(sv, esc) || !expect(':') || !skipValue(depth + 1))
+            return false;
+          skipSpace();
+          if (end())
+            return false;
+          if (peek() == ',')
+          {
+            ++i;
+            continue;
+          }
+          if (peek() == '}')
+          {
+            ++i;
+            return true;
+          }
+          return false;
+        }
+      case '[':
+        ++i;
+        skipSpace();
+        if (!end() && peek() == ']')
+        {
+          ++i;
+          return true;
+        }
+        while (true)
+        {
+          if (!skipValue(depth + 1))
+            return false;
+          skipSpace();
+          if (end())
+            return false;
+          if (peek() == ',')
+          {
+            ++i;
+            continue;
+          }
+          if (peek() == ']')
+          {
+            ++i;
+            return true;
+          }
+          return false;
+        }
+      case 't':
+        return literal("true");
+      case 'f':
+        return literal("false");
+      case 'n':
+        return literal("null");
+      default:
+        return number(n, ok);
+      }
+    }
+  };
+
+  enum class Key : uint8_t
+  {
+    Other,
+    Action,
+    Table,
+    Siege,
+    Seq,
+    Jeton,
+    // Relevé de télémétrie
+    LoopAvg,
+    LoopMax,
+    JpegCount,
+    JpegAvg,
+    JpegMax,
+    HeapFree,
+    HeapMin,
+    Rssi,
+    Reconnects,
+  };
+
+  inline Key keyFromName(std::string_view k)
+  {
+    if (iequals(k, "action"))
+      return Key::Action;
+    if (iequals(k, "table"))
+      return Key::Table;
+    if (iequals(k, "siege"))
+      return Key::Siege;
+    if (iequals(k, "seq"))
+      return Key::Seq;
+    if (iequals(k, "jeton"))
+      return Key::Jeton;
+    if (iequals(k, "boucle_us"))
+      return Key::LoopAvg;
+    if (iequals(k, "boucle_max_us"))
+      return Key::LoopMax;
+    if (iequals(k, "jpeg_n"))
+      return Key::JpegCount;
+    if (iequals(k, "jpeg_us"))
+      return Key::JpegAvg;
+    if (iequals(k, "jpeg_max_us"))
+      return Key::JpegMax;
+    if (iequals(k, "tas_libre"))
+      return Key::HeapFree;
+    if (iequals(k, "tas_min"))
+      return Key::HeapMin;
+    if (iequals(k, "rssi"))
+      return Key::Rssi;
+    if (iequals(k, "reconnexions"))
+      return Key::Reconnects;
+    return Key::Other;
+  }
+
+  inline int toField(long long v, bool ok) { return (ok && v >= 0 && v <= 1000000) ? (int)v : -1; }
+
+  // Compteur de télémétrie borné à 32 bits ; 0 si invalide
+  inline uint32_t toCounter(long long v, bool ok) { return (ok && v >= 0) ? (uint32_t)std::min<long long>(v, UINT32_MAX) : 0; }
+
+  inline void setTelemetry(TelemetrySample &t, Key k, long long v, bool ok)
+  {
+    switch (k)
+    {
+    case Key::LoopAvg:
+      t.loopAvgUs = toCounter(v, ok);
+      break;
+    case Key::LoopMax:
+      t.loopMaxUs = toCounter(v, ok);
+      break;
+    case Key::JpegCount:
+      t.jpegCount = toCounter(v, ok);
+      break;
+    case Key::JpegAvg:
+      t.jpegAvgUs = toCounter(v, ok);
+      break;
+    case Key::JpegMax:
+      t.jpegMaxUs = toCounter(v, ok);
+      break;
+    case Key::HeapFree:
+      t.heapFree = toCounter(v, ok);
+      break;
+    case Key::HeapMin:
+      t.heapMin = toCounter(v, ok);
+      break;
+    case Key::Rssi:
+      t.rssi = (ok && v >= -127 && v <= 0) ? (int)v : 0;
+      break;
+    case Key::Reconnects:
+      t.reconnects = toCounter(v, ok);
+      break;
+    default:
+      break;
+    }
+  }
+
+  // 1..16 chiffres hexadécimaux (casse indifférente) ; 0 si invalide
+  inline uint64_t toJeton(std::string_view s)
+  {
+    if (s.empty() || s.size() > 16)
+      return 0;
+    uint64_t v = 0;
+    for (char ch : s)
+    {
+      const char l = lower(ch);
+      if (l >= '0' && l <= '9')
+        v = (v << 4) | (uint64_t)(l - '0');
+      else if (l >= 'a' && l <= 'f')
+        v = (v << 4) | (uint64_t)(l - 'a' + 10);
+      else
+        return 0;
+    }
+    return v;
+  }
+} // namespace action_parser
+
+// Analyse un message texte. Retourne false (out.action = None) si le message est inconnu ou
+// malformé ; les champs numériques absents ou invalides valent -1.
+static bool parseAction(std::string_view msg, ParsedAction &out)
+{
+  using namespace action_parser;
+  out = ParsedAction{};
+
+  Cursor c{msg};
+  c.skipSpace();
+  if (c.end())
+    return false;
+
+  // 1) texte brut (espaces autour tolérés)
+  if (c.peek() != '{')
+  {
+    size_t e = msg.size();
+    while (e > c.i && isSpace(msg[e - 1]))
+      --e;
+    out.action = actionFromName(msg.substr(c.i, e - c.i));
+    return out.action != WsAction::None;
+  }
+
+  // 2) objet JSON plat
+  ++c.i;
+  c.skipSpace();
+  if (!c.end() && c.peek() == '}')
+    return false;
+  ParsedAction r;
+  while (true)
+  {
+    std::string_view key;
+    bool escaped = false;
+    if (!c.string(key, escaped) || !c.expect(':'))
+      return false;
+    const Key k = escaped ? Key::Other : keyFromName(key);
+    c.skipSpace();
+    if (c.end())
+      return false;
+
+    if (k == Key::Action && c.peek() == '"')
+    {
+      std::string_view v;
+      if (!c.string(v, escaped))
+        return false;
+      r.action = escaped ? WsAction::None : actionFromName(v); // noms d'action sans échappement
+    }
+    else if (k == Key::Jeton && c.peek() == '"')
+    {
+      std::string_view v;
+      if (!c.string(v, escaped))
+        return false;
+      r.jeton = escaped ? 0 : toJeton(v);
+    }
+    else if (k != Key::Other && k != Key::Action && k != Key::Jeton && (c.peek() == '-' || (c.peek() >= '0' && c.peek() <= '9')))
+    {
+      long long v = 0;
+      bool ok = false;
+      if (!c.number(v, ok))
+        return false;
+      if (k == Key::Table)
+        r.table = toField(v, ok);
+      else if (k == Key::Siege)
+        r.siege = toField(v, ok);
+      else if (k == Key::Seq)
+        r.seq = (ok && v >= 0) ? v : -1;
+      else
+        setTelemetry(r.telemetry, k, v, ok);
+    }
+    else if (!c.skipValue())
+    {
+      return false;
+    }
+
+    c.skipSpace();
+    if (c.end())
+      return false;
+    if (c.peek() == ',')
+    {
+      ++c.i;
+      continue;
+    }
+    if (c.peek() != '}')
+      return false;
+    ++c.i;
+    break;
+  }
+  c.skipSpace();
+  if (!c.end())
+    return false; // données après l'objet
+
+  if (r.action == WsAction::None)
+    return false;
+  out = r;
+  return true;
+}
+
+// ============================= Banc d'essai / corpus =============================
+
+#ifdef BLACKJACK_PARSER_BENCH
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Ancienne version (copie minuscule + find) : référence de débit
+static std::string legacyParseAction(const std::string &s)
+{
+  std::string t;
+  t.reserve(s.size());
+  for (char c : s)
+    t.push_back((char)std::tolower((unsigned char)c));
+  if (t == "tirer_carte" || t == "pret" || t == "stand" || t == "double" || t == "rejouer" || t == "rejoindre" || t == "resync" || t == "regarder" || t == "reprendre")
+    return t;
+  auto p = t.find("\"action\"");
+  if (p == std::string::npos)
+    return {};
+  p = t.find(':', p);
+  if (p == std::string::npos)
+    return {};
+  p = t.find('"', p);
+  if (p == std::string::npos)
+    return {};
+  auto q = t.find('"', p + 1);
+  if (q == std::string::npos)
+    return {};
+  return t.substr(p + 1, q - (p + 1));
+}
+
+struct CorpusCase
+{
+  const char *msg;
+  WsAction action;
+  int table;
+  int siege;
+  long long seq;
+  uint64_t jeton = 0;
+};
+
+// Entrées valides, limites et malformées : chaque ligne donne le résultat attendu
+static const CorpusCase kCorpus[] = {
+    {"tirer_carte", WsAction::TirerCarte, -1, -1, -1},
+    {"  PRET \r\n", WsAction::Pret, -1, -1, -1},
+    {"Stand", WsAction::Stand, -1, -1, -1},
+    {"{\"action\":\"double\"}", WsAction::Double, -1, -1, -1},
+    {"{ \"action\" : \"Rejouer\" }", WsAction::Rejouer, -1, -1, -1},
+    {"{\"action\":\"rejoindre\",\"table\":2,\"siege\":3}", WsAction::Rejoindre, 2, 3, -1},
+    {"{\"siege\":1,\"action\":\"rejoindre\"}", WsAction::Rejoindre, -1, 1, -1},
+    {"{\"action\":\"regarder\",\"table\":7}", WsAction::Regarder, 7, -1, -1},
+    {"{\"action\":\"reprendre\",\"jeton\":\"00ab34cdEF561278\"}", WsAction::Reprendre, -1, -1, -1, 0x00ab34cdef561278ULL},
+    {"{\"jeton\":\"1\",\"action\":\"REPRENDRE\"}", WsAction::Reprendre, -1, -1, -1, 1},
+    {"{\"action\":\"reprendre\",\"jeton\":\"00ab34cdef5612789\"}", WsAction::Reprendre, -1, -1, -1, 0},
+    {"{\"action\":\"reprendre\",\"jeton\":\"12g4\"}", WsAction::Reprendre, -1, -1, -1, 0},
+    {"{\"action\":\"reprendre\",\"jeton\":1234}", WsAction::Reprendre, -1, -1, -1, 0},
+    {"{\"ACTION\":\"TIRER_CARTE\",\"seq\":4294967296}", WsAction::TirerCarte, -1, -1, 4294967296LL},
+    {"{\"action\":\"telemetrie\",\"boucle_us\":812,\"rssi\":-61,\"tas_libre\":181204,\"seq\":3}", WsAction::Telemetrie, -1, -1, 3},
+    {"{\"action\":\"resync\",\"x\":{\"a\":[1,2,{\"b\":\"}\"}]},\"ok\":true,\"n\":null}", WsAction::Resync, -1, -1, -1},
+    {"{\"note\":\"il a dit \\\"action\\\":\\\"double\\\"\",\"action\":\"pret\"}", WsAction::Pret, -1, -1, -1},
+    {"{\"action\":\"rejoindre\",\"siege\":-1,\"table\":1.5}", WsAction::Rejoindre, -1, -1, -1},
+    {"{\"action\":\"rejoindre\",\"siege\":\"2\"}", WsAction::Rejoindre, -1, -1, -1},
+    {"{\"action\":\"rejoindre\",\"siege\":99999999999999999999}", WsAction::Rejoindre, -1, -1, -1},
+    {"{\"act\\u0069on\":\"pret\"}", WsAction::None, -1, -1, -1},
+    {"{\"action\":\"pr\\u0065t\"}", WsAction::None, -1, -1, -1},
+    {"", WsAction::None, -1, -1, -1},
+    {"   ", WsAction::None, -1, -1, -1},
+    {"{}", WsAction::None, -1, -1, -1},
+    {"{", WsAction::None, -1, -1, -1},
+    {"{\"action\"", WsAction::None, -1, -1, -1},
+    {"{\"action\":", WsAction::None, -1, -1, -1},
+    {"{\"action\":\"pret", WsAction::None, -1, -1, -1},
+    {"{\"action\":\"pret\"", WsAction::None, -1, -1, -1},
+    {"{\"action\" \"pret\"}", WsAction::None, -1, -1, -1},
+    {"{\"action\":\"pret\",}", WsAction::None, -1, -1, -1},
+    {"{\"action\":\"pret\"}}", WsAction::None, -1, -1, -1},
+    {"{\"action\":\"pret\"} x", WsAction::None, -1, -1, -1},
+    {"{\"action\":pret}", WsAction::None, -1, -1, -1},
+    {"{\"action\":\"voler\"}", WsAction::None, -1, -1, -1},
+    {"{\"action\":\"pret\\", WsAction::None, -1, -1, -1},
+    {"{\"action\":\"pret\\u00\"}", WsAction::None, -1, -1, -1},
+    {"{\"x\":[[[[[[[[[[[[[[[[[[[[1]]]]]]]]]]]]]]]]]]],\"action\":\"pret\"}", WsAction::None, -1, -1, -1},
+    {"{\"x\":tru,\"action\":\"pret\"}", WsAction::None, -1, -1, -1},
+    {"{\"x\":-,\"action\":\"pret\"}", WsAction::None, -1, -1, -1},
+    {"[\"pret\"]", WsAction::None, -1, -1, -1},
+    {"pret stand", WsAction::None, -1, -1, -1},
+    {"\"pret\"", WsAction::None, -1, -1, -1},
+};
+
+// Relevés de télémétrie : champs décodés attendus (absents, négatifs ou non entiers -> 0,
+// compteurs bornés à UINT32_MAX, rssi hors [-127, 0] -> 0)
+struct TelemetryCase
+{
+  const char *msg;
+  TelemetrySample expect;
+};
+
+static const TelemetryCase kTelemetryCorpus[] = {
+    {"{\"action\":\"telemetrie\",\"boucle_us\":812,\"boucle_max_us\":4301,\"jpeg_n\":14,\"jpeg_us\":23110,"
+     "\"jpeg_max_us\":41002,\"tas_libre\":181204,\"tas_min\":150332,\"rssi\":-61,\"reconnexions\":2}",
+     {812, 4301, 14, 23110, 41002, 181204, 150332, -61, 2}},
+    {"{\"rssi\":-127,\"tas_libre\":181204,\"action\":\"TELEMETRIE\"}", {0, 0, 0, 0, 0, 181204, 0, -127, 0}},
+    {"{\"action\":\"telemetrie\",\"boucle_us\":-3,\"rssi\":5,\"jpeg_n\":1.5,\"tas_min\":\"9\"}", {0, 0, 0, 0, 0, 0, 0, 0, 0}},
+    {"{\"action\":\"telemetrie\",\"rssi\":-128,\"tas_libre\":99999999999,\"reconnexions\":65535}",
+     {0, 0, 0, 0, 0, UINT32_MAX, 0, 0, 65535}},
+};
+
+static bool sameTelemetry(const TelemetrySample &a, const TelemetrySample &b)
+{
+  return a.loopAvgUs == b.loopAvgUs && a.loopMaxUs == b.loopMaxUs && a.jpegCount == b.jpegCount &&
+         a.jpegAvgUs == b.jpegAvgUs && a.jpegMaxUs == b.jpegMaxUs && a.heapFree == b.heapFree &&
+         a.heapMin == b.heapMin && a.rssi == b.rssi && a.reconnects == b.reconnects;
+}
+
+static int runCorpus()
+{
+  int failures = 0;
+  for (const auto &tc : kCorpus)
+  {
+    ParsedAction p;
+    const bool ok = parseAction(tc.msg, p);
+    const bool good = ok == (tc.action != WsAction::None) && p.action == tc.action && p.table == tc.table &&
+                      p.siege == tc.siege && p.seq == tc.seq && p.jeton == tc.jeton;
+    if (!good)
+    {
+      ++failures;
+      std::cout << "ECHEC: " << tc.msg << " -> action " << (int)p.action << " table " << p.table
+                << " siege " << p.siege << " seq " << p.seq << "\n";
+    }
+  }
+  // Toutes les troncatures d'un message valide : ne doivent ni planter ni être acceptées
+  const std::string full = "{\"action\":\"rejoindre\",\"table\":1,\"siege\":2,\"x\":[{\"y\":\"a\\\"b\"}]}";
+  for (size_t n = 0; n < full.size(); ++n)
+  {
+    ParsedAction p;
+    if (parseAction(std::string_view(full).substr(0, n), p))
+    {
+      ++failures;
+      std::cout << "ECHEC (tronqué " << n << "): accepté\n";
+    }
+  }
+  for (const auto &tc : kTelemetryCorpus)
+  {
+    ParsedAction p;
+    if (!parseAction(tc.msg, p) || p.action != WsAction::Telemetrie || !sameTelemetry(p.telemetry, tc.expect))
+    {
+      ++failures;
+      const TelemetrySample &t = p.telemetry;
+      std::cout << "ECHEC (télémétrie): " << tc.msg << " -> boucle " << t.loopAvgUs << "/" << t.loopMaxUs
+                << " jpeg " << t.jpegCount << "/" << t.jpegAvgUs << "/" << t.jpegMaxUs << " tas " << t.heapFree
+                << "/" << t.heapMin << " rssi " << t.rssi << " reconnexions " << t.reconnects << "\n";
+    }
+  }
+  const size_t cases = sizeof(kCorpus) / sizeof(kCorpus[0]) + full.size() +
+                       sizeof(kTelemetryCorpus) / sizeof(kTelemetryCorpus[0]);
+  std::cout << "corpus: " << cases << " cas, " << failures << " échec(s)\n";
+  return failures;
+}
+
+int main(int argc, char **argv)
+{
+  const int failures = runCorpus();
+  const long iters = argc > 1 ? std::max(1L, std::atol(argv[1])) : 2000000;
+
+  const std::vector<std::string> msgs = {
+      "{\"action\":\"tirer_carte\"}",
+      "{\"action\":\"pret\"}",
+      "{\"action\":\"double\",\"seq\":1234}",
+      "{\"action\":\"rejoindre\",\"table\":3,\"siege\":1}",
+      "stand",
+  };
+
+  auto bench = [&](const char *name, auto &&fn)
+  {
+    size_t sink = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (long i = 0; i < iters; ++i)
+      sink += fn(msgs[(size_t)i % msgs.size()]);
+    double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << name << "\t" << (uint64_t)(iters / dt) << " msg/s\t" << (dt * 1e9 / iters) << " ns/msg\t(" << sink << ")\n";
+  };
+  bench("legacy", [](const std::string &m)
+        { return legacyParseAction(m).size(); });
+  bench("string_view", [](const std::string &m)
+        { ParsedAction p; parseAction(m, p); return (size_t)p.action; });
+  return failures == 0 ? 0 : 1;
+}
+#endif
+
+/*
+Corpus de messages malformés + débit (ancienne analyse vs string_view) :
+    g++ -std=c++17 -O2 -DBLACKJACK_PARSER_BENCH blackjack_action_parser.cpp -o parser_bench
+    ./parser_bench [itérations]
+*/
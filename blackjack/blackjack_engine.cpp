@@ -8,6 +8,8 @@
 
 #include <algorithm>
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <iomanip>
 #include <iostream>
@@ -116,6 +118,11 @@ public:
 
     size_t remaining() const { return m_cards.size() - m_index; }
 
+    // Copie des cartes non distribuées (pour les stratégies qui simulent la suite de la manche)
+    std::vector<Card> remainingCards() const {
+        return std::vector<Card>(m_cards.begin() + static_cast<std::ptrdiff_t>(m_index), m_cards.end());
+    }
+
     void setNumDecks(int n) { m_numDecks = std::max(1, n); refillAndShuffle(); }
 private:
     int m_numDecks;
@@ -141,6 +148,11 @@ struct DecisionContext {
     Card dealerUpcard;
     int playerIndex;
     int roundNumber;
+    // Optionnel : état de la table pour les stratégies qui simulent (ex: Monte Carlo).
+    // La carte cachée du croupier (dealer->cards[1]) doit être traitée comme inconnue.
+    const Shoe* shoe = nullptr;
+    const Hand* dealer = nullptr;
+    const GameConfig* rules = nullptr;
 };
 
 using DecisionFn = std::function<PlayerAction(const DecisionContext&)>;
@@ -194,60 +206,100 @@ public:
 
     const std::vector<Player>& players() const { return m_players; }
 
+    // Reprise d'un solde enregistré (registre des joueurs), hors manche en cours
+    void setPlayerStack(size_t p, double stack) {
+        if (p < m_players.size()) m_players[p].stack = stack;
+    }
+
+    // Manche complète : appelle la DecisionFn de chaque joueur (bloquante si elle attend une UI)
     RoundResult playOneRound() {
-        RoundResult rr; rr.shuffledThisRound = maybeShuffle();
+        beginRound();
+        while (auto ctx = pendingDecision()) {
+            const auto &pl = m_players[ctx->playerIndex];
+            applyAction(pl.decide ? pl.decide(*ctx) : PlayerAction::Stand);
+        }
+        return finishRound();
+    }
+
+    // ---- Manche pas à pas ----
+    // Permet de piloter la manche sans bloquer de thread en attendant un joueur :
+    //   beginRound(); tant que pendingDecision() -> applyAction(...); puis finishRound().
+    // Même ordre de tirage que playOneRound() (résultats identiques pour une même graine).
+
+    void beginRound() {
+        m_cur = CurrentRound{};
+        m_cur.rr.shuffledThisRound = maybeShuffle();
         ++m_round;
-        // Distribuer
-        std::vector<Hand> hands(m_players.size());
-        Hand dealer;
-        // Initial bets
-        std::vector<double> bet(m_players.size(), 0.0);
+        const size_t n = m_players.size();
+        m_cur.rr.players.resize(n);
+        m_cur.bet.assign(n, 0.0);
 
+        // Distribuer
         for (int i = 0; i < 2; ++i) {
-            for (size_t p = 0; p < m_players.size(); ++p) if (m_players[p].active) {
-                hands[p].add(m_shoe.draw());
+            for (size_t p = 0; p < n; ++p) if (m_players[p].active) {
+                m_cur.rr.players[p].hand.add(m_shoe.draw());
             }
-            dealer.add(m_shoe.draw());
+            m_cur.dealer.add(m_shoe.draw());
         }
 
-        Card dealerUp = dealer.cards.front();
-        bool dealerBJ = dealer.isBlackjack();
-        rr.dealerBlackjack = dealerBJ;
+        m_cur.dealerBJ = m_cur.dealer.isBlackjack();
+        m_cur.rr.dealerBlackjack = m_cur.dealerBJ;
+        // Mises initiales (peuvent doubler plus tard)
+        for (size_t p = 0; p < n; ++p) if (m_players[p].active) m_cur.bet[p] = m_players[p].baseBet;
 
-        // Décisions joueurs
-        for (size_t p = 0; p < m_players.size(); ++p) {
-            PlayerRoundResult prr; prr.hand = hands[p];
-            if (!m_players[p].active) { rr.players.push_back(std::move(prr)); continue; }
-
-            double b = m_players[p].baseBet;
-            bet[p] = b; // peut doubler plus tard
-
-            bool firstDecision = true;
-            if (!dealerBJ) {
-                // Blackjack joueur naturel
-                if (prr.hand.isBlackjack()) {
-                    prr.outcome.blackjack = true;
-                } else {
-                    // Boucle d'action
-                    while (true) {
-                        DecisionContext ctx{prr.hand, dealerUp, static_cast<int>(p), m_round};
-                        PlayerAction a = m_players[p].decide ? m_players[p].decide(ctx) : PlayerAction::Stand;
-                        if (a == PlayerAction::Stand) break;
-                        if (a == PlayerAction::DoubleDown && firstDecision) {
-                            bet[p] += b; // double la mise (total = 2*b)
-                            prr.hand.add(m_shoe.draw());
-                            break; // puis stand d'office
-                        }
-                        // Sinon HIT
-                        prr.hand.add(m_shoe.draw());
-                        if (prr.hand.isBust()) break;
-                        firstDecision = false; // après un hit, doubleDown n'est plus autorisé
-                        firstDecision = false; // (doublons volontairement explicite)
-                    }
-                }
-            }
-            rr.players.push_back(std::move(prr));
+        m_cur.inProgress = true;
+        m_cur.seat = 0;
+        m_cur.firstDecision = true;
+        skipToNextDecision();
+    }
+
+    bool roundInProgress() const { return m_cur.inProgress; }
+
+    // Mains de la manche en cours (lecture seule ; carte cachée du croupier incluse)
+    const Hand& roundHand(size_t p) const { return m_cur.rr.players[p].hand; }
+    const Hand& roundDealer() const { return m_cur.dealer; }
+    double roundBet(size_t p) const { return m_cur.bet[p]; }
+    int roundNumber() const { return m_round; }
+
+    // Décision attendue (joueur courant), ou nullopt si tous les joueurs ont terminé
+    std::optional<DecisionContext> pendingDecision() const {
+        if (!m_cur.inProgress || m_cur.seat >= m_cur.rr.players.size()) return std::nullopt;
+        return DecisionContext{m_cur.rr.players[m_cur.seat].hand, m_cur.dealer.cards.front(),
+                               static_cast<int>(m_cur.seat), m_round, &m_shoe, &m_cur.dealer, &m_cfg};
+    }
+
+    void applyAction(PlayerAction a) {
+        if (!m_cur.inProgress || m_cur.seat >= m_cur.rr.players.size()) return;
+        const size_t p = m_cur.seat;
+        auto &hand = m_cur.rr.players[p].hand;
+        bool seatDone = false;
+
+        if (a == PlayerAction::Stand) {
+            seatDone = true;
+        } else if (a == PlayerAction::DoubleDown && m_cur.firstDecision) {
+            m_cur.bet[p] += m_players[p].baseBet; // double la mise (total = 2*b)
+            hand.add(m_shoe.draw());
+            seatDone = true; // puis stand d'office
+        } else {
+            // Sinon HIT
+            hand.add(m_shoe.draw());
+            if (hand.isBust()) seatDone = true;
+            m_cur.firstDecision = false; // après un hit, doubleDown n'est plus autorisé
+        }
+
+        if (seatDone) {
+            ++m_cur.seat;
+            m_cur.firstDecision = true;
+            skipToNextDecision();
         }
+    }
+
+    // Jeu du croupier + résolution. À appeler quand pendingDecision() est vide.
+    RoundResult finishRound() {
+        if (!m_cur.inProgress) return {};
+        auto &rr = m_cur.rr;
+        Hand &dealer = m_cur.dealer;
+        const bool dealerBJ = m_cur.dealerBJ;
 
         // Jeu du croupier
         if (!dealerBJ) {
@@ -267,7 +319,7 @@ public:
         for (size_t p = 0; p < m_players.size(); ++p) {
             if (!m_players[p].active) continue;
             auto &prr = rr.players[p];
-            double b = bet[p]; if (b <= 0.0) b = m_players[p].baseBet;
+            double b = m_cur.bet[p]; if (b <= 0.0) b = m_players[p].baseBet;
             double delta = 0.0;
 
             if (dealerBJ) {
@@ -291,7 +343,8 @@ public:
             m_players[p].stack += delta;
         }
 
-        return rr;
+        m_cur.inProgress = false;
+        return std::move(rr);
     }
 
     const GameConfig& config() const { return m_cfg; }
@@ -300,6 +353,19 @@ public:
     }
 
 private:
+    // Avance le curseur jusqu'au prochain joueur qui doit décider
+    void skipToNextDecision() {
+        while (m_cur.seat < m_cur.rr.players.size()) {
+            const size_t p = m_cur.seat;
+            if (m_players[p].active && !m_cur.dealerBJ) {
+                // Blackjack joueur naturel : pas de décision
+                if (m_cur.rr.players[p].hand.isBlackjack()) m_cur.rr.players[p].outcome.blackjack = true;
+                else break;
+            }
+            ++m_cur.seat;
+        }
+    }
+
     bool maybeShuffle() {
         bool doShuffle = false;
         if (m_sinceShuffle >= m_cfg.roundsBeforeShuffle) doShuffle = true;
@@ -317,6 +383,18 @@ private:
     std::vector<Player> m_players;
     int m_round = 0;
     int m_sinceShuffle = 0;
+
+    // État de la manche en cours (mode pas à pas)
+    struct CurrentRound {
+        RoundResult rr;
+        Hand dealer;
+        std::vector<double> bet;
+        size_t seat = 0;
+        bool firstDecision = true;
+        bool dealerBJ = false;
+        bool inProgress = false;
+    };
+    CurrentRound m_cur;
 };
 
 // ================================ Stratégies exemples (IA de placeholder) ================================
@@ -398,6 +476,8 @@ Intégration UI :
     - Dans votre UI, instanciez l'engine avec GameConfig.
     - Ajoutez ≤4 joueurs avec une DecisionFn qui lit les actions GUI.
     - Appelez playOneRound(); puis utilisez RoundResult pour peindre l'état.
+    - Sans thread bloqué par joueur : beginRound(), puis applyAction() tant que
+      pendingDecision() retourne un contexte, puis finishRound() (voir blackjack_tables.cpp).
 
 Extensions faciles :
     - Split / plusieurs mains : transformer PlayerRoundResult en vector<HandResult>.
@@ -0,0 +1,715 @@
+// blackjack_ledger.cpp
+// Registre des joueurs : soldes et bilans (gagnées / perdues / égalités) persistants.
+// - Journal en ajout seul : un enregistrement de 20 octets par siège et par manche (table,
+//   siège, manche, gain, solde après la manche, issue), protégé par un CRC32.
+// - Validation groupée : TableManager::onRoundEnd ne fait qu'ajouter au tampon mémoire (pas
+//   d'E/S sur le thread moteur) ; un thread d'écriture vide le tampon d'un seul write() suivi
+//   d'un seul fdatasync(). Les manches terminées pendant un fdatasync partent ensemble au suivant.
+// - Point de reprise ("<journal>.ckpt") tous les kCheckpointRecords enregistrements et à la
+//   fermeture : état de tous les sièges + position du journal qu'il couvre, écrit à côté puis
+//   renommé (atomique). Au démarrage : point de reprise, puis relecture du journal à partir de
+//   sa position ; une fin de journal déchirée (arrêt brutal) est tronquée.
+// - POSIX (open / fdatasync / rename) : Raspberry Pi OS, Ubuntu.
+// À inclure après blackjack_tables.cpp.
+// C++17
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef BLACKJACK_LEDGER_BENCH
+#include "blackjack_engine.cpp"
+#include "blackjack_thread_pool.cpp"
+#include "blackjack_montecarlo.cpp"
+#include "blackjack_tables.cpp"
+#endif
+
+//   Enregistrement (petit-boutiste) :
+//     [0]      0xB1
+//     [1]      siège (bits 0-2) | issue (bits 3-4 : 0 perdue, 1 égalité, 2 gagnée) | blackjack (bit 5)
+//     [2..3]   table u16
+//     [4..7]   manche u32 (compteur du registre, par table)
+//     [8..11]  gain i32 (centièmes de jeton)
+//     [12..15] solde après la manche i32 (centièmes de jeton)
+//     [16..19] CRC32 des octets 0..15
+//   Point de reprise : "EPLCK1\n" [position u64][nb tables u32]
+//     puis par table [manche u32][nb sièges u8] et par siège [connu u8][solde i64][g u32][p u32][e u32]
+//     puis CRC32 de tout ce qui précède.
+namespace ledger_format
+{
+  static const char kCheckpointMagic[] = "EPLCK1\n";
+  constexpr size_t kCheckpointMagicLen = sizeof(kCheckpointMagic) - 1;
+  constexpr uint8_t kRoundRecord = 0xB1;
+  constexpr size_t kRecordSize = 20;
+
+  static uint32_t crc32(const uint8_t *p, size_t n)
+  {
+    static const auto table = []
+    {
+      std::array<uint32_t, 256> t{};
+      for (uint32_t i = 0; i < 256; ++i)
+      {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k)
+          c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        t[i] = c;
+      }
+      return t;
+    }();
+    uint32_t c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < n; ++i)
+      c = table[(c ^ p[i]) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+  }
+
+  static void put_le(std::string &out, uint64_t v, int bytes)
+  {
+    for (int i = 0; i < bytes; ++i)
+      out.push_back((char)(uint8_t)(v >> (8 * i)));
+  }
+
+  static uint64_t get_le(const uint8_t *p, int bytes)
+  {
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; ++i)
+      v |= (uint64_t)p[i] << (8 * i);
+    return v;
+  }
+
+  static void put_crc(std::string &out, size_t from)
+  {
+    put_le(out, crc32((const uint8_t *)out.data() + from, out.size() - from), 4);
+  }
+} // namespace ledger_format
+
+class PlayerLedger
+{
+public:
+  static constexpr uint64_t kCheckpointRecords = 4096; // enregistrements entre deux points de reprise
+
+  struct Seat
+  {
+    bool known = false;  // présent dans le registre (sinon : solde initial du moteur)
+    int64_t stackCenti = 0;
+    int win = 0, loss = 0, push = 0;
+  };
+
+  struct Stats
+  {
+    uint64_t appended = 0;    // enregistrements reçus
+    uint64_t durable = 0;     // enregistrements sur disque (après fdatasync)
+    uint64_t commits = 0;     // fdatasync du journal
+    uint64_t checkpoints = 0; // points de reprise écrits
+    uint64_t recovered = 0;   // enregistrements relus au démarrage après le point de reprise
+    uint64_t truncatedBytes = 0; // fin déchirée écartée au démarrage
+  };
+
+  ~PlayerLedger() { close(); }
+
+  // Ouvre (ou crée) le journal et relit l'état : point de reprise puis fin du journal.
+  bool open(const std::string &path, std::string &err)
+  {
+    logPath = path;
+    ckptPath = path + ".ckpt";
+    seats.clear();
+    rounds.clear();
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+      err = "ouverture impossible : " + path + " (" + std::strerror(errno) + ")";
+      return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+    {
+      err = std::string("fstat : ") + std::strerror(errno);
+      return false;
+    }
+    const uint64_t size = (uint64_t)st.st_size;
+    uint64_t from = 0;
+    load_checkpoint(size, from);
+
+    // Relecture à partir du point de reprise ; arrêt au premier enregistrement invalide
+    uint64_t valid = from;
+    std::vector<uint8_t> buf(ledger_format::kRecordSize * 4096);
+    uint64_t pos = from;
+    size_t have = 0;
+    bool torn = false;
+    while (!torn)
+    {
+      const ssize_t n = ::pread(fd, buf.data() + have, buf.size() - have, (off_t)pos);
+      if (n <= 0)
+        break;
+      pos += (uint64_t)n;
+      have += (size_t)n;
+      size_t off = 0;
+      for (; off + ledger_format::kRecordSize <= have; off += ledger_format::kRecordSize)
+      {
+        if (!apply_record(buf.data() + off))
+        {
+          torn = true;
+          break;
+        }
+        valid += ledger_format::kRecordSize;
+        ++stats.recovered;
+      }
+      std::memmove(buf.data(), buf.data() + off, have - off);
+      have -= off;
+    }
+    if (valid < size)
+    {
+      stats.truncatedBytes = size - valid;
+      if (::ftruncate(fd, (off_t)valid) != 0)
+      {
+        err = std::string("troncature du journal : ") + std::strerror(errno);
+        return false;
+      }
+    }
+    offset = valid;
+
+    quit = false;
+    writer = std::thread([this]
+                         { writerLoop(); });
+    return true;
+  }
+
+  // Applique les soldes relus aux tables (avant TableManager::start()) et adopte le solde
+  // initial du moteur pour les sièges encore inconnus du registre.
+  void restore(TableManager &mgr)
+  {
+    std::lock_guard<std::mutex> lk(m);
+    for (int t = 0; t < mgr.numTables(); ++t)
+    {
+      const auto &players = mgr.table(t).engine.players();
+      seat_slots(t, (int)players.size() - 1);
+      for (int p = 0; p < (int)players.size(); ++p)
+      {
+        Seat &s = seats[t][p];
+        if (s.known)
+          mgr.restoreSeat(t, p, s.stackCenti / 100.0, s.win, s.loss, s.push);
+        else
+          s.stackCenti = std::llround(players[p].stack * 100.0);
+      }
+    }
+  }
+
+  // À brancher sur TableManager::onRoundEnd (thread du shard) : aucune E/S, un verrou court.
+  void append_round(int table, const RoundResult &rr)
+  {
+    {
+      std::lock_guard<std::mutex> lk(m);
+      if (fd < 0)
+        return;
+      seat_slots(table, (int)rr.players.size() - 1);
+      const uint32_t round = ++rounds[table];
+      for (int p = 0; p < (int)rr.players.size(); ++p)
+      {
+        const auto &pr = rr.players[p];
+        if (pr.hand.cards.empty())
+          continue; // siège inactif
+        const int64_t delta = std::llround(pr.outcome.deltaChips * 100.0);
+        Seat &s = seats[table][p];
+        s.known = true;
+        s.stackCenti += delta;
+        const int outcome = delta > 0 ? 2 : delta < 0 ? 0 : 1;
+        (outcome == 2 ? s.win : outcome == 0 ? s.loss : s.push)++;
+
+        const size_t at = pending.size();
+        ledger_format::put_le(pending, ledger_format::kRoundRecord, 1);
+        ledger_format::put_le(pending, (uint64_t)(p | outcome << 3 | (pr.outcome.blackjack ? 1 << 5 : 0)), 1);
+        ledger_format::put_le(pending, (uint64_t)table, 2);
+        ledger_format::put_le(pending, round, 4);
+        ledger_format::put_le(pending, (uint64_t)(uint32_t)(int32_t)delta, 4);
+        ledger_format::put_le(pending, (uint64_t)(uint32_t)(int32_t)s.stackCenti, 4);
+        ledger_format::put_crc(pending, at);
+        ++stats.appended;
+      }
+    }
+    cv.notify_one();
+  }
+
+  // Attend que tout ce qui a été ajouté soit sur disque
+  void flush()
+  {
+    std::unique_lock<std::mutex> lk(m);
+    durableCv.wait(lk, [&]
+                   { return stats.durable == stats.appended || fd < 0 || writeFailed; });
+  }
+
+  // Vide le tampon, écrit un point de reprise final et ferme le journal
+  void close()
+  {
+    {
+      std::lock_guard<std::mutex> lk(m);
+      if (fd < 0)
+        return;
+      quit = true;
+    }
+    cv.notify_one();
+    if (writer.joinable())
+      writer.join();
+    std::lock_guard<std::mutex> lk(m);
+    ::close(fd);
+    fd = -1;
+  }
+
+  Stats statsSnapshot()
+  {
+    std::lock_guard<std::mutex> lk(m);
+    return stats;
+  }
+
+  // Copie de l'état d'un siège (table et siège hors registre : inconnu)
+  Seat seat(int table, int s)
+  {
+    std::lock_guard<std::mutex> lk(m);
+    if (table < 0 || table >= (int)seats.size() || s < 0 || s >= (int)seats[table].size())
+      return {};
+    return seats[table][s];
+  }
+
+private:
+  // Agrandit l'état jusqu'à seats[table][seat] (sous m ou avant le thread d'écriture)
+  void seat_slots(int table, int seat)
+  {
+    if (table >= (int)seats.size())
+    {
+      seats.resize((size_t)table + 1);
+      rounds.resize((size_t)table + 1, 0);
+    }
+    if (seat >= (int)seats[table].size())
+      seats[table].resize((size_t)seat + 1);
+  }
+
+  // Rejoue un enregistrement relu ; false si invalide (fin déchirée)
+  bool apply_record(const uint8_t *r)
+  {
+    if (r[0] != ledger_format::kRoundRecord ||
+        ledger_format::get_le(r + 16, 4) != ledger_format::crc32(r, 16))
+      return false;
+    const int seat = r[1] & 0x07;
+    const int outcome = (r[1] >> 3) & 0x03;
+    const int table = (int)ledger_format::get_le(r + 2, 2);
+    const uint32_t round = (uint32_t)ledger_format::get_le(r + 4, 4);
+    seat_slots(table, seat);
+    Seat &s = seats[table][seat];
+    s.known = true;
+    s.stackCenti = (int32_t)(uint32_t)ledger_format::get_le(r + 12, 4);
+    (outcome == 2 ? s.win : outcome == 0 ? s.loss : s.push)++;
+    rounds[table] = std::max(rounds[table], round);
+    return true;
+  }
+
+  // N'adopte l'état du point de reprise que s'il couvre au plus logSize octets du journal :
+  // au-delà, le journal a été tronqué ou remplacé et tout est relu depuis le début.
+  void load_checkpoint(uint64_t logSize, uint64_t &from)
+  {
+    from = 0;
+    std::FILE *f = std::fopen(ckptPath.c_str(), "rb");
+    if (!f)
+      return;
+    std::string data;
+    char buf[4096];
+    size_t n;
+    while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0)
+      data.append(buf, n);
+    std::fclose(f);
+
+    const uint8_t *p = (const uint8_t *)data.data();
+    const size_t size = data.size();
+    if (size < ledger_format::kCheckpointMagicLen + 16 ||
+        std::memcmp(p, ledger_format::kCheckpointMagic, ledger_format::kCheckpointMagicLen) != 0 ||
+        ledger_format::get_le(p + size - 4, 4) != ledger_format::crc32(p, size - 4))
+    {
+      std::cerr << "[Registre] point de reprise invalide, relecture complète du journal\n";
+      return;
+    }
+    size_t pos = ledger_format::kCheckpointMagicLen;
+    const uint64_t at = ledger_format::get_le(p + pos, 8);
+    if (at > logSize)
+    {
+      std::cerr << "[Registre] point de reprise d'un autre journal, relecture complète\n";
+      return;
+    }
+    const uint32_t numTables = (uint32_t)ledger_format::get_le(p + pos + 8, 4);
+    pos += 12;
+    std::vector<std::vector<Seat>> s;
+    std::vector<uint32_t> r;
+    for (uint32_t t = 0; t < numTables; ++t)
+    {
+      if (pos + 5 > size - 4)
+        return;
+      r.push_back((uint32_t)ledger_format::get_le(p + pos, 4));
+      const int numSeats = p[pos + 4];
+      pos += 5;
+      s.emplace_back();
+      for (int k = 0; k < numSeats; ++k)
+      {
+        if (pos + 21 > size - 4)
+          return;
+        Seat st;
+        st.known = p[pos] != 0;
+        st.stackCenti = (int64_t)ledger_format::get_le(p + pos + 1, 8);
+        st.win = (int)ledger_format::get_le(p + pos + 9, 4);
+        st.loss = (int)ledger_format::get_le(p + pos + 13, 4);
+        st.push = (int)ledger_format::get_le(p + pos + 17, 4);
+        s.back().push_back(st);
+        pos += 21;
+      }
+    }
+    seats = std::move(s);
+    rounds = std::move(r);
+    from = at;
+  }
+
+  // Écrit tmp, fdatasync, renomme sur le point de reprise, puis fsync du répertoire
+  bool write_checkpoint(uint64_t at, const std::vector<std::vector<Seat>> &s, const std::vector<uint32_t> &r)
+  {
+    std::string out(ledger_format::kCheckpointMagic, ledger_format::kCheckpointMagicLen);
+    ledger_format::put_le(out, at, 8);
+    ledger_format::put_le(out, s.size(), 4);
+    for (size_t t = 0; t < s.size(); ++t)
+    {
+      ledger_format::put_le(out, r[t], 4);
+      ledger_format::put_le(out, s[t].size(), 1);
+      for (const Seat &st : s[t])
+      {
+        ledger_format::put_le(out, st.known ? 1 : 0, 1);
+        ledger_format::put_le(out, (uint64_t)st.stackCenti, 8);
+        ledger_format::put_le(out, (uint64_t)st.win, 4);
+        ledger_format::put_le(out, (uint64_t)st.loss, 4);
+        ledger_format::put_le(out, (uint64_t)st.push, 4);
+      }
+    }
+    ledger_format::put_crc(out, 0);
+
+    const std::string tmp = ckptPath + ".tmp";
+    const int cfd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (cfd < 0)
+      return false;
+    const bool ok = write_all(cfd, out.data(), out.size()) && ::fdatasync(cfd) == 0;
+    ::close(cfd);
+    if (!ok || std::rename(tmp.c_str(), ckptPath.c_str()) != 0)
+      return false;
+    const size_t slash = ckptPath.find_last_of('/');
+    const std::string dir = slash == std::string::npos ? "." : ckptPath.substr(0, slash + 1);
+    const int dfd = ::open(dir.c_str(), O_RDONLY | O_CLOEXEC);
+    if (dfd >= 0)
+    {
+      ::fsync(dfd);
+      ::close(dfd);
+    }
+    return true;
+  }
+
+  static bool write_all(int f, const char *p, size_t n)
+  {
+    while (n > 0)
+    {
+      const ssize_t w = ::write(f, p, n);
+      if (w < 0)
+      {
+        if (errno == EINTR)
+          continue;
+        return false;
+      }
+      p += w;
+      n -= (size_t)w;
+    }
+    return true;
+  }
+
+  void writerLoop()
+  {
+    std::string batch;
+    std::vector<std::vector<Seat>> ckptSeats;
+    std::vector<uint32_t> ckptRounds;
+    uint64_t sinceCheckpoint = 0;
+    std::unique_lock<std::mutex> lk(m);
+    for (;;)
+    {
+      cv.wait(lk, [&]
+              { return !pending.empty() || quit; });
+      const bool last = quit && pending.empty();
+      batch.swap(pending);
+      const uint64_t upTo = stats.appended;
+      sinceCheckpoint += batch.size() / ledger_format::kRecordSize;
+      const bool checkpoint = (sinceCheckpoint >= kCheckpointRecords || (last && sinceCheckpoint > 0)) && !writeFailed;
+      if (checkpoint)
+      {
+        ckptSeats = seats; // état qui correspond exactement au journal après ce lot
+        ckptRounds = rounds;
+      }
+      lk.unlock();
+
+      bool ok = true;
+      const bool wrote = !batch.empty() && !writeFailed;
+      if (wrote)
+      {
+        ok = write_all(fd, batch.data(), batch.size()) && ::fdatasync(fd) == 0;
+        if (ok)
+          offset += batch.size();
+      }
+      bool ckptOk = false;
+      if (ok && checkpoint)
+        ckptOk = write_checkpoint(offset, ckptSeats, ckptRounds);
+      batch.clear();
+
+      lk.lock();
+      if (!ok && !writeFailed)
+      {
+        writeFailed = true;
+        std::cerr << "[Registre] écriture impossible (" << std::strerror(errno) << ") : soldes non persistés\n";
+      }
+      if (ok)
+      {
+        stats.durable = upTo;
+        stats.commits += wrote ? 1 : 0;
+      }
+      if (ckptOk)
+      {
+        stats.checkpoints++;
+        sinceCheckpoint = 0;
+      }
+      durableCv.notify_all();
+      if (last)
+        break;
+    }
+  }
+
+  std::string logPath, ckptPath;
+  int fd = -1;
+  uint64_t offset = 0; // taille du journal sur disque (thread d'écriture)
+
+  std::mutex m;
+  std::condition_variable cv;        // tampon non vide / fermeture
+  std::condition_variable durableCv; // lot sur disque
+  std::thread writer;
+  bool quit = false;
+  bool writeFailed = false;
+  std::string pending; // enregistrements en attente du prochain lot
+  std::vector<std::vector<Seat>> seats;
+  std::vector<uint32_t> rounds; // dernière manche enregistrée par table
+  Stats stats;
+};
+
+// ============================= Débit =============================
+
+#ifdef BLACKJACK_LEDGER_BENCH
+#include <cstdlib>
+
+// Débit du registre sur le système de fichiers du répertoire donné (carte SD du Pi : y lancer
+// le banc). Producteurs = threads moteur qui terminent des manches de 4 sièges sans pause.
+//   groupée   : PlayerLedger (un fdatasync par lot)
+//   unitaire  : un write() + fdatasync() par manche, sur le thread moteur (référence)
+static std::string readFile(const std::string &path)
+{
+  std::string data;
+  std::FILE *f = std::fopen(path.c_str(), "rb");
+  if (!f)
+    return data;
+  char buf[4096];
+  size_t n;
+  while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0)
+    data.append(buf, n);
+  std::fclose(f);
+  return data;
+}
+
+static void writeFile(const std::string &path, const std::string &data)
+{
+  std::FILE *f = std::fopen(path.c_str(), "wb");
+  if (!f)
+    return;
+  std::fwrite(data.data(), 1, data.size(), f);
+  std::fclose(f);
+}
+
+// Reprise : journal relu seul, puis journal tronqué ou remplacé sous un point de reprise
+// qui couvre plus d'octets que lui (l'état du point de reprise doit être écarté).
+static int checkRecovery(const std::string &path, const RoundResult &rr)
+{
+  int failures = 0;
+  auto expect = [&](bool ok, const char *what)
+  {
+    if (!ok)
+    {
+      ++failures;
+      std::cout << "ECHEC (reprise): " << what << "\n";
+    }
+  };
+  const std::string ckpt = path + ".ckpt";
+  // Nouveau registre de `rounds` manches sur la table 0 (point de reprise écrit à la fermeture)
+  auto writeRounds = [&](int rounds)
+  {
+    std::remove(path.c_str());
+    std::remove(ckpt.c_str());
+    PlayerLedger ledger;
+    std::string err;
+    if (!ledger.open(path, err))
+      return false;
+    for (int i = 0; i < rounds; ++i)
+      ledger.append_round(0, rr);
+    ledger.close();
+    return true;
+  };
+  // Siège 1 : gagne 10 à chaque manche
+  auto reopen = [&](int expectWins, int64_t expectCenti, uint64_t expectRecovered, const char *what)
+  {
+    PlayerLedger ledger;
+    std::string err;
+    if (!ledger.open(path, err))
+    {
+      expect(false, what);
+      return;
+    }
+    const auto s = ledger.seat(0, 1);
+    const auto st = ledger.statsSnapshot();
+    expect(s.win == expectWins && s.loss == 0 && s.stackCenti == expectCenti &&
+               st.recovered == expectRecovered,
+           what);
+    ledger.close();
+  };
+
+  expect(writeRounds(10), "ouverture du registre");
+  reopen(10, 10 * 1000, 0, "point de reprise seul");
+
+  // Journal remplacé par un plus court : l'ancien point de reprise le dépasse
+  const std::string oldCkpt = readFile(ckpt);
+  expect(writeRounds(3), "ouverture du second registre");
+  writeFile(ckpt, oldCkpt);
+  reopen(3, 3 * 1000, 3 * rr.players.size(), "journal remplacé sous un point de reprise");
+
+  // Journal tronqué à zéro sous le point de reprise
+  expect(writeRounds(10), "ouverture du troisième registre");
+  const int f = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+  expect(f >= 0 && ::ftruncate(f, 0) == 0, "troncature du journal");
+  if (f >= 0)
+    ::close(f);
+  reopen(0, 0, 0, "journal tronqué sous un point de reprise");
+
+  std::remove(path.c_str());
+  std::remove(ckpt.c_str());
+  std::cout << "reprise : " << (failures ? "ECHEC" : "OK") << "\n";
+  return failures;
+}
+
+int main(int argc, char **argv)
+{
+  const std::string dir = argc > 1 ? argv[1] : ".";
+  const int seconds = argc > 2 ? std::max(1, std::atoi(argv[2])) : 3;
+  const int producers = argc > 3 ? std::max(1, std::atoi(argv[3])) : 4;
+  const std::string path = dir + "/ledger_bench.log";
+
+  RoundResult rr;
+  rr.players.resize(4);
+  for (int p = 0; p < 4; ++p)
+  {
+    rr.players[p].hand.add(Card{Rank::Ten, Suit::Spades});
+    rr.players[p].hand.add(Card{Rank::Nine, Suit::Hearts});
+    rr.players[p].outcome.deltaChips = p % 2 ? 10.0 : -10.0;
+  }
+  if (checkRecovery(path, rr) != 0)
+    return 1;
+  TableCfg tc;
+  tc.numHuman = 0;
+  tc.numAI = 4;
+  TableManager mgr(producers, tc, 1);
+
+  std::cout << "mode      enregistrements/s  fdatasync/s  enr./lot\n";
+  {
+    std::remove(path.c_str());
+    std::remove((path + ".ckpt").c_str());
+    PlayerLedger ledger;
+    std::string err;
+    if (!ledger.open(path, err))
+    {
+      std::cerr << err << "\n";
+      return 1;
+    }
+    ledger.restore(mgr);
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> th;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < producers; ++i)
+      th.emplace_back([&, i]
+                      { while (!stop.load(std::memory_order_relaxed)) ledger.append_round(i, rr); });
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    stop = true;
+    for (auto &t : th)
+      t.join();
+    ledger.flush();
+    const double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    const auto st = ledger.statsSnapshot();
+    std::cout << "groupée   " << (uint64_t)(st.durable / dt) << "\t\t     " << (uint64_t)(st.commits / dt)
+              << "\t  " << (st.commits ? st.durable / st.commits : 0) << "\n";
+    ledger.close();
+  }
+  {
+    std::remove(path.c_str());
+    const int f = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> done{0};
+    std::mutex fm;
+    char rec[4 * ledger_format::kRecordSize] = {};
+    std::vector<std::thread> th;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < producers; ++i)
+      th.emplace_back([&]
+                      {
+                        while (!stop.load(std::memory_order_relaxed))
+                        {
+                          std::lock_guard<std::mutex> lk(fm);
+                          if (::write(f, rec, sizeof(rec)) < 0 || ::fdatasync(f) != 0)
+                            break;
+                          done.fetch_add(4, std::memory_order_relaxed);
+                        } });
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    stop = true;
+    for (auto &t : th)
+      t.join();
+    const double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "unitaire  " << (uint64_t)(done / dt) << "\t\t     " << (uint64_t)(done / 4 / dt) << "\t  4\n";
+    ::close(f);
+  }
+  std::remove(path.c_str());
+  std::remove((path + ".ckpt").c_str());
+  return 0;
+}
+#endif
+
+/*
+Registre (UI et serveur) :
+    ./blackjack_touch                       # registre blackjack_ledger.bin dans le répertoire courant
+    ./blackjack_server --ledger=/var/lib/echoplay/ledger.bin
+
+Débit (20 octets par siège et par manche, lancer dans le répertoire à mesurer) :
+    g++ -std=c++17 -O2 -DBLACKJACK_LEDGER_BENCH blackjack_ledger.cpp -o ledger_bench -pthread
+    ./ledger_bench [répertoire] [secondes] [producteurs]
+    (vérifie d'abord la reprise : point de reprise, journal remplacé ou tronqué sous lui)
+
+    Machine de développement (ext4 sur disque virtuel, fdatasync ~70 µs), 4 producteurs :
+      mode      enregistrements/s  fdatasync/s  enr./lot
+      groupée   8274510            66           124806
+      unitaire  57363              14340        4
+    Le mode groupé n'est borné que par la copie en mémoire : le moteur n'attend jamais le disque.
+    Carte SD du Pi : fdatasync de l'ordre de 2 à 20 ms, le mode unitaire y tombe à quelques
+    centaines d'enregistrements/s alors que le mode groupé absorbe tout ce qui arrive pendant un
+    fdatasync. Chiffres de la carte : lancer ledger_bench dans un répertoire de la carte.
+*/
@@ -0,0 +1,185 @@
+// blackjack_montecarlo.cpp
+// Stratégie IA Monte Carlo pour le moteur Blackjack.
+// - À chaque décision, clone les cartes inconnues (reste du sabot + carte cachée du croupier).
+// - Simule en parallèle Hit / Stand / Double (si permis) sur le ThreadPool, dans un budget
+//   de temps fixe (ex: 5 ms), puis retourne l'action de meilleure espérance estimée.
+// - Après le premier Hit simulé, la main est jouée avec la règle de basicStrategy (sans double).
+// - Les trois actions partagent la même séquence de cartes par rollout (variance réduite).
+// À inclure après blackjack_engine.cpp et blackjack_thread_pool.cpp.
+// C++17
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <random>
+#include <vector>
+
+struct MonteCarloCfg {
+    int budgetMs = 5;  // temps max par décision (horloge murale)
+    int batch = 32;    // rollouts par lot avant de revérifier l'horloge
+};
+
+namespace mc_detail {
+
+// Total incrémental sans allocation (équivalent de Hand::bestTotal)
+struct Tally {
+    int hard = 0;  // As comptés 1
+    int aces = 0;
+    int cards = 0;
+
+    void add(const Card& c) {
+        if (c.rank == Rank::Ace) aces++;
+        hard += Card::faceValueNonAce(c.rank);
+        cards++;
+    }
+    int total() const { return (aces > 0 && hard + 10 <= 21) ? hard + 10 : hard; }
+    bool soft() const { return aces > 0 && hard + 10 <= 21; }
+};
+
+// Séquence de cartes d'un rollout : tirage sans remise (Fisher-Yates partiel) dans les
+// cartes inconnues, puis sabot infini si la séquence est épuisée (cas rarissime).
+struct DrawSeq {
+    static constexpr int kMax = 24;
+    std::array<Card, kMax> cards{};
+    int len = 0;
+
+    template <class Rng>
+    Card at(int i, Rng& rng) const {
+        if (i < len) return cards[i];
+        std::uniform_int_distribution<int> d(0, 51);
+        int k = d(rng);
+        return Card{static_cast<Rank>(2 + k % 13), static_cast<Suit>(k / 13)};
+    }
+};
+
+inline bool dealerNeedsHit(const Tally& t, const GameConfig& cfg) {
+    int tot = t.total();
+    if (tot <= cfg.dealerHitThreshold) return true;
+    if (tot == 17 && cfg.dealerHitsSoft17 && t.soft()) return true;
+    return false;
+}
+
+// Même règle que basicStrategy, sans double (utilisée après le premier Hit)
+inline bool policyHits(const Tally& t, int up) {
+    int tot = t.total();
+    if (tot <= 11) return true;
+    if (tot >= 17) return false;
+    return !(up >= 2 && up <= 6);
+}
+
+// Joue une action depuis l'état initial ; retourne le gain en unités de mise
+template <class Rng>
+double rollout(PlayerAction a, const Tally& player0, const Card& up, const DrawSeq& seq,
+               const GameConfig& cfg, Rng& rng) {
+    int next = 0;
+    Card hole = seq.at(next++, rng);
+    Tally p = player0;
+    double mult = 1.0;
+    int upV = Card::faceValueNonAce(up.rank);
+
+    if (a == PlayerAction::DoubleDown) {
+        mult = 2.0;
+        p.add(seq.at(next++, rng));
+    } else if (a == PlayerAction::Hit) {
+        p.add(seq.at(next++, rng));
+        while (p.total() <= 21 && policyHits(p, upV)) p.add(seq.at(next++, rng));
+    }
+    if (p.total() > 21) return -mult;
+
+    Tally d;
+    d.add(up);
+    d.add(hole);
+    while (dealerNeedsHit(d, cfg)) d.add(seq.at(next++, rng));
+    int dt = d.total();
+    int pt = p.total();
+    if (dt > 21 || pt > dt) return mult;
+    if (pt < dt) return -mult;
+    return 0.0;
+}
+
+constexpr PlayerAction kActions[3] = {PlayerAction::Stand, PlayerAction::Hit, PlayerAction::DoubleDown};
+
+struct Accum {
+    std::array<double, 3> sum{};
+    long n = 0; // rollouts par action
+};
+
+} // namespace mc_detail
+
+// Fabrique une DecisionFn Monte Carlo. Le pool est partagé (les décisions sont séquentielles
+// dans un moteur, mais plusieurs moteurs peuvent réutiliser le même pool).
+static DecisionFn makeMonteCarloStrategy(std::shared_ptr<ThreadPool> pool, MonteCarloCfg cfg = {},
+                                         uint64_t seed = std::random_device{}()) {
+    auto counter = std::make_shared<std::atomic<uint64_t>>(0);
+    return [pool, cfg, seed, counter](const DecisionContext& ctx) -> PlayerAction {
+        using namespace mc_detail;
+        if (!pool || !ctx.shoe || !ctx.dealer || !ctx.rules || ctx.dealer->cards.size() < 2)
+            return basicStrategy(ctx);
+
+        // Cartes inconnues du joueur : sabot restant + carte cachée
+        std::vector<Card> unseen = ctx.shoe->remainingCards();
+        unseen.push_back(ctx.dealer->cards[1]);
+
+        Tally start;
+        for (auto &c : ctx.hand.cards) start.add(c);
+        const bool canDouble = ctx.hand.cards.size() == 2;
+        const int numActions = canDouble ? 3 : 2;
+        const int upV = Card::faceValueNonAce(ctx.dealerUpcard.rank);
+        const bool upIsAce = ctx.dealerUpcard.rank == Rank::Ace;
+        const Card up = ctx.dealerUpcard;
+        const GameConfig rules = *ctx.rules;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(cfg.budgetMs);
+        const uint64_t decisionSeed = seed ^ (0x9E3779B97F4A7C15ull * ++*counter);
+
+        auto work = [&](unsigned worker) {
+            std::mt19937_64 rng(decisionSeed + worker);
+            std::vector<Card> deck = unseen; // copie locale mélangée sur place
+            const int n = static_cast<int>(deck.size());
+            Accum acc;
+            DrawSeq seq;
+            seq.len = std::min(n, DrawSeq::kMax);
+
+            while (std::chrono::steady_clock::now() < deadline) {
+                for (int b = 0; b < cfg.batch; ++b) {
+                    for (int i = 0; i < seq.len; ++i) {
+                        std::uniform_int_distribution<int> d(i, n - 1);
+                        std::swap(deck[i], deck[d(rng)]);
+                        seq.cards[i] = deck[i];
+                    }
+                    // Le croupier a vérifié son blackjack : la carte cachée ne le complète pas
+                    if (upIsAce || upV == 10) {
+                        for (int j = 0; j < seq.len; ++j) {
+                            bool bj = upIsAce ? Card::faceValueNonAce(seq.cards[j].rank) == 10
+                                              : seq.cards[j].rank == Rank::Ace;
+                            if (!bj) { std::swap(seq.cards[0], seq.cards[j]); break; }
+                        }
+                    }
+                    for (int a = 0; a < numActions; ++a)
+                        acc.sum[a] += rollout(kActions[a], start, up, seq, rules, rng);
+                    acc.n++;
+                }
+            }
+            return acc;
+        };
+
+        std::vector<std::future<Accum>> futs;
+        futs.reserve(pool->size());
+        for (unsigned w = 0; w < pool->size(); ++w) futs.push_back(pool->submit([&work, w] { return work(w); }));
+
+        Accum total;
+        for (auto &f : futs) {
+            Accum a = f.get();
+            for (int i = 0; i < 3; ++i) total.sum[i] += a.sum[i];
+            total.n += a.n;
+        }
+        if (total.n == 0) return basicStrategy(ctx);
+
+        int best = 0;
+        for (int a = 1; a < numActions; ++a) if (total.sum[a] > total.sum[best]) best = a;
+        return kActions[best];
+    };
+}
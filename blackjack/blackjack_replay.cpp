@@ -0,0 +1,482 @@
+// blackjack_replay.cpp
+// Relecture déterministe d'un enregistrement de trafic (blackjack_server --record=FILE).
+// - Démarre en interne un TableManager + WsHub neufs avec la configuration enregistrée
+//   (même graine : mêmes sabots, mêmes cartes tant que les actions arrivent dans le même ordre).
+// - Ouvre une connexion cliente par connexion enregistrée (même sous-protocole) et rejoue ses
+//   trames reçues dans l'ordre global d'origine. Relecture causale : une trame n'est envoyée que
+//   lorsque sa connexion a reçu autant de trames que dans l'enregistrement à ce moment-là ;
+//   --fast n'attend rien d'autre, sinon le rythme d'origine est respecté.
+// - Jetons de session : ceux du serveur neuf remplacent ceux de l'enregistrement dans les trames
+//   "reprendre" et sont masqués dans la comparaison.
+// - Rapport : par connexion, trames attendues / reçues et première divergence ; latence de
+//   réponse (trame reçue -> première trame envoyée) enregistrée vs rejouée, p50/p95/max.
+// Non déterministes par nature : IA Monte Carlo (--ai-mc, budget en temps) et fusion des
+// états envoyés aux spectateurs (cadence limitée) ; signalés mais comparés quand même.
+// C++17
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "blackjack_engine.cpp"
+#include "blackjack_thread_pool.cpp"
+#include "blackjack_montecarlo.cpp"
+#include "blackjack_tables.cpp"
+#include "blackjack_action_parser.cpp"
+#include "blackjack_ws_hub.cpp"
+#include "blackjack_ws_recorder.cpp"
+
+#include <websocketpp/config/asio_no_tls_client.hpp>
+#include <websocketpp/client.hpp>
+
+using client = websocketpp::client<websocketpp::config::asio_client>;
+
+static const char *USAGE =
+    "Usage: blackjack_replay FICHIER [options]\n"
+    "  --port=P          port du serveur interne (8799)\n"
+    "  --fast            au plus vite (ordre causal seul), sinon rythme d'origine\n"
+    "  --pause-ms=MS     remplace la pause entre deux manches enregistrée\n"
+    "  --workers=N       workers du TableManager (0 = nb de coeurs, 1)\n"
+    "  --timeout-ms=MS   attente max d'une trame attendue avant de continuer (10000)\n"
+    "  --dump            affiche l'enregistrement sans le rejouer\n";
+
+// ============================= Jetons =============================
+
+// Position du jeton de session dans une trame envoyée par le serveur ; npos si aucun.
+// JSON : "jeton":"<16 hexa>" ; binaire : siege_attribue / reprise, [op][table][siege][jeton u64]
+static size_t token_pos(const std::string &p, bool binary, size_t &len)
+{
+  if (binary)
+  {
+    len = 8;
+    if (p.size() >= 11 && ((uint8_t)p[0] == bin_proto::SiegeAttribue || (uint8_t)p[0] == bin_proto::Reprise))
+      return 3;
+    return std::string::npos;
+  }
+  len = 16;
+  static const char kKey[] = "\"jeton\":\"";
+  const size_t k = p.find(kKey);
+  if (k == std::string::npos || k + sizeof(kKey) - 1 + 16 > p.size())
+    return std::string::npos;
+  return k + sizeof(kKey) - 1;
+}
+
+static std::string mask_token(std::string p, bool binary)
+{
+  size_t len = 0;
+  const size_t at = token_pos(p, binary, len);
+  if (at != std::string::npos)
+    p.replace(at, len, len, binary ? '\0' : '*');
+  return p;
+}
+
+// ============================= Script par connexion =============================
+
+struct ReplayConn
+{
+  std::string subprotocol;
+  bool binary = false;
+  std::vector<std::string> expected; // trames envoyées par le serveur enregistré
+  std::vector<int64_t> expectedUs;
+
+  // Relecture (sous g_m)
+  client::connection_ptr con;
+  websocketpp::connection_hdl hdl;
+  bool opened = false;
+  bool closed = false;
+  std::vector<std::string> received;
+  std::vector<int64_t> receivedUs;
+  std::vector<int64_t> recLatUs, replayLatUs; // latences de réponse
+  int stalls = 0;                            // trames attendues jamais arrivées (délai dépassé)
+};
+
+// Un événement client à rejouer : ouverture, trame à envoyer, fermeture
+struct Step
+{
+  TrafficKind kind;
+  uint32_t conn;
+  int64_t tUs;
+  size_t outBefore; // trames reçues par cette connexion avant l'événement, dans l'enregistrement
+  const std::string *payload;
+};
+
+static std::mutex g_m;
+static std::condition_variable g_cv;
+static std::map<uint64_t, uint64_t> g_tokens; // jeton enregistré -> jeton du serveur neuf
+
+static uint64_t token_value(const std::string &p, size_t at, bool binary)
+{
+  if (binary)
+  {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i)
+      v |= (uint64_t)(uint8_t)p[at + i] << (8 * i);
+    return v;
+  }
+  return std::strtoull(p.substr(at, 16).c_str(), nullptr, 16);
+}
+
+// Trame "reprendre" : remplacer le jeton enregistré par celui du serveur neuf
+static std::string rewrite_resume(std::string p, bool binary)
+{
+  std::lock_guard<std::mutex> lk(g_m);
+  if (binary)
+  {
+    if (p.size() < 9 || (uint8_t)p[0] != bin_proto::Reprendre)
+      return p;
+    const auto it = g_tokens.find(token_value(p, 1, true));
+    if (it != g_tokens.end())
+      for (int i = 0; i < 8; ++i)
+        p[1 + i] = (char)(it->second >> (8 * i));
+    return p;
+  }
+  size_t len = 0;
+  const size_t at = token_pos(p, false, len);
+  if (at == std::string::npos)
+    return p;
+  const auto it = g_tokens.find(token_value(p, at, false));
+  if (it != g_tokens.end())
+    p.replace(at, len, JetonHex(it->second).s);
+  return p;
+}
+
+static void percentiles(std::vector<int64_t> v, const char *label)
+{
+  if (v.empty())
+  {
+    std::printf("    %-12s -\n", label);
+    return;
+  }
+  std::sort(v.begin(), v.end());
+  auto at = [&](double q)
+  { return v[std::min(v.size() - 1, (size_t)(q * v.size()))] / 1000.0; };
+  std::printf("    %-12s p50 %8.2f  p95 %8.2f  max %8.2f ms  (%zu)\n", label, at(0.50), at(0.95), v.back() / 1000.0, v.size());
+}
+
+static const char *kind_name(TrafficKind k)
+{
+  switch (k)
+  {
+  case TrafficKind::Open: return "open";
+  case TrafficKind::Close: return "close";
+  case TrafficKind::InText:
+  case TrafficKind::InBinary: return "in";
+  case TrafficKind::OutText:
+  case TrafficKind::OutBinary: return "out";
+  }
+  return "?";
+}
+
+static std::string printable(const std::string &p, bool binary, size_t max = 96)
+{
+  std::string s;
+  if (!binary)
+    s = p.substr(0, max);
+  else
+  {
+    char hex[4];
+    for (size_t i = 0; i < p.size() && s.size() < max; ++i)
+    {
+      std::snprintf(hex, sizeof(hex), "%02x ", (uint8_t)p[i]);
+      s += hex;
+    }
+  }
+  return p.size() > max ? s + "..." : s;
+}
+
+int main(int argc, char **argv)
+{
+  std::string path;
+  unsigned short port = 8799;
+  bool fast = false, dump = false;
+  int pauseMs = -1;
+  unsigned workers = 1;
+  long timeoutMs = 10000;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string a = argv[i];
+    auto val = [&](const char *prefix) -> const char *
+    { return a.rfind(prefix, 0) == 0 ? a.c_str() + std::strlen(prefix) : nullptr; };
+    const char *v = nullptr;
+    if (a == "--help" || a == "-h")
+    {
+      std::cout << USAGE;
+      return 0;
+    }
+    else if ((v = val("--port=")))
+      port = (unsigned short)std::atoi(v);
+    else if (a == "--fast")
+      fast = true;
+    else if (a == "--dump")
+      dump = true;
+    else if ((v = val("--pause-ms=")))
+      pauseMs = std::max(0, std::atoi(v));
+    else if ((v = val("--workers=")))
+      workers = (unsigned)std::max(0, std::atoi(v));
+    else if ((v = val("--timeout-ms=")))
+      timeoutMs = std::max(1, std::atoi(v));
+    else if (a.rfind("--", 0) != 0 && path.empty())
+      path = a;
+    else
+    {
+      std::cerr << "Option inconnue: " << a << "\n"
+                << USAGE;
+      return 1;
+    }
+  }
+  if (path.empty())
+  {
+    std::cerr << USAGE;
+    return 1;
+  }
+
+  Recording rec;
+  std::string err;
+  if (!load_recording(path, rec, err))
+  {
+    std::cerr << "[Replay] " << err << "\n";
+    return 1;
+  }
+  std::cout << "[Replay] " << path << " : " << rec.records.size() << " enregistrement(s), "
+            << (rec.records.empty() ? 0.0 : rec.records.back().tUs / 1e6) << " s\n"
+            << rec.header;
+
+  if (dump)
+  {
+    for (const auto &r : rec.records)
+    {
+      const bool binary = r.kind == TrafficKind::InBinary || r.kind == TrafficKind::OutBinary;
+      std::printf("%10.3f  c%-4u %-5s %s\n", r.tUs / 1000.0, r.conn, kind_name(r.kind), printable(r.payload, binary).c_str());
+    }
+    return 0;
+  }
+
+  // --- Script : trames attendues par connexion et événements clients dans l'ordre global ---
+  std::map<uint32_t, ReplayConn> conns;
+  std::vector<Step> steps;
+  for (const auto &r : rec.records)
+  {
+    ReplayConn &rc = conns[r.conn];
+    switch (r.kind)
+    {
+    case TrafficKind::Open:
+      rc.subprotocol = r.payload;
+      rc.binary = r.payload == bin_proto::kSubprotocol;
+      steps.push_back({r.kind, r.conn, r.tUs, 0, &r.payload});
+      break;
+    case TrafficKind::OutText:
+    case TrafficKind::OutBinary:
+      rc.expected.push_back(r.payload);
+      rc.expectedUs.push_back(r.tUs);
+      break;
+    default: // trame reçue ou fermeture
+      steps.push_back({r.kind, r.conn, r.tUs, rc.expected.size(), &r.payload});
+      break;
+    }
+  }
+  if (rec.tcfg.aiMonteCarlo)
+    std::cout << "[Replay] IA Monte Carlo enregistrée : décisions IA non déterministes, divergences possibles\n";
+
+  // --- Serveur neuf, même configuration ---
+  TableCfg tcfg = rec.tcfg;
+  if (pauseMs >= 0)
+    tcfg.pauseMs = pauseMs;
+  WsHub hub;
+  TableManager tables(rec.numTables, tcfg, workers);
+  hub.start(port, &tables, 1);
+  tables.start();
+
+  // --- Clients ---
+  client cl;
+  cl.clear_access_channels(websocketpp::log::alevel::all);
+  cl.clear_error_channels(websocketpp::log::elevel::all);
+  cl.init_asio();
+  cl.start_perpetual();
+  std::thread io([&cl]
+                 { cl.run(); });
+  const std::string uri = "ws://127.0.0.1:" + std::to_string(port) + "/";
+  const int64_t t0 = steady_us();
+
+  // Attente causale : la connexion a reçu n trames (ou est fermée) ; false si délai dépassé
+  auto wait_received = [&](ReplayConn &rc, size_t n)
+  {
+    std::unique_lock<std::mutex> lk(g_m);
+    return g_cv.wait_for(lk, std::chrono::milliseconds(timeoutMs), [&]
+                         { return rc.received.size() >= n || rc.closed; });
+  };
+
+  for (const Step &s : steps)
+  {
+    ReplayConn &rc = conns[s.conn];
+    if (!fast)
+    {
+      const int64_t late = s.tUs - (steady_us() - t0);
+      if (late > 0)
+        std::this_thread::sleep_for(std::chrono::microseconds(late));
+    }
+    if (s.kind == TrafficKind::Open)
+    {
+      websocketpp::lib::error_code ec;
+      rc.con = cl.get_connection(uri, ec);
+      if (ec)
+      {
+        std::cerr << "[Replay] get_connection: " << ec.message() << "\n";
+        break;
+      }
+      if (!rc.subprotocol.empty())
+        rc.con->add_subprotocol(rc.subprotocol);
+      ReplayConn *p = &rc;
+      rc.con->set_open_handler([p](websocketpp::connection_hdl h)
+                               {
+        std::lock_guard<std::mutex> lk(g_m);
+        p->hdl = h;
+        p->opened = true;
+        g_cv.notify_all(); });
+      auto gone = [p](websocketpp::connection_hdl)
+      {
+        std::lock_guard<std::mutex> lk(g_m);
+        p->closed = true;
+        g_cv.notify_all();
+      };
+      rc.con->set_close_handler(gone);
+      rc.con->set_fail_handler(gone);
+      rc.con->set_message_handler([p](websocketpp::connection_hdl, client::message_ptr msg)
+                                  {
+        const int64_t now = steady_us();
+        std::lock_guard<std::mutex> lk(g_m);
+        const size_t k = p->received.size();
+        const std::string &got = msg->get_payload();
+        // Jeton du serveur neuf à la place de celui de l'enregistrement
+        size_t len = 0, a = 0, b = 0;
+        if (k < p->expected.size() && (a = token_pos(p->expected[k], p->binary, len)) != std::string::npos &&
+            (b = token_pos(got, p->binary, len)) != std::string::npos)
+          g_tokens[token_value(p->expected[k], a, p->binary)] = token_value(got, b, p->binary);
+        p->received.push_back(got);
+        p->receivedUs.push_back(now);
+        g_cv.notify_all(); });
+      cl.connect(rc.con);
+      std::unique_lock<std::mutex> lk(g_m);
+      g_cv.wait_for(lk, std::chrono::milliseconds(timeoutMs), [&]
+                    { return rc.opened || rc.closed; });
+      continue;
+    }
+
+    if (!wait_received(rc, s.outBefore))
+      ++rc.stalls;
+    {
+      std::lock_guard<std::mutex> lk(g_m);
+      if (!rc.opened || rc.closed)
+        continue;
+    }
+    websocketpp::lib::error_code ec;
+    if (s.kind == TrafficKind::Close)
+    {
+      cl.close(rc.hdl, websocketpp::close::status::normal, "replay", ec);
+      continue;
+    }
+    const bool binary = s.kind == TrafficKind::InBinary;
+    const std::string frame = rewrite_resume(*s.payload, binary);
+    const int64_t sentUs = steady_us();
+    cl.send(rc.hdl, frame, binary ? websocketpp::frame::opcode::binary : websocketpp::frame::opcode::text, ec);
+
+    // Latence de réponse : première trame envoyée après celle-ci, avant l'événement suivant
+    // de la connexion (sinon ce n'est pas une réponse : début de manche après la pause, etc.)
+    const size_t j = s.outBefore;
+    const Step *end = steps.data() + steps.size();
+    const Step *next = std::find_if(&s + 1, end, [&](const Step &o)
+                                    { return o.conn == s.conn; });
+    const int64_t nextUs = next != end ? next->tUs : INT64_MAX;
+    if (j < rc.expected.size() && rc.expectedUs[j] <= nextUs)
+    {
+      rc.recLatUs.push_back(rc.expectedUs[j] - s.tUs);
+      if (wait_received(rc, j + 1))
+      {
+        std::lock_guard<std::mutex> lk(g_m);
+        if (j < rc.receivedUs.size())
+          rc.replayLatUs.push_back(rc.receivedUs[j] - sentUs);
+      }
+    }
+  }
+
+  // Trames encore en route : toutes les connexions jusqu'à leur total attendu
+  for (auto &kv : conns)
+    wait_received(kv.second, kv.second.expected.size());
+
+  // --- Rapport ---
+  int diverged = 0;
+  std::vector<int64_t> allRec, allReplay;
+  std::printf("[Replay] %zu connexion(s), %.2f s (%s)\n", conns.size(), (steady_us() - t0) / 1e6,
+              fast ? "au plus vite" : "rythme d'origine");
+  {
+    std::lock_guard<std::mutex> lk(g_m);
+    for (auto &kv : conns)
+    {
+      ReplayConn &rc = kv.second;
+      size_t same = 0;
+      while (same < rc.expected.size() && same < rc.received.size() &&
+             mask_token(rc.expected[same], rc.binary) == mask_token(rc.received[same], rc.binary))
+        ++same;
+      const bool ok = same == rc.expected.size() && same == rc.received.size();
+      diverged += !ok;
+      std::printf("  c%-4u %-12s attendues %5zu  reçues %5zu  %s", kv.first, rc.binary ? "binaire" : "json",
+                  rc.expected.size(), rc.received.size(), ok ? "identiques" : "DIVERGENCE");
+      if (rc.stalls)
+        std::printf("  (%d attente(s) expirée(s))", rc.stalls);
+      std::printf("\n");
+      if (!ok)
+      {
+        std::printf("    trame %zu\n", same);
+        if (same < rc.expected.size())
+          std::printf("    attendue : %s\n", printable(rc.expected[same], rc.binary).c_str());
+        if (same < rc.received.size())
+          std::printf("    reçue    : %s\n", printable(rc.received[same], rc.binary).c_str());
+      }
+      allRec.insert(allRec.end(), rc.recLatUs.begin(), rc.recLatUs.end());
+      allReplay.insert(allReplay.end(), rc.replayLatUs.begin(), rc.replayLatUs.end());
+    }
+  }
+  std::printf("  Latence de réponse\n");
+  percentiles(allRec, "enregistrée");
+  percentiles(allReplay, "rejouée");
+  std::printf("[Replay] %s\n", diverged ? "divergences détectées" : "relecture identique");
+  std::fflush(stdout);
+
+  for (auto &kv : conns)
+  {
+    websocketpp::lib::error_code ec;
+    bool open;
+    {
+      std::lock_guard<std::mutex> lk(g_m);
+      open = kv.second.opened && !kv.second.closed;
+    }
+    if (open)
+      cl.close(kv.second.hdl, websocketpp::close::status::going_away, "", ec);
+  }
+  cl.stop_perpetual();
+  io.join();
+  tables.stop();
+  hub.stop();
+  return diverged ? 2 : 0;
+}
+
+/*
+BUILD (Ubuntu / Raspberry Pi OS) — pas besoin de SDL :
+    sudo apt install g++ libwebsocketpp-dev libasio-dev
+    g++ -std=c++17 -O2 blackjack_replay.cpp -o blackjack_replay -pthread
+
+Exemples :
+    ./blackjack_server --humans=2 --pause-ms=1500 --record=salle.rec     (Ctrl-C pour arrêter)
+    ./blackjack_replay salle.rec --dump | head
+    ./blackjack_replay salle.rec --fast
+    ./blackjack_replay salle.rec            (rythme d'origine : compare aussi les latences)
+*/
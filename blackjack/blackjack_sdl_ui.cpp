@@ -25,6 +25,11 @@
 #include <SDL2/SDL_image.h>
 #endif
 
+// SDL_GetTicks64 et SDL_RenderGeometry (texte et cartes en lots) : SDL 2.0.18 minimum
+#if !SDL_VERSION_ATLEAST(2, 0, 18)
+#error "SDL >= 2.0.18 requis"
+#endif
+
 #include <atomic>
 #include <cmath>
 #include <condition_variable>
@@ -36,17 +41,19 @@
 #include <chrono>
 #include <iostream>
 #include <array>
+#include <unordered_map>
 
-// --- WebSocketpp + Asio ---
-#define ASIO_STANDALONE
-#include <asio.hpp>
-#include <websocketpp/config/asio_no_tls.hpp>
-#include <websocketpp/server.hpp>
-#include <set>
 #include <memory>
 
-// Inclure le moteur
+// Inclure le moteur, les tables et le serveur WebSocket
 #include "blackjack_engine.cpp"
+#include "blackjack_thread_pool.cpp"
+#include "blackjack_montecarlo.cpp"
+#include "blackjack_tables.cpp"
+#include "blackjack_ledger.cpp"
+#include "blackjack_shm.cpp"
+#include "blackjack_action_parser.cpp"
+#include "blackjack_ws_hub.cpp"
 
 // --- Réglages UI  ---
 // Durée d'affichage du résultat de fin de manche (en millisecondes)
@@ -62,6 +69,12 @@ static int UI_DEALER_REVEAL_STEP_MS = 600;
 static uint64_t g_lastRoundSerialRendered = 0;
 static uint64_t g_revealStartTicks = 0;
 
+// Rendu à la demande : la boucle dort dans SDL_WaitEventTimeout et ne redessine que sur entrée,
+// nouvelle vue du moteur ou étape d'animation. Plafond d'attente sans rien à attendre (ms) :
+static int UI_IDLE_WAIT_MS = 1000;
+// --shm : pas de réveil inter-processus, la vue partagée est relue à cette période (ms)
+static int UI_SHM_POLL_MS = 20;
+
 // Couleurs de table (vert feutre)
 static SDL_Color UI_TABLE_COLOR = {11, 110, 59, 255};  // vert casino
 static SDL_Color UI_TABLE_ZONE_TOP = {0, 0, 0, 30};    // ombrage léger
@@ -73,40 +86,105 @@ static unsigned short WS_PORT = 8765;
 // Réglages des images de cartes
 static const char *UI_CARDS_DIR = "./PlayingCards/51x71"; // changez vers 42x58, 71x71, 71x98 ou 128x178
 
-// Atlas de 52 textures (card_0.jpg .. card_51.jpg)
-static std::array<SDL_Texture *, 52> g_cardTex{};
-static bool g_cardTexLoaded = false;
+// ============================= Lots de sprites =============================
 
-static int rankToIndex(Rank r)
+// Quads d'une même texture accumulés puis envoyés en un seul SDL_RenderGeometry
+struct SpriteBatch
 {
-  // Ordre des fichiers: A,2,3,4,5,6,7,8,9,10,J,Q,K
-  if (r == Rank::Ace)
-    return 0;
-  return static_cast<int>(r) - 1; // 2->1 ... 10->9, J->10, Q->11, K->12
-}
+  struct Quad
+  {
+    SDL_Rect src, dst;
+    SDL_Color col;
+  };
+  std::vector<Quad> quads;
+  std::vector<SDL_Vertex> verts; // tampons réutilisés d'un envoi à l'autre
+  std::vector<int> indices;
+
+  void add(const SDL_Rect &src, const SDL_Rect &dst, SDL_Color col = {255, 255, 255, 255})
+  {
+    quads.push_back(Quad{src, dst, col});
+  }
 
-static int suitToPackIndex(Suit s)
+  // Envoie les quads sur la texture tw x th, puis vide le lot
+  void flush(SDL_Renderer *r, SDL_Texture *tex, int tw, int th)
+  {
+    if (quads.empty() || !tex)
+    {
+      quads.clear();
+      return;
+    }
+    verts.clear();
+    indices.clear();
+    const float iu = 1.0f / tw, iv = 1.0f / th;
+    for (const Quad &q : quads)
+    {
+      const float x0 = (float)q.dst.x, y0 = (float)q.dst.y;
+      const float x1 = x0 + q.dst.w, y1 = y0 + q.dst.h;
+      const float u0 = q.src.x * iu, v0 = q.src.y * iv;
+      const float u1 = (q.src.x + q.src.w) * iu, v1 = (q.src.y + q.src.h) * iv;
+      const int base = (int)verts.size();
+      verts.push_back(SDL_Vertex{{x0, y0}, q.col, {u0, v0}});
+      verts.push_back(SDL_Vertex{{x1, y0}, q.col, {u1, v0}});
+      verts.push_back(SDL_Vertex{{x1, y1}, q.col, {u1, v1}});
+      verts.push_back(SDL_Vertex{{x0, y1}, q.col, {u0, v1}});
+      for (int k : {0, 1, 2, 0, 2, 3})
+        indices.push_back(base + k);
+    }
+    SDL_RenderGeometry(r, tex, verts.data(), (int)verts.size(), indices.data(), (int)indices.size());
+    quads.clear();
+  }
+};
+
+// ============================= Atlas des cartes =============================
+
+// Une seule texture pour les 52 faces (card_0.jpg .. card_51.jpg), le dos (card_back.jpg, ou
+// dessiné s'il manque) et une cellule blanche unie (cadres et fonds teintés par la couleur des
+// sommets). Une main entière = un lot, une texture, un appel de rendu.
+static const int UI_ATLAS_BACK = 52;
+static const int UI_ATLAS_WHITE = 53;
+static const int UI_ATLAS_CELLS = 54;
+
+struct CardAtlas
 {
-  // Ordre des dossiers selon l'utilisateur: Trèfle (Clubs), Coeur (Hearts), Pique (Spades), Carreaux (Diamonds)
-  switch (s)
+  SDL_Texture *tex = nullptr;
+  int texW = 0, texH = 0;
+  int cellW = 0, cellH = 0, cols = 1;
+  std::array<bool, 52> have{}; // face chargée (sinon fond teinté + code carte)
+
+  SDL_Rect cell(int i) const { return SDL_Rect{(i % cols) * (cellW + 1), (i / cols) * (cellH + 1), cellW, cellH}; }
+
+  // Texel au centre de la cellule blanche : quads unis, toutes tailles
+  SDL_Rect white() const
   {
-  case Suit::Clubs:
-    return 0;
-  case Suit::Hearts:
-    return 1;
-  case Suit::Spades:
-    return 2;
-  case Suit::Diamonds:
-    return 3;
+    SDL_Rect c = cell(UI_ATLAS_WHITE);
+    return SDL_Rect{c.x + c.w / 2, c.y + c.h / 2, 1, 1};
   }
-  return 0;
+};
+
+static CardAtlas g_cards;
+static bool g_cardTexLoaded = false;
+
+static SDL_Surface *loadCardSurface(const std::string &path)
+{
+  SDL_Surface *s = IMG_Load(path.c_str());
+  if (!s)
+    return nullptr;
+  SDL_Surface *conv = SDL_ConvertSurfaceFormat(s, SDL_PIXELFORMAT_ARGB8888, 0);
+  SDL_FreeSurface(s);
+  if (conv)
+    SDL_SetSurfaceBlendMode(conv, SDL_BLENDMODE_NONE); // copie brute dans l'atlas
+  return conv;
 }
 
-static int cardToImageIndex(const Card &c)
+// Dos dessiné : fond bordeaux, liseré blanc, panneau intérieur plus clair
+static void paintCardBack(SDL_Surface *atlas, const SDL_Rect &c)
 {
-  int ri = rankToIndex(c.rank);     // 0..12
-  int si = suitToPackIndex(c.suit); // 0..3
-  return si * 13 + ri;              // 0..51
+  const int m = std::max(2, c.w / 12);
+  SDL_Rect border{c.x + m / 2, c.y + m / 2, c.w - m, c.h - m};
+  SDL_Rect inner{c.x + m, c.y + m, c.w - 2 * m, c.h - 2 * m};
+  SDL_FillRect(atlas, &c, SDL_MapRGBA(atlas->format, 120, 16, 32, 255));
+  SDL_FillRect(atlas, &border, SDL_MapRGBA(atlas->format, 240, 240, 240, 255));
+  SDL_FillRect(atlas, &inner, SDL_MapRGBA(atlas->format, 160, 30, 48, 255));
 }
 
 static bool loadCardTextures(SDL_Renderer *r)
@@ -114,40 +192,85 @@ static bool loadCardTextures(SDL_Renderer *r)
   if (g_cardTexLoaded)
     return true;
   bool ok = true;
+  std::array<SDL_Surface *, 53> img{}; // 52 faces + dos
   for (int i = 0; i < 52; ++i)
   {
     std::string path = std::string(UI_CARDS_DIR) + "/card_" + std::to_string(i) + ".jpg";
-    SDL_Surface *s = IMG_Load(path.c_str());
-    if (!s)
+    img[i] = loadCardSurface(path);
+    if (!img[i])
     {
       std::cerr << "IMG_Load échoue: " << path << " => " << IMG_GetError() << "\n";
       ok = false;
-      continue;
     }
-    SDL_Texture *t = SDL_CreateTextureFromSurface(r, s);
-    SDL_FreeSurface(s);
-    if (!t)
+  }
+  img[UI_ATLAS_BACK] = loadCardSurface(std::string(UI_CARDS_DIR) + "/card_back.jpg"); // facultatif
+
+  // Taille de cellule : celle des images (toutes identiques dans un dossier), sinon la carte UI
+  CardAtlas a;
+  a.cellW = UI_CARD_W;
+  a.cellH = UI_CARD_H;
+  for (SDL_Surface *s : img)
+    if (s)
     {
-      std::cerr << "CreateTexture échoue pour: " << path << " => " << SDL_GetError() << "\n";
-      ok = false;
-      continue;
+      a.cellW = s->w;
+      a.cellH = s->h;
+      break;
     }
-    g_cardTex[i] = t;
+
+  // 13 colonnes si le GPU l'accepte (128x178, gouttière de 1 px : 1677x895), sinon moins et plus de lignes
+  SDL_RendererInfo info{};
+  const int maxW = (SDL_GetRendererInfo(r, &info) == 0 && info.max_texture_width) ? info.max_texture_width : 2048;
+  a.cols = std::max(1, std::min(13, maxW / (a.cellW + 1)));
+  const int rows = (UI_ATLAS_CELLS + a.cols - 1) / a.cols;
+  a.texW = a.cols * (a.cellW + 1);
+  a.texH = rows * (a.cellH + 1);
+
+  SDL_Surface *atlas = SDL_CreateRGBSurfaceWithFormat(0, a.texW, a.texH, 32, SDL_PIXELFORMAT_ARGB8888);
+  if (atlas)
+  {
+    SDL_FillRect(atlas, nullptr, SDL_MapRGBA(atlas->format, 0, 0, 0, 0));
+    for (int i = 0; i <= UI_ATLAS_BACK; ++i)
+    {
+      SDL_Rect dst = a.cell(i);
+      if (img[i])
+      {
+        if (img[i]->w == a.cellW && img[i]->h == a.cellH)
+          SDL_BlitSurface(img[i], nullptr, atlas, &dst);
+        else
+          SDL_BlitScaled(img[i], nullptr, atlas, &dst);
+        if (i < 52)
+          a.have[i] = true;
+      }
+      else if (i == UI_ATLAS_BACK)
+      {
+        paintCardBack(atlas, dst);
+      }
+    }
+    SDL_Rect w = a.cell(UI_ATLAS_WHITE);
+    SDL_FillRect(atlas, &w, SDL_MapRGBA(atlas->format, 255, 255, 255, 255));
+    a.tex = SDL_CreateTextureFromSurface(r, atlas);
+    SDL_FreeSurface(atlas);
+  }
+  for (SDL_Surface *s : img)
+    if (s)
+      SDL_FreeSurface(s);
+
+  if (!a.tex)
+  {
+    std::cerr << "Atlas des cartes (" << a.texW << "x" << a.texH << ") => " << SDL_GetError() << "\n";
+    return false;
   }
-  g_cardTexLoaded = ok; // même si partiel, on marque true pour éviter reload
+  SDL_SetTextureBlendMode(a.tex, SDL_BLENDMODE_BLEND);
+  g_cards = a;
+  g_cardTexLoaded = true; // même si partiel : les faces manquantes ont un fond de remplacement
   return ok;
 }
 
 static void unloadCardTextures()
 {
-  for (auto &t : g_cardTex)
-  {
-    if (t)
-    {
-      SDL_DestroyTexture(t);
-      t = nullptr;
-    }
-  }
+  if (g_cards.tex)
+    SDL_DestroyTexture(g_cards.tex);
+  g_cards = CardAtlas();
   g_cardTexLoaded = false;
 }
 
@@ -178,272 +301,266 @@ static TTF_Font *loadAnyFont(int px)
   return nullptr;
 }
 
-static void drawText(SDL_Renderer *r, TTF_Font *f, const std::string &txt, int x, int y)
+// Texte : atlas de glyphes par police (chaque glyphe rastérisé une seule fois, puis les chaînes
+// sont dessinées en quads groupés) + cache de textures pour les chaînes qui reviennent d'une image
+// à l'autre (totaux, ligne d'aide des gestes...). Une chaîne inchangée = un seul SDL_RenderCopy ;
+// plus de TTF_RenderUTF8_Blended ni d'envoi de texture à chaque image.
+static const int UI_GLYPH_ATLAS_SIZE = 512;    // texture d'atlas (px), une par police
+static const int UI_TEXT_CACHE_PROMOTE = 3;    // images où la chaîne apparaît avant d'avoir sa texture
+static const uint64_t UI_TEXT_CACHE_IDLE = 120; // images sans usage avant libération
+
+struct Glyph
 {
-  if (!f)
-    return;
-  SDL_Color col{255, 255, 255, 255};
-  SDL_Surface *surf = TTF_RenderUTF8_Blended(f, txt.c_str(), col);
-  if (!surf)
-    return;
-  SDL_Texture *tex = SDL_CreateTextureFromSurface(r, surf);
-  SDL_Rect dst{x, y, surf->w, surf->h};
-  SDL_FreeSurface(surf);
-  if (tex)
+  SDL_Rect src{0, 0, 0, 0}; // position dans l'atlas
+  int advance = 0;
+};
+
+struct GlyphAtlas
+{
+  SDL_Texture *tex = nullptr;
+  std::unordered_map<uint32_t, Glyph> glyphs;
+  int penX = 0, penY = 0, rowH = 0; // rangement par étagères
+};
+
+struct CachedText
+{
+  SDL_Texture *tex = nullptr;
+  int w = 0, h = 0;
+  int frames = 0;         // images distinctes où la chaîne a été dessinée
+  uint64_t lastFrame = 0; // dernière image où elle l'a été
+};
+
+struct TextRenderer
+{
+  std::unordered_map<TTF_Font *, GlyphAtlas> atlases;
+  std::unordered_map<TTF_Font *, std::unordered_map<std::string, CachedText>> strings;
+  SpriteBatch batch; // quads de la chaîne en cours
+  uint64_t frame = 1;
+};
+
+static TextRenderer g_text;
+
+// Décode le point de code UTF-8 en position i (avance i) ; séquence invalide -> '?'
+static uint32_t utf8Next(const std::string &s, size_t &i)
+{
+  const unsigned char c = (unsigned char)s[i++];
+  int extra = c < 0x80 ? 0 : (c >> 5) == 0x6 ? 1 : (c >> 4) == 0xE ? 2 : (c >> 3) == 0x1E ? 3 : -1;
+  if (extra < 0)
+    return '?';
+  uint32_t cp = extra == 0 ? c : (c & (0x3F >> extra));
+  for (int k = 0; k < extra; ++k)
   {
-    SDL_RenderCopy(r, tex, nullptr, &dst);
-    SDL_DestroyTexture(tex);
+    if (i >= s.size() || ((unsigned char)s[i] & 0xC0) != 0x80)
+      return '?';
+    cp = (cp << 6) | ((unsigned char)s[i++] & 0x3F);
   }
+  return cp;
 }
 
-// Calcule la meilleure valeur blackjack (<=21 si possible) pour une main affichée
-static std::pair<int, bool> uiBestTotal(const std::vector<Card> &cards)
+static std::string utf8Encode(uint32_t cp)
 {
-  int total = 0;
-  int aces = 0;
-  for (const auto &c : cards)
+  std::string out;
+  if (cp < 0x80)
+    out += (char)cp;
+  else if (cp < 0x800)
   {
-    if (c.rank == Rank::Ace)
-      aces++;
-    else
-      total += Card::faceValueNonAce(c.rank);
+    out += (char)(0xC0 | (cp >> 6));
+    out += (char)(0x80 | (cp & 0x3F));
   }
-  total += aces; // tous les As comptés 1
-  bool soft = false;
-  if (aces > 0 && total + 10 <= 21)
+  else if (cp < 0x10000)
   {
-    total += 10;
-    soft = true;
+    out += (char)(0xE0 | (cp >> 12));
+    out += (char)(0x80 | ((cp >> 6) & 0x3F));
+    out += (char)(0x80 | (cp & 0x3F));
   }
-  return {total, soft};
+  else
+  {
+    out += (char)(0xF0 | (cp >> 18));
+    out += (char)(0x80 | ((cp >> 12) & 0x3F));
+    out += (char)(0x80 | ((cp >> 6) & 0x3F));
+    out += (char)(0x80 | (cp & 0x3F));
+  }
+  return out;
 }
 
-// ============================= État partagé UI <-> Moteur =============================
-
-struct DecisionContextCopy
-{
-  std::vector<Card> handCards;
-  Card dealerUp;
-  int playerIndex = 0;
-  int roundNumber = 0;
-};
-
-struct Bridge
+// Glyphe du point de code, rastérisé dans l'atlas à sa première utilisation.
+// Rendu comme une chaîne d'un caractère : même placement (hauteur de ligne, débords) que
+// TTF_RenderUTF8_Blended. Atlas plein : il est vidé et se remplit à nouveau.
+static const Glyph *glyphFor(SDL_Renderer *r, TTF_Font *f, GlyphAtlas &a, uint32_t cp)
 {
-  std::mutex m;
-  std::condition_variable cv;
+  auto it = a.glyphs.find(cp);
+  if (it != a.glyphs.end())
+    return &it->second;
 
-  // Contexte en attente côté UI quand le moteur veut une décision
-  std::optional<DecisionContextCopy> pendingCtx;
+  if (!a.tex)
+  {
+    a.tex = SDL_CreateTexture(r, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC,
+                              UI_GLYPH_ATLAS_SIZE, UI_GLYPH_ATLAS_SIZE);
+    if (!a.tex)
+      return nullptr;
+    SDL_SetTextureBlendMode(a.tex, SDL_BLENDMODE_BLEND);
+  }
 
-  // Action choisie par l'utilisateur (ou la souris/clavier)
-  std::optional<PlayerAction> chosen;
+  Glyph g;
+  int minx, maxx, miny, maxy, adv;
+  if (cp <= 0xFFFF && TTF_GlyphMetrics(f, (Uint16)cp, &minx, &maxx, &miny, &maxy, &adv) == 0)
+    g.advance = adv;
 
-  // Dernier résultat de manche complet pour affichage
-  std::optional<RoundResult> lastRound;
+  SDL_Color white{255, 255, 255, 255};
+  SDL_Surface *surf = TTF_RenderUTF8_Blended(f, utf8Encode(cp).c_str(), white);
+  if (!surf)
+    return &(a.glyphs[cp] = g); // espace sans pixels : avance seule
+  if (surf->format->format != SDL_PIXELFORMAT_ARGB8888)
+  {
+    SDL_Surface *conv = SDL_ConvertSurfaceFormat(surf, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(surf);
+    if (!conv)
+      return nullptr;
+    surf = conv;
+  }
 
-  // Stats persistantes par joueur
-  struct PlayerStats
+  if (surf->w > UI_GLYPH_ATLAS_SIZE || surf->h > UI_GLYPH_ATLAS_SIZE)
   {
-    int win = 0, loss = 0, push = 0;
-  };
-  std::vector<PlayerStats> stats;
+    SDL_FreeSurface(surf);
+    return nullptr;
+  }
+  if (a.penX + surf->w > UI_GLYPH_ATLAS_SIZE)
+  {
+    a.penX = 0;
+    a.penY += a.rowH + 1;
+    a.rowH = 0;
+  }
+  if (a.penY + surf->h > UI_GLYPH_ATLAS_SIZE)
+  {
+    a.glyphs.clear(); // les pixels restent, seules les positions sont oubliées
+    a.penX = a.penY = a.rowH = 0;
+  }
 
-  // Compteur de manches terminées (pour déclencher l'anim de révélation)
-  std::atomic<uint64_t> roundSerial{0};
+  g.src = SDL_Rect{a.penX, a.penY, surf->w, surf->h};
+  if (!g.advance)
+    g.advance = surf->w;
+  SDL_UpdateTexture(a.tex, &g.src, surf->pixels, surf->pitch);
+  SDL_FreeSurface(surf);
 
-  // Pour fermeture propre
-  std::atomic<bool> quit{false};
-};
+  a.penX += g.src.w + 1;
+  a.rowH = std::max(a.rowH, g.src.h);
+  return &(a.glyphs[cp] = g);
+}
 
-// ============================= WebSocket Server =============================
-#include <set>
+// Dessine la chaîne glyphe par glyphe depuis l'atlas : un seul lot (appel de géométrie) par chaîne
+static void drawTextGlyphs(SDL_Renderer *r, TTF_Font *f, const std::string &txt, int x, int y)
+{
+  GlyphAtlas &a = g_text.atlases[f];
+  int pen = x;
+  uint32_t prev = 0;
+  for (size_t i = 0; i < txt.size();)
+  {
+    const uint32_t cp = utf8Next(txt, i);
+    const Glyph *g = glyphFor(r, f, a, cp);
+    if (!g)
+      continue;
+#if defined(SDL_TTF_VERSION_ATLEAST)
+#if SDL_TTF_VERSION_ATLEAST(2, 0, 14)
+    if (prev && prev <= 0xFFFF && cp <= 0xFFFF)
+      pen += TTF_GetFontKerningSizeGlyphs(f, (Uint16)prev, (Uint16)cp);
+#endif
+#endif
+    prev = cp;
+    if (g->src.w)
+      g_text.batch.add(g->src, SDL_Rect{pen, y, g->src.w, g->src.h});
+    pen += g->advance;
+  }
+  g_text.batch.flush(r, a.tex, UI_GLYPH_ATLAS_SIZE, UI_GLYPH_ATLAS_SIZE);
+}
 
-class WsHub
+// À appeler une fois par image rendue : libère les textures des chaînes qui ne s'affichent plus
+static void textBeginFrame()
 {
-public:
-  using server = websocketpp::server<websocketpp::config::asio>;
-
-  WsHub() : running(false), bridge(nullptr) {}
-
-  void start(unsigned short port, Bridge *b)
-  {
-    bridge = b;
-    ws.clear_access_channels(websocketpp::log::alevel::all);
-    ws.init_asio();
-    ws.set_open_handler([this](websocketpp::connection_hdl hdl)
-                        {
-            std::lock_guard<std::mutex> lk(m);
-            conns.insert(hdl); });
-    ws.set_close_handler([this](websocketpp::connection_hdl hdl)
-                         {
-            std::lock_guard<std::mutex> lk(m);
-            conns.erase(hdl); });
-    ws.set_message_handler([this](websocketpp::connection_hdl hdl, server::message_ptr msg)
-                           { handle_message(hdl, msg->get_payload()); });
-    ws.listen(WS_PORT);
-    ws.start_accept();
-    running.store(true);
-    th = std::thread([this]
-                     { ws.run(); });
-  }
-
-  void stop()
-  {
-    if (!running.exchange(false))
-      return;
-    websocketpp::lib::error_code ec;
-    ws.stop_listening();
+  ++g_text.frame;
+  if (g_text.frame % 60)
+    return;
+  for (auto &fs : g_text.strings)
+  {
+    for (auto it = fs.second.begin(); it != fs.second.end();)
     {
-      std::lock_guard<std::mutex> lk(m);
-      for (auto const &c : conns)
+      if (g_text.frame - it->second.lastFrame > UI_TEXT_CACHE_IDLE)
       {
-        ws.close(c, websocketpp::close::status::normal, "shutdown", ec);
+        if (it->second.tex)
+          SDL_DestroyTexture(it->second.tex);
+        it = fs.second.erase(it);
+      }
+      else
+      {
+        ++it;
       }
-      conns.clear();
     }
-    ws.stop();
-    if (th.joinable())
-      th.join();
   }
+}
+
+static void textShutdown()
+{
+  for (auto &fs : g_text.strings)
+    for (auto &e : fs.second)
+      if (e.second.tex)
+        SDL_DestroyTexture(e.second.tex);
+  for (auto &fa : g_text.atlases)
+    if (fa.second.tex)
+      SDL_DestroyTexture(fa.second.tex);
+  g_text.strings.clear();
+  g_text.atlases.clear();
+}
 
-  void broadcast(const std::string &text)
+static void drawText(SDL_Renderer *r, TTF_Font *f, const std::string &txt, int x, int y)
+{
+  if (!f || txt.empty())
+    return;
+  CachedText &e = g_text.strings[f][txt];
+  if (e.lastFrame != g_text.frame)
   {
-    std::lock_guard<std::mutex> lk(m);
-    for (auto const &c : conns)
-    {
-      websocketpp::lib::error_code se;
-      ws.send(c, text, websocketpp::frame::opcode::text, se);
-    }
+    e.lastFrame = g_text.frame;
+    e.frames++;
   }
-
-private:
-  void handle_message(websocketpp::connection_hdl, const std::string &payload)
+  if (!e.tex && e.frames >= UI_TEXT_CACHE_PROMOTE)
   {
-    auto act = parse_action(payload);
-    if (act.empty() || !bridge)
-      return;
-
-    std::unique_lock<std::mutex> lk(bridge->m);
-    if (!bridge->pendingCtx)
-      return; // rien à décider
-
-    if (act == "tirer_carte")
-    {
-      bridge->chosen = PlayerAction::Hit;
-    }
-    else if (act == "pret" || act == "stand")
-    {
-      bridge->chosen = PlayerAction::Stand;
-    }
-    else if (act == "double")
+    // Chaîne stable : rastérisée une fois en entier, puis copiée telle quelle
+    SDL_Color col{255, 255, 255, 255};
+    if (SDL_Surface *surf = TTF_RenderUTF8_Blended(f, txt.c_str(), col))
     {
-      if (bridge->pendingCtx->handCards.size() == 2)
-        bridge->chosen = PlayerAction::DoubleDown;
-      else
-        return; // ignore si non autorisé
+      e.tex = SDL_CreateTextureFromSurface(r, surf);
+      e.w = surf->w;
+      e.h = surf->h;
+      SDL_FreeSurface(surf);
     }
-    else
-    {
-      return;
-    }
-    bridge->cv.notify_all();
-  }
-
-  static std::string parse_action(const std::string &s)
-  {
-    // 1) texte brut
-    std::string t;
-    t.reserve(s.size());
-    for (char c : s)
-      t.push_back((char)std::tolower((unsigned char)c));
-    if (t == "tirer_carte" || t == "pret" || t == "stand" || t == "double" || t == "rejouer")
-      return t;
-
-    // 2) JSON minimal: "action":"xxx"
-    auto p = t.find("\"action\"");
-    if (p == std::string::npos)
-      return {};
-    p = t.find(':', p);
-    if (p == std::string::npos)
-      return {};
-    p = t.find('"', p);
-    if (p == std::string::npos)
-      return {};
-    auto q = t.find('"', p + 1);
-    if (q == std::string::npos)
-      return {};
-    return t.substr(p + 1, q - (p + 1));
-  }
-
-  server ws;
-  std::thread th;
-  std::mutex m;
-  std::set<websocketpp::connection_hdl, std::owner_less<websocketpp::connection_hdl>> conns;
-  std::atomic<bool> running;
-
-public:
-  Bridge *bridge; // après, car on a besoin du type complet pour accéder à ses membres
-};
-
-// Global
-static std::unique_ptr<WsHub> g_ws;
-
-// Helpers JSON pour diffuser des cartes (indices 0..51)
-static std::string json_array_from_cards(const std::vector<Card> &cards)
-{
-  std::string out = "[";
-  for (size_t i = 0; i < cards.size(); ++i)
+  }
+  if (e.tex)
   {
-    if (i)
-      out += ",";
-    out += std::to_string(cardToImageIndex(cards[i]));
+    SDL_Rect dst{x, y, e.w, e.h};
+    SDL_RenderCopy(r, e.tex, nullptr, &dst);
+    return;
   }
-  out += "]";
-  return out;
-}
-
-static DecisionContextCopy copyCtx(const DecisionContext &ctx)
-{
-
-  DecisionContextCopy c;
-  c.playerIndex = ctx.playerIndex;
-  c.roundNumber = ctx.roundNumber;
-  c.dealerUp = ctx.dealerUpcard;
-  c.handCards = ctx.hand.cards; // copie
-  return c;
+  drawTextGlyphs(r, f, txt, x, y);
 }
 
-// DecisionFn bloquante : attend un geste depuis l'UI
-static PlayerAction humanDecision(Bridge *bridge, const DecisionContext &ctx)
+// Calcule la meilleure valeur blackjack (<=21 si possible) pour une main affichée
+static std::pair<int, bool> uiBestTotal(const std::vector<Card> &cards)
 {
-  std::unique_lock<std::mutex> lk(bridge->m);
-  bridge->pendingCtx = copyCtx(ctx);
-  bridge->chosen.reset();
-  bridge->cv.notify_all();
-
-  // Broadcast main initiale au microcontrôleur
-  if (g_ws)
+  int total = 0;
+  int aces = 0;
+  for (const auto &c : cards)
   {
-    auto c = copyCtx(ctx);
-    std::string payload = std::string("{\"action\":\"main_initiale\",") + "\"round\":" + std::to_string(c.roundNumber) + "," + "\"dealer_up\":" + std::to_string(cardToImageIndex(c.dealerUp)) + "," + "\"cartes\":" + json_array_from_cards(c.handCards) + "}";
-    g_ws->broadcast(payload);
+    if (c.rank == Rank::Ace)
+      aces++;
+    else
+      total += Card::faceValueNonAce(c.rank);
   }
-
-  // Attendre l'utilisateur
-  while (!bridge->quit.load())
+  total += aces; // tous les As comptés 1
+  bool soft = false;
+  if (aces > 0 && total + 10 <= 21)
   {
-    if (bridge->chosen.has_value())
-    {
-      PlayerAction act = *bridge->chosen;
-      bridge->pendingCtx.reset();
-      bridge->chosen.reset();
-      return act;
-    }
-    bridge->cv.wait_for(lk, std::chrono::milliseconds(50));
+    total += 10;
+    soft = true;
   }
-  // Si on quitte, considérer Stand par défaut
-  return PlayerAction::Stand;
+  return {total, soft};
 }
 
 // ============================= Détection de gestes =============================
@@ -528,44 +645,45 @@ static GestureResult analyzeGesture(TapTracker &t, float upX, float upY, uint64_
 
 // ============================= Rendu simple =============================
 
-static void drawCard(SDL_Renderer *r, TTF_Font *f, const Card &c,
-                     int x, int y, int w = UI_CARD_W, int h = UI_CARD_H)
+// Ajoute une carte au lot : image (ou dos) + cadre blanc de 1 px, tout depuis l'atlas.
+// Face manquante : fond vert uni, son code est renvoyé pour être écrit après le lot.
+static bool batchCard(SpriteBatch &b, const Card *c, int x, int y, int w, int h)
 {
-  const int idx = cardToImageIndex(c);
-  if (idx >= 0 && idx < 52 && g_cardTex[idx])
-  {
-    SDL_Rect dst{x, y, w, h};
-    SDL_RenderCopy(r, g_cardTex[idx], nullptr, &dst);
-    // Optionnel: cadre léger
-    SDL_SetRenderDrawColor(r, 255, 255, 255, 255);
-    SDL_RenderDrawRect(r, &dst);
-    return;
-  }
-  // Fallback (si image manquante): rectangle + code carte
-  SDL_Rect rect{x, y, w, h};
-  SDL_SetRenderDrawColor(r, 20, 120, 20, 255);
-  SDL_RenderFillRect(r, &rect);
-  SDL_SetRenderDrawColor(r, 255, 255, 255, 255);
-  SDL_RenderDrawRect(r, &rect);
-  if (f)
-  {
-    drawText(r, f, c.toString(), x + 8, y + 8);
-  }
+  const SDL_Rect dst{x, y, w, h};
+  const SDL_Rect px = g_cards.white();
+  const int idx = c ? cardToImageIndex(*c) : UI_ATLAS_BACK;
+  const bool face = !c || (idx >= 0 && idx < 52 && g_cards.have[idx]);
+  if (face)
+    b.add(g_cards.cell(idx), dst);
+  else
+    b.add(px, dst, SDL_Color{20, 120, 20, 255});
+  const SDL_Color white{255, 255, 255, 255};
+  b.add(px, SDL_Rect{x, y, w, 1}, white);
+  b.add(px, SDL_Rect{x, y + h - 1, w, 1}, white);
+  b.add(px, SDL_Rect{x, y, 1, h}, white);
+  b.add(px, SDL_Rect{x + w - 1, y, 1, h}, white);
+  return face;
 }
 
+// Main en un seul lot : les n premières cartes face visible, les suivantes de dos
 static void drawHandN(SDL_Renderer *r, TTF_Font *f, const std::vector<Card> &cards, int x, int y, int n)
 {
-  int offset = UI_CARD_STEP;
-  int w = UI_CARD_W;
-  int h = UI_CARD_H;
-  int i = 0;
+  static SpriteBatch batch;
+  static std::vector<std::pair<int, const Card *>> missing; // faces sans image : code écrit après
+  const int offset = UI_CARD_STEP;
+  const int w = UI_CARD_W;
+  const int h = UI_CARD_H;
   n = std::max(0, std::min((int)cards.size(), n));
-  for (int k = 0; k < n; ++k)
+  missing.clear();
+  for (int k = 0; k < (int)cards.size(); ++k)
   {
-    const auto &c = cards[k];
-    drawCard(r, f, c, x + i * offset, y, w, h);
-    ++i;
+    const Card *c = k < n ? &cards[k] : nullptr;
+    if (!batchCard(batch, c, x + k * offset, y, w, h))
+      missing.emplace_back(x + k * offset, c);
   }
+  batch.flush(r, g_cards.tex, g_cards.texW, g_cards.texH);
+  for (const auto &m : missing)
+    drawText(r, f, m.second->toString(), m.first + 8, y + 8);
 }
 
 static void drawHand(SDL_Renderer *r, TTF_Font *f, const std::vector<Card> &cards, int x, int y)
@@ -580,84 +698,19 @@ static void fillRect(SDL_Renderer *r, int x, int y, int w, int h, SDL_Color col)
   SDL_RenderFillRect(r, &rc);
 }
 
-// ============================= Thread moteur =============================
-
-struct EngineThreadCfg
-{
-  GameConfig cfg;
-  int numHuman = 1; // 1 humain par défaut
-  int numAI = 0;    // joueurs IA supplémentaires
-  uint64_t seed = 42;
-};
-
-static void engineThread(Bridge *bridge, EngineThreadCfg etcfg)
-{
-  BlackjackEngine engine(etcfg.cfg, etcfg.seed);
-
-  // Ajout joueurs
-  // Joueur 0 humain
-  engine.addPlayer("Vous", [bridge](const DecisionContext &ctx)
-                   { return humanDecision(bridge, ctx); }, 500.0, 10.0);
-  for (int i = 0; i < etcfg.numAI && (i + 1) < 4; ++i)
-  {
-    engine.addPlayer(std::string("IA ") + std::to_string(i + 1), basicStrategy, 500.0, 10.0);
-    std::lock_guard<std::mutex> lk(bridge->m);
-    bridge->stats.assign(engine.players().size(), {});
-  }
-
-  while (!bridge->quit.load())
-  {
-    RoundResult rr = engine.playOneRound();
-    {
-      std::lock_guard<std::mutex> lk(bridge->m);
-      bridge->lastRound = rr;
-
-      if (bridge->stats.size() != rr.players.size())
-        bridge->stats.assign(rr.players.size(), {});
-
-      for (size_t i = 0; i < rr.players.size(); ++i)
-      {
-        double d = rr.players[i].outcome.deltaChips;
-        if (d > 0)
-          bridge->stats[i].win++;
-        else if (d < 0)
-          bridge->stats[i].loss++;
-        else
-          bridge->stats[i].push++;
-      }
-
-      bridge->roundSerial++;
-
-      // Broadcast fin de partie pour le joueur 0 (humain)
-      if (g_ws && !rr.players.empty())
-      {
-        const auto &pr = rr.players[0];
-        int dealerTot = rr.dealer.total();
-        int playerTot = pr.hand.total();
-        std::string outcome = (pr.outcome.blackjack ? "Blackjack" : (pr.outcome.deltaChips > 0 ? "Victoire" : (pr.outcome.deltaChips < 0 ? "Defaite" : "Egalite")));
-        std::string payload = std::string("{\"action\":\"fin_partie\",") + "\"dealer_total\":" + std::to_string(dealerTot) + "," + "\"player_total\":" + std::to_string(playerTot) + "," + "\"delta\":" + std::to_string((int)std::round(pr.outcome.deltaChips)) + "," + "\"resultat\":\"" + outcome + "\"," + "\"dealer_cartes\":" + json_array_from_cards(rr.dealer.cards) + "," + "\"player_cartes\":" + json_array_from_cards(pr.hand.cards) + "}";
-        g_ws->broadcast(payload);
-      }
-    }
-    bridge->cv.notify_all();
-    // Petite pause d'1.2s pour laisser lire le résultat
-    // Pause paramétrable pour laisser lire le résultat, tout en restant interruptible
-    int remaining = UI_ROUND_PAUSE_MS;
-    while (remaining > 0 && !bridge->quit.load())
-    {
-      std::this_thread::sleep_for(std::chrono::milliseconds(50));
-      remaining -= 50;
-    }
-  }
-}
-
 // ============================= Programme principal =============================
 
 int main(int argc, char **argv)
 {
   bool fullscreen = false;
 
-  int aiPlayers = 0; // 0..3
+  int aiPlayers = 0;    // 0..3
+  int humanPlayers = 1; // 1..4 (sièges réclamables par les terminaux)
+  int numTables = 1;    // tables hébergées (la table 0 est affichée)
+  bool aiMonteCarlo = false;
+  int mcBudgetMs = 5;
+  std::string ledgerPath = "blackjack_ledger.bin"; // soldes persistants ("" : désactivé)
+  std::string shmName; // --shm[=NOM] : UI seule, table 0 d'un blackjack_server --shm
 
   for (int i = 1; i < argc; ++i)
   {
@@ -666,6 +719,22 @@ int main(int argc, char **argv)
       fullscreen = true;
     else if (a.rfind("--ai=", 0) == 0)
       aiPlayers = std::max(0, std::min(3, std::atoi(a.c_str() + 5)));
+    else if (a.rfind("--humans=", 0) == 0)
+      humanPlayers = std::max(1, std::min(4, std::atoi(a.c_str() + 9)));
+    else if (a.rfind("--tables=", 0) == 0)
+      numTables = std::max(1, std::min(256, std::atoi(a.c_str() + 9)));
+    else if (a == "--ai-mc")
+      aiMonteCarlo = true;
+    else if (a.rfind("--mc-ms=", 0) == 0)
+      mcBudgetMs = std::max(1, std::atoi(a.c_str() + 8));
+    else if (a.rfind("--ledger=", 0) == 0)
+      ledgerPath = a.substr(9);
+    else if (a == "--no-ledger")
+      ledgerPath.clear();
+    else if (a == "--shm")
+      shmName = "/echoplay";
+    else if (a.rfind("--shm=", 0) == 0)
+      shmName = a.substr(6);
   }
 
   if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS | SDL_INIT_TIMER) != 0)
@@ -715,24 +784,98 @@ int main(int argc, char **argv)
   // Charger les images de cartes
   if (!loadCardTextures(ren))
   {
-    std::cerr << "Cartes: certaines textures n'ont pas pu être chargées depuis " << UI_CARDS_DIR << "\n";
+    std::cerr << "Cartes: certaines images n'ont pas pu être chargées depuis " << UI_CARDS_DIR << "\n";
   }
 
-  // Config blackjack
-  EngineThreadCfg etcfg;             // valeurs par défaut
-  etcfg.numAI = aiPlayers;           // seats IA
-  etcfg.cfg.numDecks = 4;            // param modifiable
-  etcfg.cfg.roundsBeforeShuffle = 8; // param modifiable
-  etcfg.cfg.dealerHitThreshold = 16; // ≤16 tire
-  etcfg.cfg.dealerHitsSoft17 = false;
-  etcfg.cfg.blackjackPayout = 1.5;
+  // Config blackjack (identique pour toutes les tables)
+  TableCfg tcfg;                    // valeurs par défaut
+  tcfg.numHuman = humanPlayers;     // sièges humains
+  tcfg.numAI = aiPlayers;           // seats IA
+  tcfg.aiMonteCarlo = aiMonteCarlo; // IA Monte Carlo (--ai-mc)
+  tcfg.mc.budgetMs = mcBudgetMs;    // budget par décision IA (--mc-ms=)
+  tcfg.pauseMs = UI_ROUND_PAUSE_MS; // affichage du récap entre deux manches
+  tcfg.cfg.numDecks = 4;            // param modifiable
+  tcfg.cfg.roundsBeforeShuffle = 8; // param modifiable
+  tcfg.cfg.dealerHitThreshold = 16; // ≤16 tire
+  tcfg.cfg.dealerHitsSoft17 = false;
+  tcfg.cfg.blackjackPayout = 1.5;
+
+  // Table 0 affichée ici ; les autres tables ne sont servies qu'aux terminaux WebSocket.
+  // --shm : ni moteur, ni hub, ni registre dans ce processus ; la table 0 vient d'un
+  // blackjack_server --shm (mémoire partagée), qui survit à un plantage de l'UI.
+  BusyMeter uiBusy; // temps de travail de la boucle d'affichage (page /metrics du hub)
+  const Uint32 wakeEvent = SDL_RegisterEvents(1); // nouvelle vue du moteur local
+  std::atomic<bool> wakePending{false};
+  WsHub hub;
+  std::unique_ptr<TableManager> tables;
+  PlayerLedger ledger;
+  ShmClient shm;
+  UiView view;
+  if (shmName.empty())
+  {
+    tables = std::make_unique<TableManager>(numTables, tcfg);
 
-  Bridge bridge;
+    // Soldes et bilans repris du registre ; chaque manche terminée y est ajoutée
+    if (!ledgerPath.empty())
+    {
+      std::string err;
+      if (ledger.open(ledgerPath, err))
+      {
+        ledger.restore(*tables);
+        tables->onRoundEnd = [&ledger](int table, int, const RoundResult &rr)
+        { ledger.append_round(table, rr); };
+      }
+      else
+      {
+        std::cerr << "Registre: " << err << " (soldes non persistés)\n";
+      }
+    }
+
+    hub.addBusyMeter("ui", &uiBusy);
+    hub.start(WS_PORT, tables.get());
+    // Vue de la table 0, poussée par le moteur (sans verrou) ; chaque vue réveille la boucle
+    // (un seul événement en file à la fois)
+    auto wake = [&]
+    {
+      if (wakePending.exchange(true))
+        return;
+      SDL_Event ev{};
+      ev.type = wakeEvent;
+      SDL_PushEvent(&ev);
+    };
+    view = tables->attachUi(0, wake);
+    tables->start();
+  }
+  else
+  {
+    std::string err;
+    if (!shm.open(shmName, err))
+      std::cerr << "Mémoire partagée: " << err << " (nouvel essai chaque seconde)\n";
+  }
 
-  g_ws = std::make_unique<WsHub>();
-  g_ws->start(WS_PORT, &bridge);
+  // Action pour le siège en attente de la table 0 : moteur local ou serveur
+  auto submit = [&](PlayerAction a)
+  {
+    if (tables)
+      tables->submit(0, -1, a);
+    else
+      shm.submit(0, -1, a);
+  };
 
-  std::thread th(engineThread, &bridge, etcfg);
+  // Vue de la table 0 : copiée seulement si elle a changé ; serveur absent -> réessai chaque seconde
+  uint64_t shmRetryAt = 0;
+  auto pollView = [&]
+  {
+    if (tables)
+      return tables->pollUi(0, view);
+    if (!shm.isOpen() && SDL_GetTicks64() >= shmRetryAt)
+    {
+      std::string err;
+      shm.open(shmName, err);
+      shmRetryAt = SDL_GetTicks64() + 1000;
+    }
+    return shm.poll(0, view);
+  };
 
   TapTracker tap;
 
@@ -741,40 +884,51 @@ int main(int argc, char **argv)
         if (!pctx) return false; return pctx->handCards.size() == 2; };
 
   bool running = true;
-  while (running && !bridge.quit.load())
+  bool dirty = true;          // image à redessiner
+  uint64_t redrawAt = 0;      // prochaine étape d'animation (ticks SDL, 0 : aucune)
+  bool serverShown = true;    // état "serveur présent" à l'écran (--shm)
+  while (running)
   {
+    // Attente : entrée, réveil du moteur, étape d'animation ou relecture --shm
+    int waitMs = tables ? UI_IDLE_WAIT_MS : UI_SHM_POLL_MS;
+    if (redrawAt)
+    {
+      const uint64_t now = SDL_GetTicks64();
+      waitMs = redrawAt <= now ? 0 : (int)std::min<uint64_t>(waitMs, redrawAt - now);
+    }
     SDL_Event e;
-    while (SDL_PollEvent(&e))
+    bool haveEvent = dirty ? SDL_PollEvent(&e) : SDL_WaitEventTimeout(&e, waitMs);
+    const auto frameStart = std::chrono::steady_clock::now();
+    for (; haveEvent; haveEvent = SDL_PollEvent(&e))
     {
+      if (e.type == wakeEvent)
+      {
+        wakePending = false; // la vue elle-même est relue par pollView()
+        continue;
+      }
+      if (e.type != SDL_MOUSEMOTION && e.type != SDL_FINGERMOTION)
+        dirty = true;
       if (e.type == SDL_QUIT)
       {
         running = false;
-        bridge.quit = true;
       }
       else if (e.type == SDL_KEYDOWN)
       {
         if (e.key.keysym.sym == SDLK_ESCAPE || e.key.keysym.sym == SDLK_q)
         {
           running = false;
-          bridge.quit = true;
         }
         else if (e.key.keysym.sym == SDLK_h)
         {
-          std::lock_guard<std::mutex> lk(bridge.m);
-          bridge.chosen = PlayerAction::Hit;
-          bridge.cv.notify_all();
+          submit(PlayerAction::Hit); // siège en attente (UI locale)
         }
         else if (e.key.keysym.sym == SDLK_s)
         {
-          std::lock_guard<std::mutex> lk(bridge.m);
-          bridge.chosen = PlayerAction::Stand;
-          bridge.cv.notify_all();
+          submit(PlayerAction::Stand); // siège en attente (UI locale)
         }
         else if (e.key.keysym.sym == SDLK_d)
         {
-          std::lock_guard<std::mutex> lk(bridge.m);
-          bridge.chosen = PlayerAction::DoubleDown;
-          bridge.cv.notify_all();
+          submit(PlayerAction::DoubleDown); // siège en attente (UI locale)
         }
       }
       else if (e.type == SDL_FINGERDOWN)
@@ -792,24 +946,15 @@ int main(int argc, char **argv)
         GestureResult gr = analyzeGesture(tap, upX, upY, upT);
         if (gr.type == GestureResult::DoubleTap)
         {
-          std::lock_guard<std::mutex> lk(bridge.m);
-          bridge.chosen = PlayerAction::Hit;
-          bridge.cv.notify_all();
+          submit(PlayerAction::Hit); // siège en attente (UI locale)
         }
         else if (gr.type == GestureResult::Swipe)
         {
-          std::lock_guard<std::mutex> lk(bridge.m);
-          bridge.chosen = PlayerAction::Stand;
-          bridge.cv.notify_all();
+          submit(PlayerAction::Stand); // siège en attente (UI locale)
         }
         else if (gr.type == GestureResult::LongPress)
         {
-          if (shouldAllowDouble(bridge.pendingCtx))
-          {
-            std::lock_guard<std::mutex> lk(bridge.m);
-            bridge.chosen = PlayerAction::DoubleDown;
-            bridge.cv.notify_all();
-          }
+          submit(PlayerAction::DoubleDown); // refusé si la main n'a pas 2 cartes
         }
         tap.down = false;
       }
@@ -827,29 +972,34 @@ int main(int argc, char **argv)
         GestureResult gr = analyzeGesture(tap, upX, upY, upT);
         if (gr.type == GestureResult::DoubleTap)
         {
-          std::lock_guard<std::mutex> lk(bridge.m);
-          bridge.chosen = PlayerAction::Hit;
-          bridge.cv.notify_all();
+          submit(PlayerAction::Hit); // siège en attente (UI locale)
         }
         else if (gr.type == GestureResult::Swipe)
         {
-          std::lock_guard<std::mutex> lk(bridge.m);
-          bridge.chosen = PlayerAction::Stand;
-          bridge.cv.notify_all();
+          submit(PlayerAction::Stand); // siège en attente (UI locale)
         }
         else if (gr.type == GestureResult::LongPress)
         {
-          if (shouldAllowDouble(bridge.pendingCtx))
-          {
-            std::lock_guard<std::mutex> lk(bridge.m);
-            bridge.chosen = PlayerAction::DoubleDown;
-            bridge.cv.notify_all();
-          }
+          submit(PlayerAction::DoubleDown); // refusé si la main n'a pas 2 cartes
         }
         tap.down = false;
       }
     }
 
+    if (pollView())
+      dirty = true;
+    if (!tables && shm.serverAlive() != serverShown)
+    {
+      serverShown = !serverShown;
+      dirty = true;
+    }
+    if (redrawAt && SDL_GetTicks64() >= redrawAt)
+      dirty = true;
+    if (!dirty || !running)
+      continue;
+    dirty = false;
+    redrawAt = 0;
+
     // Rendu
     int W = 0, H = 0;
     SDL_GetRendererOutputSize(ren, &W, &H);
@@ -860,6 +1010,7 @@ int main(int argc, char **argv)
     }
     SDL_SetRenderDrawColor(ren, UI_TABLE_COLOR.r, UI_TABLE_COLOR.g, UI_TABLE_COLOR.b, UI_TABLE_COLOR.a);
     SDL_RenderClear(ren);
+    textBeginFrame();
 
     // Zones
     SDL_Color dark{0, 0, 0, 100};
@@ -867,12 +1018,13 @@ int main(int argc, char **argv)
     fillRect(ren, 0, H / 2, W, H / 2, UI_TABLE_ZONE_BOTTOM); // zone joueur
 
     // Afficher contexte courant si on attend une décision
+    if (!serverShown)
+      drawText(ren, fonts.main, "Serveur absent (" + shmName + ")", W - 320, 20);
     {
-      std::lock_guard<std::mutex> lk(bridge.m);
-      if (bridge.pendingCtx)
+      if (view.pending)
       {
-        auto &c = *bridge.pendingCtx;
-        drawText(ren, fonts.main, "Votre tour — Round " + std::to_string(c.roundNumber), 20, H / 2 + 10);
+        auto &c = *view.pending;
+        drawText(ren, fonts.main, "Tour du siège " + std::to_string(c.playerIndex) + " — Round " + std::to_string(c.roundNumber), 20, H / 2 + 10);
         drawText(ren, fonts.main, "Croupier montre: " + c.dealerUp.toString(), 20, 20);
         // main joueur
         drawHand(ren, fonts.main, c.handCards, 20, H / 2 + 50);
@@ -882,25 +1034,26 @@ int main(int argc, char **argv)
           std::string tot = "Total: " + std::to_string(bt.first) + (bt.second ? " (soft)" : " (hard)");
           drawText(ren, fonts.main, tot, 20, H / 2 + 50 + UI_CARD_H + 8);
         }
-        if (!bridge.stats.empty())
+        if (!view.stats.empty())
         {
-          const auto &st = bridge.stats[0];
+          const auto &st = view.stats[std::min((size_t)c.playerIndex, view.stats.size() - 1)];
           std::string stat = "W:" + std::to_string(st.win) + " L:" + std::to_string(st.loss) + " P:" + std::to_string(st.push);
           drawText(ren, fonts.main, stat, 20, H / 2 + 50 + UI_CARD_H + 8 + 24);
         }
         drawText(ren, fonts.main, "Gestes: Double tap = HIT, Swipe = STAND, Long press = DOUBLE", 20, H - 40);
-        if (!shouldAllowDouble(bridge.pendingCtx))
+        if (!shouldAllowDouble(view.pending))
           drawText(ren, fonts.main, "(Double down indisponible)", 20, H - 20);
       }
-      else if (bridge.lastRound)
+      else if (view.lastRound)
       {
         // Affiche un bref résumé de la dernière manche
-        const auto &rr = *bridge.lastRound;
+        const auto &rr = *view.lastRound;
         int y = 20;
         drawText(ren, fonts.main, std::string("[Résultat] Dealer ") + (rr.dealerBlackjack ? "(BJ)" : ""), 20, y);
         y += 10;
-        // Révéler progressivement la main du croupier et afficher son total courant
-        uint64_t currentSerial = bridge.roundSerial.load();
+        // Révéler progressivement la main du croupier (cartes encore cachées : de dos) et
+        // afficher son total courant
+        uint64_t currentSerial = view.roundSerial;
         if (currentSerial != g_lastRoundSerialRendered)
         {
           g_revealStartTicks = SDL_GetTicks64();
@@ -909,6 +1062,8 @@ int main(int argc, char **argv)
         uint64_t elapsed = SDL_GetTicks64() - g_revealStartTicks;
         int dCount = (int)rr.dealer.cards.size();
         int showCount = std::max(1, std::min(dCount, (int)(1 + elapsed / UI_DEALER_REVEAL_STEP_MS)));
+        if (showCount < dCount)
+          redrawAt = g_revealStartTicks + (uint64_t)showCount * UI_DEALER_REVEAL_STEP_MS;
 
         drawHandN(ren, fonts.main, rr.dealer.cards, 20, 40, showCount);
         {
@@ -926,9 +1081,9 @@ int main(int argc, char **argv)
           line += (pr.outcome.blackjack ? "BJ " : "");
           line += (pr.hand.isBust() ? "BUST " : "");
           line += "Δ=" + std::to_string((int)std::round(pr.outcome.deltaChips));
-          if (i < bridge.stats.size())
+          if (i < view.stats.size())
           {
-            const auto &st = bridge.stats[i];
+            const auto &st = view.stats[i];
             line += std::string("  W:") + std::to_string(st.win) + " L:" + std::to_string(st.loss) + " P:" + std::to_string(st.push);
           }
           drawText(ren, fonts.main, line, 20, py);
@@ -945,14 +1100,17 @@ int main(int argc, char **argv)
     }
 
     SDL_RenderPresent(ren);
-    SDL_Delay(16);
+    uiBusy.add(std::chrono::steady_clock::now() - frameStart);
   }
 
-  bridge.quit = true;
-  bridge.cv.notify_all();
-  if (th.joinable())
-    th.join();
+  if (tables)
+  {
+    tables->table(0).bridge.quit = true; // décision en attente : "rester"
+    tables->stop();
+  }
+  shm.close();
 
+  textShutdown();
   if (fonts.main)
     TTF_CloseFont(fonts.main);
   unloadCardTextures();
@@ -961,11 +1119,8 @@ int main(int argc, char **argv)
   IMG_Quit();
   TTF_Quit();
   SDL_Quit();
-  if (g_ws)
-  {
-    g_ws->stop();
-    g_ws.reset();
-  }
+  hub.stop();
+  ledger.close();
   return 0;
 }
 
@@ -973,12 +1128,12 @@ int main(int argc, char **argv)
 BUILD — Ubuntu:
     sudo apt update
     sudo apt install g++ libsdl2-dev libsdl2-ttf-dev libsdl2-image-dev fonts-dejavu-core
-    g++ -std=c++17 -O2 blackjack_sdl_ui.cpp -o blackjack_touch -lSDL2 -lSDL2_ttf -lSDL2_image -pthread
+    g++ -std=c++17 -O2 blackjack_sdl_ui.cpp -o blackjack_touch -lSDL2 -lSDL2_ttf -lSDL2_image -pthread -lrt
 
 BUILD — Raspberry Pi Zero 2W (Raspberry Pi OS Bookworm/Bullseye):
     sudo apt update
     sudo apt install g++ libsdl2-dev libsdl2-ttf-dev libsdl2-image-dev fonts-dejavu-core
-    g++ -std=c++17 -O2 blackjack_sdl_ui.cpp -o blackjack_touch -lSDL2 -lSDL2_ttf -lSDL2_image -pthread
+    g++ -std=c++17 -O2 blackjack_sdl_ui.cpp -o blackjack_touch -lSDL2 -lSDL2_ttf -lSDL2_image -pthread -lrt
 
 Exécution en plein écran (Pi tactile):
     ./blackjack_touch --fullscreen
@@ -986,12 +1141,36 @@ Exécution en plein écran (Pi tactile):
 Joueurs IA supplémentaires (pour tester le tour de plusieurs joueurs):
     ./blackjack_touch --ai=2
 
+Plusieurs terminaux ESP32 (chacun réclame un siège via {"action":"rejoindre","siege":N}) :
+    ./blackjack_touch --humans=2 --ai=1
+
+Soldes persistants (registre blackjack_ledger.bin par défaut, --no-ledger pour désactiver) :
+    ./blackjack_touch --ledger=/home/pi/echoplay_ledger.bin
+
+Plusieurs tables sur la même machine (les terminaux rejoignent via "table":T ; table 0 affichée) :
+    ./blackjack_touch --tables=12 --humans=4
+
+UI dans un processus séparé du moteur et du hub (un plantage de l'UI ne coupe pas les terminaux) :
+    ./blackjack_server --humans=2 --shm
+    ./blackjack_touch --shm
+
+IA Monte Carlo (simule Hit/Stand/Double sur l'état réel du sabot, en parallèle sur tous les coeurs):
+    ./blackjack_touch --ai=3 --ai-mc --mc-ms=5
+
 Notes:
 - Gesture mapping :
     * Double tap (ou double clic) = HIT
     * Swipe horizontal (gauche/droite) = STAND
     * Long press (>600ms, peu de mouvement) = DOUBLE (seulement main à 2 cartes)
-- Cette UI fait tourner le moteur dans un thread séparé et bloque les décisions via un pont (mutex+cv),
-  ce qui laisse l'event loop SDL fluide.
-- Pour une UI plus riche (sprites de cartes, animations), conservez ce schéma de "Bridge" et remplacez le rendu.
+- Les moteurs tournent dans le TableManager (blackjack_tables.cpp) sur un pool fixe de workers ;
+  l'UI suit la table 0 par sa file UiView (poussée par le moteur, sans verrou) et lui soumet ses
+  actions par submit() (file d'actions sans verrou) : ni le rendu ni le moteur n'attendent l'autre.
+- Rendu à la demande : la boucle dort dans SDL_WaitEventTimeout ; le moteur la réveille (événement
+  SDL) à chaque vue poussée, et seules une entrée, une vue nouvelle ou une étape de la révélation
+  du croupier redessinent la table. Au repos (joueur qui réfléchit), ni CPU ni GPU ne travaillent.
+- Cartes : une seule texture (52 faces, dos, cellule blanche pour les cadres) ; chaque main part en
+  un seul SDL_RenderGeometry, quel que soit son nombre de cartes.
+- Texte : atlas de glyphes par police + cache de textures des chaînes stables (drawText) ; une chaîne
+  affichée à l'identique d'une image à l'autre ne coûte plus qu'un SDL_RenderCopy.
+- Pour une UI plus riche (sprites de cartes, animations), conservez ce schéma (UiView + submit) et remplacez le rendu.
 */
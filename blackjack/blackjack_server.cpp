@@ -0,0 +1,293 @@
+// blackjack_server.cpp
+// Serveur de table sans IHM : moteur(s) Blackjack + WsHub pour les terminaux ESP32.
+// - Aucune dépendance SDL (pas de fenêtre, de textures ni de polices) : adapté à un Pi
+//   dédié au service des terminaux.
+// - Même moteur, mêmes tables (TableManager) et même protocole JSON que blackjack_touch.
+// - Arrêt propre sur SIGINT / SIGTERM.
+// - --stats-sec=N : latences des terminaux (RTT ping/pong, délai de décision) journalisées.
+// - Métriques texte (format Prometheus) sur le port WebSocket : curl http://pi:8765/metrics
+// - --udp-port=P : actions des terminaux aussi acceptées en UDP (acquittées, sans doublon).
+// - --record=FILE : trafic des terminaux enregistré pour blackjack_replay (relecture déterministe).
+// - --decision-ms=MS : un siège muet joue "rester" d'office ; la table n'est jamais bloquée.
+// - --ledger=FILE : soldes et bilans des sièges persistants (registre, repris au démarrage).
+// - --shm[=NOM] : tables publiées en mémoire partagée pour une UI SDL lancée à part
+//   (blackjack_touch --shm) ; chacun des deux processus peut redémarrer sans gêner l'autre.
+// C++17
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <string>
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include "blackjack_engine.cpp"
+#include "blackjack_thread_pool.cpp"
+#include "blackjack_montecarlo.cpp"
+#include "blackjack_tables.cpp"
+#include "blackjack_ledger.cpp"
+#include "blackjack_shm.cpp"
+#include "blackjack_action_parser.cpp"
+#include "blackjack_ws_hub.cpp"
+#include "blackjack_ws_recorder.cpp"
+
+static const char *USAGE =
+    "Usage: blackjack_server [options]\n"
+    "  --port=P             port WebSocket (8765)\n"
+    "  --tables=N           nb de tables hébergées (1..256, 1)\n"
+    "  --humans=N           sièges réclamables par les terminaux, par table (1..4, 1)\n"
+    "  --ai=N               sièges IA par table (0..3, 0)\n"
+    "  --ai-mc              IA Monte Carlo au lieu de basicStrategy\n"
+    "  --mc-ms=MS           budget de temps par décision IA Monte Carlo (5)\n"
+    "  --workers=N          workers du TableManager (0 = nb de coeurs)\n"
+    "  --io-threads=N       threads réseau du WsHub (0 = nb de coeurs, 1)\n"
+    "  --udp-port=P         canal UDP des actions des terminaux (0 = désactivé, 0)\n"
+    "  --spectator-hz=N     cadence max de l'état envoyé aux spectateurs (10)\n"
+    "  --stats-sec=N        journal des latences par terminal toutes les N s (0 = non, 0)\n"
+    "  --record=FILE        enregistre le trafic WebSocket (relecture : blackjack_replay)\n"
+    "  --ledger=FILE        registre des soldes des sièges (repris au démarrage)\n"
+    "  --shm[=NOM]          tables publiées en mémoire partagée pour blackjack_touch --shm (/echoplay)\n"
+    "  --pause-ms=MS        pause entre deux manches (5000)\n"
+    "  --decision-ms=MS     délai de décision d'un siège avant \"rester\" d'office (0 = illimité, 30000)\n"
+    "  --seed=S             graine de la table 0 (42)\n"
+    "  --decks=N            paquets dans le sabot (4)\n"
+    "  --shuffle-rounds=N   manches avant reshuffle (8)\n"
+    "  --dealer-hit=N       le croupier tire tant que total <= N (16)\n"
+    "  --h17                le croupier tire sur soft 17\n"
+    "  --payout=X           paiement du Blackjack (1.5 = 3:2, 1.2 = 6:5)\n";
+
+// Mémoire résidente (Ko) depuis /proc/self/statm ; -1 si indisponible
+static long residentKb()
+{
+  long pages = 0, resident = 0;
+  FILE *f = std::fopen("/proc/self/statm", "r");
+  if (!f)
+    return -1;
+  int n = std::fscanf(f, "%ld %ld", &pages, &resident);
+  std::fclose(f);
+  if (n != 2)
+    return -1;
+  return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+// Une ligne par terminal : RTT et délai de décision (p50/p95/p99, ms) ; une seconde avec sa
+// télémétrie (moyenne/pire sur la dernière minute ; tas dernier/plus bas/depuis le démarrage)
+static void printClientStats(WsHub &hub)
+{
+  auto ms = [](uint32_t us)
+  { return us / 1000.0; };
+  const auto stats = hub.clientStats();
+  std::printf("[Latences] %zu client(s), %d dégradé(s)\n", stats.size(), hub.numDegraded());
+  for (const auto &c : stats)
+  {
+    const std::string place = c.spectator ? "spect" : c.seat >= 0 ? "s" + std::to_string(c.seat) : "-";
+    std::printf("  %-21s t%-3d %-5s RTT %6.1f/%6.1f/%6.1f ms (%3d)  décision %7.0f/%7.0f/%7.0f ms (%3d)%s\n",
+                c.remote.c_str(), c.table, place.c_str(),
+                ms(c.rttP50Us), ms(c.rttP95Us), ms(c.rttP99Us), c.rttSamples,
+                ms(c.decisionP50Us), ms(c.decisionP95Us), ms(c.decisionP99Us), c.decisionSamples,
+                c.degraded ? "  DÉGRADÉ" : "");
+    const auto &t = c.telemetry;
+    if (t.samples > 0)
+      std::printf("  %-21s boucle %5.1f/%6.1f ms  jpeg %5.1f/%5.1f ms (%3u)  tas %3u/%3u/%3u Ko  RSSI %4d/%4d dBm  reconnexions %u (+%u)  il y a %lld s\n",
+                  "", ms(t.loopAvgUs), ms(t.loopMaxUs), ms(t.jpegAvgUs), ms(t.jpegMaxUs), t.jpegCount,
+                  t.heapFree / 1024, t.heapLow / 1024, t.heapMin / 1024, t.rssi, t.rssiMin,
+                  t.reconnects, t.reconnectsWindow, (long long)(t.ageMs / 1000));
+  }
+  std::fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+  const auto t0 = std::chrono::steady_clock::now();
+
+  unsigned short port = 8765;
+  int numTables = 1;
+  unsigned workers = 0;
+  unsigned ioThreads = 1;
+  unsigned short udpPort = 0;
+  int spectatorHz = WsHub::kSpectatorHz;
+  int statsSec = 0;
+  std::string recordPath;
+  std::string ledgerPath;
+  std::string shmName;
+  TableCfg tcfg;
+  tcfg.numHuman = 1;
+  tcfg.numAI = 0;
+  tcfg.pauseMs = 5000;
+  tcfg.decisionMs = 30000;
+  tcfg.cfg.numDecks = 4;
+  tcfg.cfg.roundsBeforeShuffle = 8;
+  tcfg.cfg.dealerHitThreshold = 16;
+  tcfg.cfg.dealerHitsSoft17 = false;
+  tcfg.cfg.blackjackPayout = 1.5;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string a = argv[i];
+    auto val = [&](const char *prefix) -> const char *
+    { return a.rfind(prefix, 0) == 0 ? a.c_str() + std::strlen(prefix) : nullptr; };
+    const char *v = nullptr;
+    if (a == "--help" || a == "-h")
+    {
+      std::cout << USAGE;
+      return 0;
+    }
+    else if ((v = val("--port=")))
+      port = (unsigned short)std::atoi(v);
+    else if ((v = val("--tables=")))
+      numTables = std::max(1, std::min(256, std::atoi(v))); // table u8 du protocole binaire
+    else if ((v = val("--humans=")))
+      tcfg.numHuman = std::max(1, std::min(4, std::atoi(v)));
+    else if ((v = val("--ai=")))
+      tcfg.numAI = std::max(0, std::min(3, std::atoi(v)));
+    else if (a == "--ai-mc")
+      tcfg.aiMonteCarlo = true;
+    else if ((v = val("--mc-ms=")))
+      tcfg.mc.budgetMs = std::max(1, std::atoi(v));
+    else if ((v = val("--workers=")))
+      workers = (unsigned)std::max(0, std::atoi(v));
+    else if ((v = val("--io-threads=")))
+      ioThreads = (unsigned)std::max(0, std::atoi(v));
+    else if ((v = val("--udp-port=")))
+      udpPort = (unsigned short)std::atoi(v);
+    else if ((v = val("--spectator-hz=")))
+      spectatorHz = std::atoi(v);
+    else if ((v = val("--stats-sec=")))
+      statsSec = std::max(0, std::atoi(v));
+    else if ((v = val("--record=")))
+      recordPath = v;
+    else if ((v = val("--ledger=")))
+      ledgerPath = v;
+    else if (a == "--shm")
+      shmName = "/echoplay";
+    else if ((v = val("--shm=")))
+      shmName = v;
+    else if ((v = val("--pause-ms=")))
+      tcfg.pauseMs = std::max(0, std::atoi(v));
+    else if ((v = val("--decision-ms=")))
+      tcfg.decisionMs = std::max(0, std::atoi(v));
+    else if ((v = val("--seed=")))
+      tcfg.seed = std::strtoull(v, nullptr, 10);
+    else if ((v = val("--decks=")))
+      tcfg.cfg.numDecks = std::max(1, std::atoi(v));
+    else if ((v = val("--shuffle-rounds=")))
+      tcfg.cfg.roundsBeforeShuffle = std::max(1, std::atoi(v));
+    else if ((v = val("--dealer-hit=")))
+      tcfg.cfg.dealerHitThreshold = std::atoi(v);
+    else if (a == "--h17")
+      tcfg.cfg.dealerHitsSoft17 = true;
+    else if ((v = val("--payout=")))
+      tcfg.cfg.blackjackPayout = std::atof(v);
+    else
+    {
+      std::cerr << "Option inconnue: " << a << "\n"
+                << USAGE;
+      return 1;
+    }
+  }
+
+  // Bloquer SIGINT/SIGTERM avant de créer les threads : seul main les reçoit (sigwait)
+  sigset_t sigs;
+  sigemptyset(&sigs);
+  sigaddset(&sigs, SIGINT);
+  sigaddset(&sigs, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &sigs, nullptr);
+
+  WsHub hub;
+  TableManager tables(numTables, tcfg, workers);
+  TrafficRecorder recorder;
+  if (!recordPath.empty())
+  {
+    if (!recorder.open(recordPath, numTables, tcfg))
+    {
+      std::cerr << "[Serveur] enregistrement impossible : " << recordPath << "\n";
+      return 1;
+    }
+    hub.onTraffic = [&recorder](TrafficKind kind, uint32_t conn, std::string_view payload)
+    { recorder.record(kind, conn, payload); };
+  }
+  PlayerLedger ledger;
+  if (!ledgerPath.empty())
+  {
+    std::string err;
+    if (!ledger.open(ledgerPath, err))
+    {
+      std::cerr << "[Serveur] registre : " << err << "\n";
+      return 1;
+    }
+    ledger.restore(tables);
+    const auto ls = ledger.statsSnapshot();
+    std::cout << "[Serveur] registre " << ledgerPath << " : " << ls.recovered << " enregistrement(s) relu(s) après le point de reprise"
+              << (ls.truncatedBytes ? ", fin déchirée écartée (" + std::to_string(ls.truncatedBytes) + " octets)" : std::string()) << std::endl;
+    tables.onRoundEnd = [&ledger](int table, int, const RoundResult &rr)
+    { ledger.append_round(table, rr); };
+  }
+  ShmServer shm;
+  if (!shmName.empty())
+  {
+    std::string err;
+    if (!shm.open(shmName, tables, err))
+    {
+      std::cerr << "[Serveur] mémoire partagée : " << err << "\n";
+      return 1;
+    }
+  }
+  hub.setSpectatorHz(spectatorHz);
+  hub.setUdpPort(udpPort);
+  hub.start(port, &tables, ioThreads);
+  tables.start();
+
+  const double startMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+  std::cout << "[Serveur] port " << port << ", " << tables.numTables() << " table(s) x "
+            << tcfg.numHuman << " humain(s) + " << tcfg.numAI << " IA, "
+            << tables.numWorkers() << " worker(s), " << hub.numIoThreads() << " thread(s) réseau"
+            << (udpPort ? ", actions UDP sur le port " + std::to_string(udpPort) : std::string())
+            << (shmName.empty() ? std::string() : ", UI par mémoire partagée " + shmName) << "\n"
+            << "[Serveur] prêt en " << startMs << " ms, RSS " << residentKb() << " Ko, métriques sur http://<hôte>:"
+            << port << "/metrics" << std::endl;
+
+  if (statsSec == 0)
+  {
+    int sig = 0;
+    sigwait(&sigs, &sig);
+  }
+  else
+  {
+    const timespec period{statsSec, 0};
+    while (sigtimedwait(&sigs, nullptr, &period) < 0)
+      printClientStats(hub);
+  }
+
+  std::cout << "[Serveur] arrêt (" << tables.roundsPlayed() << " manches jouées)" << std::endl;
+  tables.stop();
+  shm.close();
+  hub.stop();
+  ledger.close();
+  if (!recordPath.empty())
+  {
+    std::cout << "[Serveur] " << recorder.records() << " enregistrement(s) dans " << recordPath << std::endl;
+    recorder.close();
+  }
+  return 0;
+}
+
+/*
+BUILD (Ubuntu / Raspberry Pi OS) — pas besoin de SDL :
+    sudo apt install g++ libwebsocketpp-dev libasio-dev
+    g++ -std=c++17 -O2 blackjack_server.cpp -o blackjack_server -pthread -lrt
+
+Exemples :
+    ./blackjack_server --humans=4
+    ./blackjack_server --port=9000 --tables=12 --humans=2 --ai=2 --decks=6 --h17 --payout=1.2
+    ./blackjack_server --tables=64 --humans=4 --io-threads=0
+    ./blackjack_server --humans=4 --stats-sec=10
+    ./blackjack_server --humans=4 --udp-port=8765
+    ./blackjack_server --humans=2 --record=salle.rec   puis   ./blackjack_replay salle.rec --fast
+    ./blackjack_server --humans=2 --shm                puis   ./blackjack_touch --shm
+*/
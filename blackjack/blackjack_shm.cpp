@@ -0,0 +1,679 @@
+// blackjack_shm.cpp
+// Canal mémoire partagée entre le serveur (moteurs + WsHub) et une UI SDL lancée dans un autre
+// processus : un gel ou un plantage de l'UI ne coupe plus les terminaux, et inversement.
+// - Deux objets POSIX (shm_open) :
+//     "<nom>.etat"    écrit par le serveur, projeté en lecture seule par l'UI ;
+//     "<nom>.actions" file d'actions UI -> serveur (seule mémoire que l'UI peut écrire).
+// - État : une case par table exportée (kMaxTables premières), UiView aplatie en structure
+//   de taille fixe (shm_layout::TableView) et versionnée par un seqlock. Écrite par le shard de la table
+//   au moment où il pousserait la vue vers une UI locale (TableManager::onUiView). L'UI ne
+//   recopie une case que si sa version a changé et ne reconstruit sa UiView qu'à ce moment :
+//   ni encodage ni copie sur le chemin de rendu d'une image.
+// - Actions : anneau un producteur (l'UI) / un consommateur (thread du serveur) dans la
+//   mémoire partagée, réveil par futex partagé (aucune attente active). Chaque action porte
+//   l'époque du serveur vue par l'UI : une action émise avant un redémarrage est écartée.
+// - Redémarrages : le serveur reprend les objets existants (jamais supprimés), réécrit toutes
+//   les cases (y compris un seqlock resté impair après un plantage) et change d'époque ; l'UI
+//   suit le changement d'époque et signale un battement de coeur arrêté. L'UI peut redémarrer à
+//   tout moment : l'anneau garde ses indices ; une seule UI productrice à la fois (pid).
+// - Mots partagés de 32 bits uniquement : une lecture atomique 64 bits sur ARMv7 (Pi OS 32 bits)
+//   peut être un ldrexd/strexd, interdit sur une projection en lecture seule.
+// - Linux (shm_open, mmap, futex).
+// À inclure après blackjack_tables.cpp.
+// C++17
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef BLACKJACK_SHM_BENCH
+#include "blackjack_engine.cpp"
+#include "blackjack_thread_pool.cpp"
+#include "blackjack_montecarlo.cpp"
+#include "blackjack_tables.cpp"
+#endif
+
+namespace shm_layout
+{
+  constexpr uint32_t kStateMagic = 0x45504C53;   // "EPLS"
+  constexpr uint32_t kActionsMagic = 0x45504C41; // "EPLA"
+  constexpr uint32_t kVersion = 1;               // à incrémenter à chaque changement de structure
+  constexpr int kMaxTables = 16;
+  constexpr int kMaxSeats = 8;  // 4 humains + 3 IA au plus
+  constexpr int kMaxCards = 12; // une main ne dépasse pas 11 cartes
+  constexpr uint32_t kRingSize = 64; // puissance de 2
+
+  static_assert(std::atomic<uint32_t>::is_always_lock_free, "atomique 32 bits requis en mémoire partagée");
+
+  struct Card8
+  {
+    uint8_t rank = 0, suit = 0;
+  };
+
+  struct Hand8
+  {
+    uint8_t n = 0;
+    Card8 cards[kMaxCards];
+  };
+
+  // UiView aplatie (copiable octet à octet, aucun pointeur)
+  struct TableView
+  {
+    uint32_t roundSerialLo = 0, roundSerialHi = 0;
+    // Décision en attente
+    uint8_t pending = 0;
+    uint8_t pendingSeat = 0;
+    Card8 dealerUp;
+    int32_t roundNumber = 0;
+    Hand8 hand;
+    // Dernière manche
+    uint8_t hasRound = 0;
+    uint8_t dealerBlackjack = 0;
+    uint8_t shuffled = 0;
+    uint8_t numPlayers = 0;
+    Hand8 dealer;
+    struct Player
+    {
+      Hand8 hand;
+      uint8_t blackjack = 0, bust = 0;
+      int32_t total = 0;
+      double delta = 0.0, bet = 0.0;
+    } players[kMaxSeats];
+    // Bilans par siège
+    uint8_t numStats = 0;
+    struct Stats
+    {
+      int32_t win = 0, loss = 0, push = 0;
+    } stats[kMaxSeats];
+  };
+
+  // Case d'une table : seqlock (impair = écriture en cours) + vue en mots atomiques relâchés
+  // (copie sans course de données, même pendant une écriture)
+  struct alignas(64) Slot
+  {
+    static constexpr size_t kWords = (sizeof(TableView) + 3) / 4;
+    std::atomic<uint32_t> seq;
+    std::atomic<uint32_t> words[kWords];
+  };
+
+  struct State
+  {
+    std::atomic<uint32_t> magic;
+    std::atomic<uint32_t> version;
+    std::atomic<uint32_t> epoch;       // change à chaque démarrage du serveur (jamais 0)
+    std::atomic<uint32_t> heartbeatMs; // horloge monotone (ms, modulo 2^32) ; 0 : serveur arrêté
+    std::atomic<uint32_t> numTables;   // tables exportées
+    Slot slots[kMaxTables];
+  };
+
+  struct Action
+  {
+    uint32_t epoch = 0;
+    int16_t table = 0;
+    int8_t seat = -1; // -1 : siège en attente de décision
+    uint8_t action = 0; // PlayerAction
+  };
+
+  struct Actions
+  {
+    std::atomic<uint32_t> magic;
+    std::atomic<uint32_t> version;
+    std::atomic<uint32_t> ownerPid; // UI productrice (0 : aucune)
+    alignas(64) std::atomic<uint32_t> tail; // écrit par l'UI
+    alignas(64) std::atomic<uint32_t> head; // écrit par le serveur
+    alignas(64) std::atomic<uint32_t> bell; // futex : +1 par action déposée
+    Action ring[kRingSize];
+  };
+
+  static uint32_t now_ms()
+  {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  // Futex partagé entre processus (pas de FUTEX_PRIVATE_FLAG)
+  static void futex_wait(std::atomic<uint32_t> &w, uint32_t seen, int timeoutMs)
+  {
+    struct timespec ts{timeoutMs / 1000, (long)(timeoutMs % 1000) * 1000000L};
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&w), FUTEX_WAIT, seen, &ts, nullptr, 0);
+  }
+
+  static void futex_wake(std::atomic<uint32_t> &w)
+  {
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&w), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+  }
+
+  // Projette l'objet name (size octets) ; créé et mis à zéro par le serveur au besoin
+  static void *map(const std::string &name, size_t size, bool create, bool writable, std::string &err)
+  {
+    const int fd = shm_open(name.c_str(), (writable ? O_RDWR : O_RDONLY) | (create ? O_CREAT : 0), 0600);
+    if (fd < 0)
+    {
+      err = "shm_open " + name + " : " + std::strerror(errno);
+      return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || ((size_t)st.st_size < size && (!create || ftruncate(fd, (off_t)size) != 0)))
+    {
+      err = "taille de " + name + " invalide (serveur d'une autre version ?)";
+      ::close(fd);
+      return nullptr;
+    }
+    void *p = mmap(nullptr, size, PROT_READ | (writable ? PROT_WRITE : 0), MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED)
+    {
+      err = "mmap " + name + " : " + std::strerror(errno);
+      return nullptr;
+    }
+    return p;
+  }
+
+  static Card8 pack(const Card &c) { return Card8{(uint8_t)c.rank, (uint8_t)c.suit}; }
+  static Card unpack(Card8 c) { return Card{(Rank)c.rank, (Suit)c.suit}; }
+
+  static void pack(Hand8 &h, const std::vector<Card> &cards)
+  {
+    h.n = (uint8_t)std::min<size_t>(cards.size(), kMaxCards);
+    for (int i = 0; i < h.n; ++i)
+      h.cards[i] = pack(cards[i]);
+  }
+
+  static std::vector<Card> unpack(const Hand8 &h)
+  {
+    std::vector<Card> out;
+    out.reserve(h.n);
+    for (int i = 0; i < std::min<int>(h.n, kMaxCards); ++i)
+      out.push_back(unpack(h.cards[i]));
+    return out;
+  }
+} // namespace shm_layout
+
+// Côté serveur : crée ou reprend les deux objets, publie la vue de chaque table exportée et
+// applique les actions de l'UI. open() avant tables.start(), close() après tables.stop().
+class ShmServer
+{
+public:
+  ~ShmServer() { close(); }
+
+  bool open(const std::string &name, TableManager &mgr, std::string &err)
+  {
+    using namespace shm_layout;
+    tables = &mgr;
+    state = static_cast<State *>(map(name + ".etat", sizeof(State), true, true, err));
+    if (!state)
+      return false;
+    actions = static_cast<Actions *>(map(name + ".actions", sizeof(Actions), true, true, err));
+    if (!actions)
+    {
+      close();
+      return false;
+    }
+    // Anneau : indices conservés si l'objet est déjà au bon format (UI peut-être attachée)
+    if (actions->magic.load() != kActionsMagic || actions->version.load() != kVersion)
+    {
+      actions->head.store(0);
+      actions->tail.store(0);
+      actions->ownerPid.store(0);
+      actions->version.store(kVersion);
+      actions->magic.store(kActionsMagic, std::memory_order_release);
+    }
+
+    numTables = std::min(mgr.numTables(), kMaxTables);
+    uint32_t e = state->epoch.load() + 1;
+    epoch = e == 0 ? 1 : e;
+    state->heartbeatMs.store(0);
+    state->numTables.store((uint32_t)numTables);
+    state->version.store(kVersion);
+    state->magic.store(kStateMagic);
+    for (int t = 0; t < numTables; ++t)
+      publish(t, mgr.uiState(t));
+    state->epoch.store(epoch, std::memory_order_release);
+
+    mgr.onUiView = [this](int t, const UiView &v)
+    {
+      if (t < numTables)
+        publish(t, v);
+    };
+    running = true;
+    worker = std::thread([this]
+                         { run(); });
+    return true;
+  }
+
+  // Vue d'une table dans sa case (shard de la table, ou open()) : un seul écrivain par case
+  void publish(int t, const UiView &v)
+  {
+    using namespace shm_layout;
+    TableView tv;
+    tv.roundSerialLo = (uint32_t)v.roundSerial;
+    tv.roundSerialHi = (uint32_t)(v.roundSerial >> 32);
+    if (v.pending)
+    {
+      tv.pending = 1;
+      tv.pendingSeat = (uint8_t)v.pending->playerIndex;
+      tv.dealerUp = pack(v.pending->dealerUp);
+      tv.roundNumber = v.pending->roundNumber;
+      pack(tv.hand, v.pending->handCards);
+    }
+    if (v.lastRound)
+    {
+      const RoundResult &rr = *v.lastRound;
+      tv.hasRound = 1;
+      tv.dealerBlackjack = rr.dealerBlackjack;
+      tv.shuffled = rr.shuffledThisRound;
+      pack(tv.dealer, rr.dealer.cards);
+      tv.numPlayers = (uint8_t)std::min<size_t>(rr.players.size(), kMaxSeats);
+      for (int i = 0; i < tv.numPlayers; ++i)
+      {
+        const PlayerRoundResult &pr = rr.players[i];
+        pack(tv.players[i].hand, pr.hand.cards);
+        tv.players[i].blackjack = pr.outcome.blackjack;
+        tv.players[i].bust = pr.outcome.bust;
+        tv.players[i].total = pr.outcome.total;
+        tv.players[i].delta = pr.outcome.deltaChips;
+        tv.players[i].bet = pr.bet;
+      }
+    }
+    tv.numStats = (uint8_t)std::min<size_t>(v.stats.size(), kMaxSeats);
+    for (int i = 0; i < tv.numStats; ++i)
+      tv.stats[i] = {v.stats[i].win, v.stats[i].loss, v.stats[i].push};
+
+    uint32_t w[Slot::kWords] = {};
+    std::memcpy(w, &tv, sizeof tv);
+    Slot &s = state->slots[t];
+    uint32_t seq = s.seq.load(std::memory_order_relaxed);
+    seq += (seq & 1) ? 1 : 2; // impair : écrivain précédent interrompu (plantage)
+    s.seq.store(seq - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < Slot::kWords; ++i)
+      s.words[i].store(w[i], std::memory_order_relaxed);
+    s.seq.store(seq, std::memory_order_release);
+  }
+
+  // Actions appliquées / écartées (époque périmée, table ou action invalide)
+  uint64_t applied() const { return numApplied.load(std::memory_order_relaxed); }
+  uint64_t dropped() const { return numDropped.load(std::memory_order_relaxed); }
+
+  void close()
+  {
+    using namespace shm_layout;
+    if (running.exchange(false))
+    {
+      actions->bell.fetch_add(1);
+      futex_wake(actions->bell);
+      worker.join();
+    }
+    if (tables)
+      tables->onUiView = nullptr;
+    tables = nullptr;
+    if (state)
+    {
+      state->heartbeatMs.store(0); // l'UI affiche aussitôt "serveur arrêté"
+      munmap(state, sizeof(State));
+      state = nullptr;
+    }
+    if (actions)
+    {
+      munmap(actions, sizeof(Actions));
+      actions = nullptr;
+    }
+  }
+
+private:
+  static constexpr int kHeartbeatMs = 100;
+
+  // Vide l'anneau vers les tables, bat le coeur, dort sur la sonnette
+  void run()
+  {
+    using namespace shm_layout;
+    while (running.load())
+    {
+      const uint32_t now = now_ms();
+      state->heartbeatMs.store(now == 0 ? 1 : now, std::memory_order_release);
+      const uint32_t bell = actions->bell.load(std::memory_order_acquire);
+      uint32_t head = actions->head.load(std::memory_order_relaxed);
+      const uint32_t tail = actions->tail.load(std::memory_order_acquire);
+      if (tail - head > kRingSize)
+        head = tail; // indices incohérents (UI d'une autre version) : file vidée
+      for (; head != tail; ++head)
+      {
+        const Action a = actions->ring[head % kRingSize];
+        if (a.epoch == epoch && a.table >= 0 && a.table < numTables && a.action <= (uint8_t)PlayerAction::DoubleDown &&
+            tables->submit(a.table, a.seat, (PlayerAction)a.action))
+          numApplied.fetch_add(1, std::memory_order_relaxed);
+        else
+          numDropped.fetch_add(1, std::memory_order_relaxed);
+      }
+      actions->head.store(head, std::memory_order_release);
+      futex_wait(actions->bell, bell, kHeartbeatMs);
+    }
+  }
+
+  TableManager *tables = nullptr;
+  shm_layout::State *state = nullptr;
+  shm_layout::Actions *actions = nullptr;
+  int numTables = 0;
+  uint32_t epoch = 0;
+  std::atomic<bool> running{false};
+  std::thread worker;
+  std::atomic<uint64_t> numApplied{0}, numDropped{0};
+};
+
+// Côté UI : projette l'état en lecture seule et dépose les actions dans l'anneau. Tout se fait
+// sur le thread de rendu ; poll() ne copie une case que si sa version a changé.
+class ShmClient
+{
+public:
+  static constexpr uint32_t kStaleMs = 1000; // battement de coeur plus vieux : serveur absent
+  static constexpr int kMaxReadTries = 256;  // lecture d'un emplacement : essais avant abandon
+
+  ~ShmClient() { close(); }
+
+  bool open(const std::string &shmName, std::string &err)
+  {
+    using namespace shm_layout;
+    close();
+    name = shmName;
+    state = static_cast<const State *>(map(name + ".etat", sizeof(State), false, false, err));
+    if (!state)
+      return false;
+    actions = static_cast<Actions *>(map(name + ".actions", sizeof(Actions), false, true, err));
+    if (!actions)
+    {
+      close();
+      return false;
+    }
+    if (state->magic.load() != kStateMagic || state->version.load() != kVersion ||
+        actions->magic.load() != kActionsMagic || actions->version.load() != kVersion)
+    {
+      err = "objets " + name + ".* d'une autre version";
+      close();
+      return false;
+    }
+    // Une seule UI productrice : le pid d'une UI disparue (plantage) est repris
+    const uint32_t me = (uint32_t)getpid();
+    uint32_t owner = actions->ownerPid.load();
+    while (owner != me)
+    {
+      if (owner != 0 && kill((pid_t)owner, 0) == 0)
+      {
+        err = "une autre UI est attachée (pid " + std::to_string(owner) + ")";
+        close();
+        return false;
+      }
+      if (actions->ownerPid.compare_exchange_weak(owner, me))
+        break;
+    }
+    owner_ = true;
+    seen.fill(0);
+    return true;
+  }
+
+  bool isOpen() const { return state != nullptr; }
+
+  // Serveur vivant : battement de coeur récent
+  bool serverAlive() const
+  {
+    if (!state)
+      return false;
+    const uint32_t hb = state->heartbeatMs.load(std::memory_order_acquire);
+    return hb != 0 && shm_layout::now_ms() - hb < kStaleMs;
+  }
+
+  // Vue d'une table si elle a changé depuis le dernier appel (ou si le serveur a redémarré)
+  bool poll(int t, UiView &view)
+  {
+    using namespace shm_layout;
+    if (!state || t < 0 || t >= kMaxTables || t >= (int)state->numTables.load(std::memory_order_relaxed))
+      return false;
+    const uint32_t e = state->epoch.load(std::memory_order_acquire);
+    if (e != epoch)
+    {
+      epoch = e;
+      seen.fill(0);
+    }
+    const Slot &s = state->slots[t];
+    uint32_t w[Slot::kWords];
+    for (int tries = 0;; ++tries)
+    {
+      const uint32_t s1 = s.seq.load(std::memory_order_acquire);
+      if (s1 == seen[t])
+        return false;
+      // Serveur mort au milieu d'une écriture : numéro impair jusqu'à son redémarrage. Essais
+      // bornés, l'UI garde sa vue et continue de tourner (elle affichera "serveur absent")
+      if (tries >= kMaxReadTries || ((s1 & 1) && !serverAlive()))
+        return false;
+      if (s1 & 1)
+      {
+        std::this_thread::yield(); // écriture en cours (quelques centaines de ns)
+        continue;
+      }
+      for (size_t i = 0; i < Slot::kWords; ++i)
+        w[i] = s.words[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (s.seq.load(std::memory_order_relaxed) == s1)
+      {
+        seen[t] = s1;
+        break;
+      }
+    }
+    TableView tv;
+    std::memcpy(&tv, w, sizeof tv);
+    unpack(tv, view);
+    return true;
+  }
+
+  // Action de l'UI pour une table ; false si le serveur est absent ou l'anneau plein
+  bool submit(int t, int seat, PlayerAction a)
+  {
+    using namespace shm_layout;
+    if (!actions || !serverAlive())
+      return false;
+    const uint32_t tail = actions->tail.load(std::memory_order_relaxed);
+    if (tail - actions->head.load(std::memory_order_acquire) >= kRingSize)
+      return false;
+    actions->ring[tail % kRingSize] = Action{state->epoch.load(std::memory_order_relaxed), (int16_t)t, (int8_t)seat, (uint8_t)a};
+    actions->tail.store(tail + 1, std::memory_order_release);
+    actions->bell.fetch_add(1, std::memory_order_release);
+    futex_wake(actions->bell);
+    return true;
+  }
+
+  void close()
+  {
+    using namespace shm_layout;
+    if (actions)
+    {
+      if (owner_)
+        actions->ownerPid.store(0);
+      munmap(actions, sizeof(Actions));
+      actions = nullptr;
+    }
+    if (state)
+    {
+      munmap(const_cast<State *>(state), sizeof(State));
+      state = nullptr;
+    }
+    owner_ = false;
+    epoch = 0;
+  }
+
+private:
+  // Reconstruit la UiView (seulement quand la case a changé) ; la dernière manche n'est
+  // réallouée que si son numéro a changé
+  static void unpack(const shm_layout::TableView &tv, UiView &view)
+  {
+    using namespace shm_layout;
+    const uint64_t serial = (uint64_t)tv.roundSerialHi << 32 | tv.roundSerialLo;
+    view.pending.reset();
+    if (tv.pending)
+    {
+      DecisionContextCopy c;
+      c.handCards = shm_layout::unpack(tv.hand);
+      c.dealerUp = shm_layout::unpack(tv.dealerUp);
+      c.playerIndex = tv.pendingSeat;
+      c.roundNumber = tv.roundNumber;
+      view.pending = std::move(c);
+    }
+    if (!tv.hasRound)
+      view.lastRound.reset();
+    else if (!view.lastRound || serial != view.roundSerial)
+    {
+      auto rr = std::make_shared<RoundResult>();
+      rr->dealer.cards = shm_layout::unpack(tv.dealer);
+      rr->dealerBlackjack = tv.dealerBlackjack;
+      rr->shuffledThisRound = tv.shuffled;
+      rr->players.resize(std::min<int>(tv.numPlayers, kMaxSeats));
+      for (size_t i = 0; i < rr->players.size(); ++i)
+      {
+        PlayerRoundResult &pr = rr->players[i];
+        pr.hand.cards = shm_layout::unpack(tv.players[i].hand);
+        pr.outcome.blackjack = tv.players[i].blackjack;
+        pr.outcome.bust = tv.players[i].bust;
+        pr.outcome.total = tv.players[i].total;
+        pr.outcome.deltaChips = tv.players[i].delta;
+        pr.bet = tv.players[i].bet;
+      }
+      view.lastRound = std::move(rr);
+    }
+    view.stats.resize(std::min<int>(tv.numStats, kMaxSeats));
+    for (size_t i = 0; i < view.stats.size(); ++i)
+      view.stats[i] = {tv.stats[i].win, tv.stats[i].loss, tv.stats[i].push};
+    view.roundSerial = serial;
+  }
+
+  std::string name;
+  const shm_layout::State *state = nullptr;
+  shm_layout::Actions *actions = nullptr;
+  bool owner_ = false;
+  uint32_t epoch = 0;
+  std::array<uint32_t, shm_layout::kMaxTables> seen{}; // dernière version copiée par case
+};
+
+// ============================= Banc d'essai =============================
+
+#ifdef BLACKJACK_SHM_BENCH
+#include <cstdio>
+#include <vector>
+
+#include <sys/wait.h>
+
+// Serveur et UI dans deux processus (fork) : l'UI lit la vue de la table 0 à chaque "image"
+// et répond "rester" à chaque décision. Mesure le coût d'un poll() sans changement, d'une copie
+// de case et le délai action UI -> nouvelle vue publiée.
+int main(int argc, char **argv)
+{
+  const std::string name = "/echoplay_bench_" + std::to_string(getpid());
+  const int seconds = argc > 1 ? std::max(1, std::atoi(argv[1])) : 3;
+
+  const pid_t child = fork();
+  if (child == 0)
+  {
+    TableCfg tc;
+    tc.numHuman = 1;
+    tc.numAI = 2;
+    tc.pauseMs = 0;
+    TableManager tables(1, tc, 1);
+    ShmServer srv;
+    std::string err;
+    if (!srv.open(name, tables, err))
+    {
+      std::fprintf(stderr, "serveur: %s\n", err.c_str());
+      _exit(1);
+    }
+    tables.start();
+    std::this_thread::sleep_for(std::chrono::seconds(seconds + 1));
+    tables.stop();
+    srv.close();
+    std::printf("serveur: %llu action(s) appliquée(s), %llu écartée(s)\n", (unsigned long long)srv.applied(),
+                (unsigned long long)srv.dropped());
+    std::fflush(stdout); // _exit ne vide pas les tampons (stdout redirigé : bloc entier)
+    _exit(0);
+  }
+
+  ShmClient ui;
+  std::string err;
+  for (int i = 0; i < 100 && !ui.open(name, err); ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  if (!ui.isOpen())
+  {
+    std::fprintf(stderr, "ui: %s\n", err.c_str());
+    return 1;
+  }
+  UiView view;
+  std::vector<double> lat;
+  uint64_t polls = 0, changes = 0, rounds = 0;
+  double idleNs = 0;
+  auto sent = std::chrono::steady_clock::time_point{};
+  uint64_t lastSerial = 0;
+  const auto end = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+  while (std::chrono::steady_clock::now() < end)
+  {
+    const auto t0 = std::chrono::steady_clock::now();
+    const bool changed = ui.poll(0, view);
+    const auto t1 = std::chrono::steady_clock::now();
+    ++polls;
+    if (!changed)
+    {
+      idleNs += std::chrono::duration<double, std::nano>(t1 - t0).count();
+      continue;
+    }
+    ++changes;
+    if (sent != decltype(sent){})
+    {
+      lat.push_back(std::chrono::duration<double, std::micro>(t1 - sent).count());
+      sent = {};
+    }
+    if (view.roundSerial != lastSerial)
+    {
+      lastSerial = view.roundSerial;
+      ++rounds;
+    }
+    if (view.pending && ui.submit(0, -1, PlayerAction::Stand))
+      sent = std::chrono::steady_clock::now();
+  }
+  ui.close();
+  int status = 0;
+  waitpid(child, &status, 0);
+  shm_unlink((name + ".etat").c_str());
+  shm_unlink((name + ".actions").c_str());
+
+  std::sort(lat.begin(), lat.end());
+  auto pct = [&](double p)
+  { return lat.empty() ? 0.0 : lat[std::min(lat.size() - 1, (size_t)(p * (lat.size() - 1)))]; };
+  std::printf("ui: %llu poll(s), %llu vue(s) copiée(s), %llu manche(s) ; poll sans changement %.1f ns\n",
+              (unsigned long long)polls, (unsigned long long)changes, (unsigned long long)rounds,
+              polls > changes ? idleNs / (double)(polls - changes) : 0.0);
+  std::printf("action UI -> vue publiée : p50 %.1f  p99 %.1f µs (%zu mesures)\n", pct(0.50), pct(0.99), lat.size());
+  return 0;
+}
+#endif
+
+/*
+Serveur et UI dans deux processus :
+    ./blackjack_server --shm                 (objets /echoplay.etat et /echoplay.actions)
+    ./blackjack_touch --shm                  (UI seule : ni moteur, ni hub, ni registre)
+    ./blackjack_server --shm=/salle2 ; ./blackjack_touch --shm=/salle2
+
+Banc d'essai (fork serveur + UI) :
+    g++ -std=c++17 -O2 -DBLACKJACK_SHM_BENCH blackjack_shm.cpp -o shm_bench -pthread -lrt
+    ./shm_bench [secondes]
+*/
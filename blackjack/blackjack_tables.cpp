@@ -0,0 +1,1261 @@
+// blackjack_tables.cpp
+// Gestionnaire multi-tables : héberge plusieurs BlackjackEngine sur un pool fixe de workers.
+// - Chaque table a son propre état partagé (Bridge, mutex par table) : aucune contention globale.
+// - Les tables sont réparties (table % nbWorkers) sur des shards ; un shard n'exécute qu'une
+//   table à la fois, donc le moteur d'une table n'est jamais touché par deux threads.
+// - Les manches avancent pas à pas (beginRound/applyAction/finishRound) : un siège humain en
+//   attente ne bloque pas de thread, le shard passe aux autres tables.
+// - Sans verrou sur les chemins chauds : actions UI / terminaux -> moteur par une file MPSC
+//   bornée (submit() ne fait que pousser et re-planifier la table), vue de l'UI locale poussée
+//   par le moteur dans une file SPSC. Le Bridge (mutex) ne garde que l'état froid : copies pour
+//   un client qui rejoint ou une UI en retard.
+// - Pauses de fin de manche et délais de décision : minuteries d'une roue hiérarchique
+//   partagée (TimerWheel), armées / annulées en O(1), sans aucun thread qui scrute.
+// - Flux d'événements incrémental par table (carte ajoutée, tour, croupier, résultat) numérotés
+//   par seq, avec l'état visible correspondant pour resynchroniser un client.
+// À inclure après blackjack_engine.cpp, blackjack_thread_pool.cpp et blackjack_montecarlo.cpp.
+// C++17
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef BLACKJACK_TABLES_BENCH
+#include "blackjack_engine.cpp"
+#include "blackjack_thread_pool.cpp"
+#include "blackjack_montecarlo.cpp"
+#endif
+
+// ============================= État partagé Table <-> UI / réseau =============================
+
+struct DecisionContextCopy
+{
+  std::vector<Card> handCards;
+  Card dealerUp;
+  int playerIndex = 0;
+  int roundNumber = 0;
+};
+
+static DecisionContextCopy copyCtx(const DecisionContext &ctx)
+{
+
+  DecisionContextCopy c;
+  c.playerIndex = ctx.playerIndex;
+  c.roundNumber = ctx.roundNumber;
+  c.dealerUp = ctx.dealerUpcard;
+  c.handCards = ctx.hand.cards; // copie
+  return c;
+}
+
+// Événement incrémental d'une table (flux ordonné, seq strictement croissant par table)
+struct TableEvent
+{
+  enum class Kind : uint8_t
+  {
+    Round,  // nouvelle manche : card = carte visible du croupier
+    Card,   // carte ajoutée à la main du siège seat
+    Turn,   // le siège seat doit décider
+    Dealer, // carte du croupier révélée (carte cachée puis tirages)
+    Result, // résultat du siège seat
+  };
+  Kind kind = Kind::Round;
+  uint32_t seq = 0;
+  int round = 0;
+  int seat = -1;
+  Card card{};
+  // Result uniquement
+  int playerTotal = 0;
+  int dealerTotal = 0;
+  double delta = 0.0;
+  bool blackjack = false;
+};
+
+// État visible d'une table, tel qu'obtenu en appliquant tous les événements jusqu'à seq
+// (renvoyé à un client qui rejoint ou qui détecte un trou dans la séquence)
+struct TableSnapshot
+{
+  uint32_t seq = 0;
+  int round = 0;
+  int turn = -1;                       // siège qui doit décider (-1 : aucun)
+  std::vector<std::vector<Card>> hands; // par siège
+  std::vector<double> bets;            // mise par siège (double inclus)
+  std::vector<Card> dealer;            // cartes visibles du croupier
+  std::vector<TableEvent> results;     // événements Result de la manche (si terminée)
+};
+
+// État froid d'une table (copies sous mutex) : lu à la demande, jamais à chaque image ni à
+// chaque action. L'UI locale suit la table par sa file UiView, les actions passent par submit().
+struct Bridge
+{
+  std::mutex m;
+
+  // Contexte de la décision en attente (copie)
+  std::optional<DecisionContextCopy> pendingCtx;
+
+  // Dernier résultat de manche complet pour affichage
+  std::shared_ptr<const RoundResult> lastRound;
+
+  // Stats persistantes par joueur
+  struct PlayerStats
+  {
+    int win = 0, loss = 0, push = 0;
+  };
+  std::vector<PlayerStats> stats;
+
+  // Flux d'événements : état visible + dernier seq émis (si TableManager::onEvent est branché)
+  TableSnapshot view;
+
+  // Compteur de manches terminées (pour déclencher l'anim de révélation)
+  std::atomic<uint64_t> roundSerial{0};
+
+  // Pour fermeture propre
+  std::atomic<bool> quit{false};
+};
+
+// Ce que l'UI locale affiche d'une table ; une vue complète par changement (la dernière suffit)
+struct UiView
+{
+  std::optional<DecisionContextCopy> pending;
+  std::shared_ptr<const RoundResult> lastRound;
+  std::vector<Bridge::PlayerStats> stats;
+  uint64_t roundSerial = 0;
+};
+
+// Temps de travail cumulé d'un ou plusieurs threads, lisible sans verrou (page de métriques)
+struct BusyMeter
+{
+  std::atomic<uint64_t> busyNs{0};
+
+  void add(std::chrono::steady_clock::duration d)
+  {
+    busyNs.fetch_add((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(d).count(),
+                     std::memory_order_relaxed);
+  }
+  double seconds() const { return busyNs.load(std::memory_order_relaxed) / 1e9; }
+};
+
+// ============================= Files sans verrou =============================
+
+// File bornée un producteur / un consommateur ; N puissance de 2. Chaque côté garde une copie
+// de l'indice de l'autre et ne relit l'atomique partagé que si la file lui paraît pleine / vide.
+template <class T, size_t N>
+class SpscRing
+{
+  static_assert((N & (N - 1)) == 0, "N doit être une puissance de 2");
+
+public:
+  bool try_push(T &&v)
+  {
+    const size_t t = tail.load(std::memory_order_relaxed);
+    if (t - headCache == N)
+    {
+      headCache = head.load(std::memory_order_acquire);
+      if (t - headCache == N)
+        return false;
+    }
+    cells[t & (N - 1)] = std::move(v);
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool try_pop(T &out)
+  {
+    const size_t h = head.load(std::memory_order_relaxed);
+    if (h == tailCache)
+    {
+      tailCache = tail.load(std::memory_order_acquire);
+      if (h == tailCache)
+        return false;
+    }
+    out = std::move(cells[h & (N - 1)]);
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+  alignas(64) std::atomic<size_t> head{0}; // consommateur
+  size_t tailCache = 0;
+  alignas(64) std::atomic<size_t> tail{0}; // producteur
+  size_t headCache = 0;
+  std::array<T, N> cells{};
+};
+
+// File bornée plusieurs producteurs / un consommateur (numéro de séquence par case) ; N
+// puissance de 2. Producteurs : UI, strands des terminaux, réception UDP, roue de temporisation.
+template <class T, size_t N>
+class MpscRing
+{
+  static_assert((N & (N - 1)) == 0, "N doit être une puissance de 2");
+
+public:
+  MpscRing()
+  {
+    for (size_t i = 0; i < N; ++i)
+      cells[i].seq.store(i, std::memory_order_relaxed);
+  }
+
+  bool try_push(const T &v)
+  {
+    size_t pos = tail.load(std::memory_order_relaxed);
+    for (;;)
+    {
+      Cell &c = cells[pos & (N - 1)];
+      const size_t seq = c.seq.load(std::memory_order_acquire);
+      const intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+      if (dif == 0)
+      {
+        if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        {
+          c.v = v;
+          c.seq.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (dif < 0)
+      {
+        return false; // pleine
+      }
+      else
+      {
+        pos = tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Consommateur unique
+  bool try_pop(T &out)
+  {
+    Cell &c = cells[head & (N - 1)];
+    if (c.seq.load(std::memory_order_acquire) != head + 1)
+      return false;
+    out = c.v;
+    c.seq.store(head + N, std::memory_order_release);
+    ++head;
+    return true;
+  }
+
+private:
+  struct Cell
+  {
+    std::atomic<size_t> seq{0};
+    T v{};
+  };
+  alignas(64) std::atomic<size_t> tail{0};
+  alignas(64) size_t head = 0;
+  std::array<Cell, N> cells;
+};
+
+// ============================= Roue de temporisation =============================
+
+// Roue hiérarchique (4 niveaux x 64 cases, pas de 1 ms, ~4,6 h de portée directe ; au-delà la
+// minuterie est recasée à chaque passage). Partagée par toutes les tables et le hub : pauses de
+// fin de manche, délais de décision, délais de reprise de session.
+// - arm() / cancel() en O(1) : listes intrusives doublement chaînées + un bitmap par niveau.
+// - Un seul thread, qui dort jusqu'à la prochaine case occupée (ou la prochaine cascade utile) :
+//   aucun réveil à vide, aucune boucle de scrutation.
+// - Les rappels s'exécutent sur ce thread, hors verrou de la roue ; ils doivent rester courts
+//   (re-planifier une table, libérer un siège). Au retour de cancel(), le rappel ne partira plus
+//   et n'est plus en cours : ne pas appeler cancel() en tenant un verrou que le rappel prend.
+class TimerWheel
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // Minuterie intrusive : appartient à l'appelant, annulée avant sa destruction.
+  struct Timer
+  {
+    std::function<void()> fn; // fixé une fois, avant le premier arm()
+
+  private:
+    friend class TimerWheel;
+    bool armed() const { return level >= 0; }
+    Timer *prev = nullptr, *next = nullptr;
+    uint64_t when = 0; // case d'échéance (ms depuis epoch)
+    int8_t level = -1; // niveau de la roue ; -1 : inactive, kFiring : échue, rappel à venir
+    uint8_t slot = 0;
+  };
+
+  TimerWheel() : epoch(Clock::now()) {}
+  ~TimerWheel() { stop(); }
+
+  void start()
+  {
+    std::lock_guard<std::mutex> lk(m);
+    if (th.joinable())
+      return;
+    quit = false;
+    th = std::thread([this]
+                     { loop(); });
+  }
+
+  void stop()
+  {
+    {
+      std::lock_guard<std::mutex> lk(m);
+      quit = true;
+    }
+    cv.notify_all();
+    if (th.joinable())
+      th.join();
+  }
+
+  // (Ré)arme t pour l'instant at ; jamais déclenchée avant at.
+  void arm(Timer &t, Clock::time_point at)
+  {
+    const auto d = std::chrono::duration_cast<std::chrono::microseconds>(at - epoch).count();
+    const uint64_t when = d <= 0 ? 0 : (uint64_t)(d + 999) / 1000; // arrondi supérieur
+    bool wake;
+    {
+      std::lock_guard<std::mutex> lk(m);
+      if (t.armed())
+        unlink(t);
+      t.when = when;
+      insert(t);
+      ++armedCount;
+      wake = when < sleepUntil; // le thread dort au-delà : le réveiller pour recalculer
+    }
+    if (wake)
+      cv.notify_one();
+  }
+
+  void cancel(Timer &t)
+  {
+    std::unique_lock<std::mutex> lk(m);
+    if (t.armed())
+      unlink(t);
+    else if (t.level == kFiring)
+      t.level = -1; // échue mais pas encore rappelée : le rappel est sauté
+    if (std::this_thread::get_id() != th.get_id())
+      idle.wait(lk, [&]
+                { return current != &t; });
+  }
+
+  uint64_t armedTotal() const
+  {
+    std::lock_guard<std::mutex> lk(m);
+    return armedCount;
+  }
+  uint64_t firedTotal() const
+  {
+    std::lock_guard<std::mutex> lk(m);
+    return firedCount;
+  }
+
+private:
+  static constexpr int kLevels = 4;
+  static constexpr int kBits = 6; // 64 cases par niveau
+  static constexpr uint64_t kSlots = uint64_t{1} << kBits;
+  static constexpr uint64_t kMask = kSlots - 1;
+  static constexpr uint64_t kNever = ~uint64_t{0};
+  static constexpr int8_t kFiring = -2;
+
+  static int ctz64(uint64_t v)
+  {
+#if defined(__GNUC__)
+    return __builtin_ctzll(v);
+#else
+    int n = 0;
+    while (!(v & 1))
+    {
+      v >>= 1;
+      ++n;
+    }
+    return n;
+#endif
+  }
+  static uint64_t rotr64(uint64_t v, unsigned s) { return s ? (v >> s) | (v << (64 - s)) : v; }
+
+  uint64_t nowTick() const
+  {
+    const auto d = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - epoch).count();
+    return d <= 0 ? 0 : (uint64_t)d;
+  }
+
+  // Niveau choisi selon la distance à cur ; une échéance passée tombe dans la case courante.
+  void insert(Timer &t)
+  {
+    const uint64_t delta = t.when > cur ? t.when - cur : 0;
+    const uint64_t at = delta == 0 ? cur : t.when;
+    int lvl = 0;
+    while (lvl < kLevels - 1 && delta >= (uint64_t{1} << (kBits * (lvl + 1))))
+      ++lvl;
+    uint64_t key = at;
+    if (lvl == kLevels - 1)
+      key = std::min(at, cur + (uint64_t{1} << (kBits * kLevels)) - 1); // hors portée : recasée plus tard
+    const uint8_t s = (uint8_t)((key >> (kBits * lvl)) & kMask);
+    t.level = (int8_t)lvl;
+    t.slot = s;
+    t.prev = nullptr;
+    t.next = heads[lvl][s];
+    if (t.next)
+      t.next->prev = &t;
+    heads[lvl][s] = &t;
+    bits[lvl] |= uint64_t{1} << s;
+  }
+
+  void unlink(Timer &t)
+  {
+    if (t.prev)
+      t.prev->next = t.next;
+    else
+      heads[t.level][t.slot] = t.next;
+    if (t.next)
+      t.next->prev = t.prev;
+    if (!heads[t.level][t.slot])
+      bits[t.level] &= ~(uint64_t{1} << t.slot);
+    t.prev = t.next = nullptr;
+    t.level = -1;
+  }
+
+  // Vide une case et rend sa liste (minuteries désarmées)
+  Timer *take(int lvl, unsigned s)
+  {
+    Timer *list = heads[lvl][s];
+    heads[lvl][s] = nullptr;
+    bits[lvl] &= ~(uint64_t{1} << s);
+    for (Timer *t = list; t; t = t->next)
+      t->level = -1;
+    return list;
+  }
+
+  // Arrivée sur une frontière de case de niveau 1+ : redescend les minuteries concernées
+  void cascade()
+  {
+    for (int lvl = kLevels - 1; lvl >= 1; --lvl)
+    {
+      if (cur & ((uint64_t{1} << (kBits * lvl)) - 1))
+        continue;
+      for (Timer *t = take(lvl, (unsigned)((cur >> (kBits * lvl)) & kMask)); t;)
+      {
+        Timer *n = t->next;
+        insert(*t);
+        t = n;
+      }
+    }
+  }
+
+  void moveTo(uint64_t t)
+  {
+    cur = t;
+    if ((cur & kMask) == 0)
+      cascade();
+  }
+
+  // Avance cur jusqu'à target inclus en sautant les cases vides ; échues -> firing
+  void advanceTo(uint64_t target)
+  {
+    while (cur <= target)
+    {
+      const unsigned idx = (unsigned)(cur & kMask);
+      const uint64_t ahead = bits[0] >> idx;
+      if (ahead & 1)
+      {
+        for (Timer *t = take(0, idx); t;)
+        {
+          Timer *n = t->next;
+          t->prev = t->next = nullptr;
+          if (t->when > cur)
+          {
+            insert(*t); // recasée (au-delà de la portée de la roue)
+          }
+          else
+          {
+            t->level = kFiring;
+            firing.push_back(t);
+          }
+          t = n;
+        }
+        moveTo(cur + 1);
+        continue;
+      }
+      const uint64_t next = ahead ? cur + (uint64_t)ctz64(ahead) : (cur | kMask) + 1;
+      moveTo(std::min(next, target + 1));
+    }
+  }
+
+  // Prochaine case à traiter : échéance de niveau 0 ou frontière de cascade non vide
+  uint64_t nextTick() const
+  {
+    uint64_t best = kNever;
+    if (bits[0])
+      best = cur + (uint64_t)ctz64(rotr64(bits[0], (unsigned)(cur & kMask)));
+    for (int lvl = 1; lvl < kLevels; ++lvl)
+    {
+      if (!bits[lvl])
+        continue;
+      const unsigned sh = kBits * lvl;
+      const unsigned idx = (unsigned)((cur >> sh) & kMask);
+      const uint64_t k = (uint64_t)ctz64(rotr64(bits[lvl], (idx + 1) & kMask)) + 1; // 1..64
+      best = std::min(best, ((cur >> sh) << sh) + (k << sh));
+    }
+    return best;
+  }
+
+  void loop()
+  {
+    std::unique_lock<std::mutex> lk(m);
+    while (!quit)
+    {
+      advanceTo(nowTick());
+      if (!firing.empty())
+      {
+        batch.swap(firing);
+        for (Timer *t : batch)
+        {
+          if (t->level != kFiring)
+            continue; // annulée ou réarmée depuis l'échéance
+          t->level = -1;
+          ++firedCount;
+          current = t;
+          lk.unlock();
+          t->fn();
+          lk.lock();
+          current = nullptr;
+          idle.notify_all();
+        }
+        batch.clear();
+        continue;
+      }
+      const uint64_t next = nextTick();
+      sleepUntil = next;
+      if (next == kNever)
+        cv.wait(lk);
+      else
+        cv.wait_until(lk, epoch + std::chrono::milliseconds(next));
+      sleepUntil = 0;
+    }
+  }
+
+  const Clock::time_point epoch;
+  mutable std::mutex m;
+  std::condition_variable cv;
+  std::condition_variable idle; // fin d'un rappel (cancel() concurrent)
+  std::thread th;
+  bool quit = false;
+  uint64_t cur = 0;        // prochaine case à traiter
+  uint64_t sleepUntil = 0; // case visée par le thread endormi (0 : éveillé)
+  Timer *heads[kLevels][kSlots] = {};
+  uint64_t bits[kLevels] = {};
+  std::vector<Timer *> firing, batch; // échues ; lot en cours de rappel
+  Timer *current = nullptr;           // rappel en cours d'exécution
+  uint64_t armedCount = 0, firedCount = 0;
+};
+
+// ============================= Table =============================
+
+// Action en file vers le moteur, liée au numéro de la décision qu'elle vise (écartée sinon)
+struct QueuedAction
+{
+  uint32_t serial = 0;
+  int8_t seat = -1; // -1 : siège en attente quel qu'il soit (UI locale)
+  PlayerAction action = PlayerAction::Stand;
+  bool timeout = false; // "rester" d'office (délai de décision écoulé)
+};
+
+struct TableCfg
+{
+  GameConfig cfg;
+  int numHuman = 1;          // sièges 0..numHuman-1 pilotés par l'UI / les terminaux
+  int numAI = 0;             // sièges IA suivants
+  uint64_t seed = 42;        // graine de la table 0 (table t : seed + t)
+  int pauseMs = 5000;        // pause d'affichage du résultat entre deux manches
+  int decisionMs = 0;        // délai de décision d'un siège humain (0 : illimité), puis "rester"
+  bool aiMonteCarlo = false; // IA Monte Carlo au lieu de basicStrategy
+  MonteCarloCfg mc;
+};
+
+struct Table
+{
+  enum class Phase
+  {
+    Pause,   // entre deux manches (jusqu'à resumeAt)
+    Playing, // manche en cours, éventuellement en attente d'un siège humain
+  };
+
+  Table(int tableId, const TableCfg &tc, const std::shared_ptr<ThreadPool> &aiPool)
+      : id(tableId), numHuman(std::max(0, std::min(4, tc.numHuman))), pauseMs(tc.pauseMs),
+        decisionMs(std::max(0, tc.decisionMs)),
+        engine(tc.cfg, tc.seed + (uint64_t)tableId)
+  {
+    for (int i = 0; i < numHuman; ++i)
+      engine.addPlayer(i == 0 ? std::string("Vous") : std::string("Joueur ") + std::to_string(i + 1), nullptr, 500.0, 10.0);
+    for (int i = 0; i < tc.numAI && (numHuman + i) < 4; ++i)
+    {
+      DecisionFn ai = basicStrategy;
+      if (aiPool)
+        ai = makeMonteCarloStrategy(aiPool, tc.mc, tc.seed + (uint64_t)tableId * 16 + i + 1);
+      engine.addPlayer(std::string("IA ") + std::to_string(i + 1), ai, 500.0, 10.0);
+    }
+    bridge.stats.assign(engine.players().size(), {});
+  }
+
+  const int id;
+  const int numHuman;
+  const int pauseMs;
+  const int decisionMs;
+
+  // Accès par le shard propriétaire uniquement
+  BlackjackEngine engine;
+  Phase phase = Phase::Pause;
+  std::chrono::steady_clock::time_point resumeAt{};
+
+  uint32_t decisionSerial = 0; // numéro de la dernière décision humaine ouverte
+  bool awaiting = false;       // décision humaine publiée, action attendue
+
+  // État froid partagé avec l'UI / le réseau, protégé par bridge.m (un mutex par table)
+  Bridge bridge;
+
+  // Décision en attente, publiée sans verrou pour submit() :
+  // numéro << 16 | nb de cartes << 8 | siège + 1 (0 : aucune)
+  std::atomic<uint64_t> decision{0};
+  MpscRing<QueuedAction, 64> actions; // UI / terminaux / roue -> moteur
+  std::atomic<bool> uiAttached{false};
+  SpscRing<UiView, 16> ui;            // moteur -> UI locale (si attachée)
+  std::atomic<bool> uiStale{false};   // file UI pleine : l'UI relit l'état froid
+  std::function<void()> uiWake;       // UI endormie en attente d'événements : la réveiller
+
+  TimerWheel::Timer pauseTimer;          // fin de pause -> re-planifie la table
+  TimerWheel::Timer decisionTimer;       // délai de décision écoulé -> "rester" d'office
+  std::atomic<uint32_t> timedSerial{0};  // décision couverte par decisionTimer
+
+  std::atomic<bool> scheduled{false}; // déjà dans la file "prête" de son shard
+  std::atomic<uint64_t> rounds{0};
+};
+
+// ============================= Gestionnaire de tables =============================
+
+class TableManager
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // Notifications (appelées depuis le shard, verrou de la table tenu : ne pas rappeler submit())
+  std::function<void(int table, const DecisionContextCopy &ctx)> onDecision;
+  std::function<void(int table, int numHuman, const RoundResult &rr)> onRoundEnd;
+  // Flux incrémental (cartes, tour, résultats) ; à brancher avant start()
+  std::function<void(int table, const TableEvent &ev)> onEvent;
+  // Vue UI de chaque table, au moment où elle serait poussée vers l'UI locale (UI d'un autre
+  // processus, blackjack_shm.cpp) ; à brancher avant start()
+  std::function<void(int table, const UiView &view)> onUiView;
+
+  TableManager(int numTables, const TableCfg &tc, unsigned numWorkers = 0)
+  {
+    if (numWorkers == 0)
+      numWorkers = std::max(1u, std::thread::hardware_concurrency());
+    numWorkers = std::max(1u, std::min<unsigned>(numWorkers, (unsigned)std::max(1, numTables)));
+    if (tc.aiMonteCarlo && tc.numAI > 0)
+      aiPool = std::make_shared<ThreadPool>();
+    for (int t = 0; t < std::max(1, numTables); ++t)
+    {
+      tables.push_back(std::make_unique<Table>(t, tc, aiPool));
+      Table *tb = tables.back().get();
+      tb->pauseTimer.fn = [this, tb]
+      { schedule(*tb); };
+      tb->decisionTimer.fn = [this, tb]
+      { decisionExpired(*tb); };
+    }
+    for (unsigned w = 0; w < numWorkers; ++w)
+      shards.push_back(std::make_unique<Shard>());
+  }
+
+  ~TableManager() { stop(); }
+
+  void start()
+  {
+    if (running.exchange(true))
+      return;
+    wheel.start();
+    for (auto &t : tables)
+      schedule(*t);
+    for (auto &sh : shards)
+    {
+      Shard *s = sh.get();
+      s->th = std::thread([this, s]
+                          { shardLoop(*s); });
+    }
+  }
+
+  void stop()
+  {
+    if (!running.exchange(false))
+      return;
+    for (auto &t : tables)
+      t->bridge.quit = true;
+    for (auto &sh : shards)
+    {
+      {
+        std::lock_guard<std::mutex> lk(sh->m);
+        sh->stop = true;
+      }
+      sh->cv.notify_all();
+    }
+    for (auto &sh : shards)
+      if (sh->th.joinable())
+        sh->th.join();
+    wheel.stop();
+  }
+
+  int numTables() const { return (int)tables.size(); }
+  unsigned numWorkers() const { return (unsigned)shards.size(); }
+  Table &table(int t) { return *tables[t]; }
+  int humanSeats(int t) const { return (t >= 0 && t < (int)tables.size()) ? tables[t]->numHuman : 0; }
+  uint64_t roundsPlayed() const { return totalRounds.load(std::memory_order_relaxed); }
+  uint64_t shuffles() const { return totalShuffles.load(std::memory_order_relaxed); }
+  // Décisions jouées d'office ("rester") faute de réponse dans TableCfg::decisionMs
+  uint64_t autoStands() const { return totalAutoStands.load(std::memory_order_relaxed); }
+  // Actions humaines soumises : appliquées par le moteur, écartées par lui (décision déjà jouée,
+  // numéro périmé) ou refusées dès submit() (aucune décision de ce siège, file pleine)
+  uint64_t appliedActions() const { return totalApplied.load(std::memory_order_relaxed); }
+  uint64_t discardedActions() const { return totalDiscarded.load(std::memory_order_relaxed); }
+  uint64_t refusedActions() const { return totalRefused.load(std::memory_order_relaxed); }
+  // Roue partagée : aussi utilisée par le hub (délais de reprise de session)
+  TimerWheel &timers() { return wheel; }
+  // Temps passé par les workers à faire avancer les tables (hors attente)
+  const BusyMeter &workerBusy() const { return busy; }
+
+  // Action d'un joueur. seat = -1 : siège en attente quel qu'il soit (UI locale de la table).
+  // Retourne false si ce siège n'a pas de décision en cours (ou action non permise). Sans
+  // verrou : l'action rejoint la file de la table, le shard la prend au prochain passage.
+  // Plusieurs actions pour la même décision : la première l'emporte.
+  bool submit(int t, int seat, PlayerAction a)
+  {
+    if (t < 0 || t >= (int)tables.size())
+      return false;
+    Table &tb = *tables[t];
+    const uint64_t d = tb.decision.load(std::memory_order_acquire);
+    const int pendingSeat = (int)(d & 0xFF) - 1;
+    if (pendingSeat < 0 || (seat >= 0 && pendingSeat != seat) ||
+        (a == PlayerAction::DoubleDown && ((d >> 8) & 0xFF) != 2) || // ignore si non autorisé
+        !tb.actions.try_push({(uint32_t)(d >> 16), (int8_t)seat, a, false})) // rafale au-delà de la file
+    {
+      totalRefused.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    schedule(tb);
+    return true;
+  }
+
+  // UI locale d'une table (un seul consommateur) : active la file UiView et renvoie l'état
+  // courant. Ensuite pollUi() à chaque image, sans verrou. wake (optionnel, avant start()) est
+  // appelé par le moteur après chaque vue poussée, verrou de la table tenu : il doit être bref.
+  UiView attachUi(int t, std::function<void()> wake = {})
+  {
+    Table &tb = *tables[t];
+    tb.uiWake = std::move(wake);
+    tb.uiAttached = true;
+    return uiSnapshot(tb);
+  }
+
+  // Vue courante d'une table, copiée sous son verrou (publication initiale, hors rendu)
+  UiView uiState(int t) { return uiSnapshot(*tables[t]); }
+
+  // Dernière vue poussée par le moteur (ou relue si la file a débordé). true si view a changé.
+  bool pollUi(int t, UiView &view)
+  {
+    Table &tb = *tables[t];
+    bool changed = false;
+    while (tb.ui.try_pop(view))
+      changed = true;
+    if (tb.uiStale.exchange(false))
+    {
+      view = uiSnapshot(tb);
+      changed = true;
+    }
+    return changed;
+  }
+
+  // Copie du contexte en attente d'une table (pour renvoyer la main à un client qui rejoint)
+  std::optional<DecisionContextCopy> pending(int t)
+  {
+    if (t < 0 || t >= (int)tables.size())
+      return std::nullopt;
+    std::lock_guard<std::mutex> lk(tables[t]->bridge.m);
+    return tables[t]->bridge.pendingCtx;
+  }
+
+  // Solde et bilan d'un siège repris d'un registre (blackjack_ledger.cpp). Avant start() :
+  // le moteur n'appartient alors à aucun shard.
+  void restoreSeat(int t, int seat, double stack, int win, int loss, int push)
+  {
+    if (running.load() || t < 0 || t >= (int)tables.size())
+      return;
+    Table &tb = *tables[t];
+    if (seat < 0 || seat >= (int)tb.engine.players().size())
+      return;
+    tb.engine.setPlayerStack((size_t)seat, stack);
+    std::lock_guard<std::mutex> lk(tb.bridge.m);
+    tb.bridge.stats[seat] = {win, loss, push};
+  }
+
+  // Copie de l'état visible d'une table et de son seq (resynchronisation d'un client)
+  TableSnapshot snapshot(int t)
+  {
+    if (t < 0 || t >= (int)tables.size())
+      return {};
+    std::lock_guard<std::mutex> lk(tables[t]->bridge.m);
+    return tables[t]->bridge.view;
+  }
+
+private:
+  struct Shard
+  {
+    std::mutex m;
+    std::condition_variable cv;
+    std::deque<Table *> ready;
+    bool stop = false;
+    std::thread th;
+  };
+
+  Shard &shardOf(const Table &tb) { return *shards[(size_t)tb.id % shards.size()]; }
+
+  void schedule(Table &tb)
+  {
+    if (tb.scheduled.exchange(true))
+      return;
+    Shard &sh = shardOf(tb);
+    {
+      std::lock_guard<std::mutex> lk(sh.m);
+      sh.ready.push_back(&tb);
+    }
+    sh.cv.notify_one();
+  }
+
+  void shardLoop(Shard &sh)
+  {
+    std::unique_lock<std::mutex> lk(sh.m);
+    while (!sh.stop)
+    {
+      if (sh.ready.empty())
+      {
+        sh.cv.wait(lk); // pauses et délais : la roue re-planifie la table via schedule()
+        continue;
+      }
+      Table *tb = sh.ready.front();
+      sh.ready.pop_front();
+      tb->scheduled = false;
+      lk.unlock();
+      const auto t0 = Clock::now();
+      bool paused = advance(*tb);
+      busy.add(Clock::now() - t0);
+      lk.lock();
+      if (paused)
+      {
+        if (tb->resumeAt <= Clock::now())
+        {
+          if (!tb->scheduled.exchange(true))
+            sh.ready.push_back(tb); // pause nulle : retour en fin de file (round-robin)
+        }
+        else
+        {
+          wheel.arm(tb->pauseTimer, tb->resumeAt);
+        }
+      }
+    }
+  }
+
+  // Rappel de la roue : "rester" pour la décision couverte ; écarté par le moteur si elle a
+  // déjà été jouée entre l'expiration et ce rappel.
+  void decisionExpired(Table &tb)
+  {
+    if (tb.actions.try_push({tb.timedSerial.load(std::memory_order_relaxed), -1, PlayerAction::Stand, true}))
+      schedule(tb);
+  }
+
+  static UiView uiSnapshot(Table &tb)
+  {
+    std::lock_guard<std::mutex> lk(tb.bridge.m);
+    return UiView{tb.bridge.pendingCtx, tb.bridge.lastRound, tb.bridge.stats, tb.bridge.roundSerial.load()};
+  }
+
+  // Pousse la vue courante vers l'UI locale et onUiView (verrou de la table tenu) ; file
+  // pleine : l'UI relira
+  void pushUi(Table &tb)
+  {
+    const bool local = tb.uiAttached.load(std::memory_order_relaxed);
+    if (!local && !onUiView)
+      return;
+    UiView v{tb.bridge.pendingCtx, tb.bridge.lastRound, tb.bridge.stats, tb.bridge.roundSerial.load()};
+    if (onUiView)
+      onUiView(tb.id, v);
+    if (!local)
+      return;
+    if (!tb.ui.try_push(std::move(v)))
+      tb.uiStale = true;
+    if (tb.uiWake)
+      tb.uiWake();
+  }
+
+  // Décision humaine : publiée pour submit(), puis état froid, événement "tour" et UI
+  void openDecision(Table &tb, const DecisionContext &ctx)
+  {
+    const uint32_t serial = ++tb.decisionSerial;
+    tb.awaiting = true;
+    if (tb.decisionMs > 0)
+    {
+      tb.timedSerial.store(serial, std::memory_order_relaxed);
+      wheel.arm(tb.decisionTimer, Clock::now() + std::chrono::milliseconds(tb.decisionMs));
+    }
+    tb.decision.store((uint64_t)serial << 16 | (uint64_t)std::min<size_t>(ctx.hand.cards.size(), 0xFF) << 8 |
+                          (uint64_t)(ctx.playerIndex + 1),
+                      std::memory_order_release);
+    std::lock_guard<std::mutex> lk(tb.bridge.m);
+    tb.bridge.pendingCtx = copyCtx(ctx);
+    if (onEvent)
+    {
+      TableEvent ev;
+      ev.kind = TableEvent::Kind::Turn;
+      ev.seat = ctx.playerIndex;
+      emit(tb, ev);
+    }
+    if (onDecision)
+      onDecision(tb.id, *tb.bridge.pendingCtx);
+    pushUi(tb);
+  }
+
+  void closeDecision(Table &tb, bool timedOut)
+  {
+    tb.awaiting = false;
+    tb.decision.store(0, std::memory_order_release);
+    if (tb.decisionMs > 0)
+      wheel.cancel(tb.decisionTimer);
+    if (timedOut)
+      totalAutoStands.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lk(tb.bridge.m);
+    tb.bridge.pendingCtx.reset();
+    pushUi(tb);
+  }
+
+  // ---- Flux d'événements (verrou de la table tenu par l'appelant) ----
+
+  void emit(Table &tb, TableEvent ev)
+  {
+    TableSnapshot &v = tb.bridge.view;
+    ev.seq = ++v.seq;
+    ev.round = v.round;
+    switch (ev.kind)
+    {
+    case TableEvent::Kind::Round:
+      break;
+    case TableEvent::Kind::Card:
+      v.hands[ev.seat].push_back(ev.card);
+      break;
+    case TableEvent::Kind::Turn:
+      v.turn = ev.seat;
+      break;
+    case TableEvent::Kind::Dealer:
+      v.turn = -1;
+      v.dealer.push_back(ev.card);
+      break;
+    case TableEvent::Kind::Result:
+      v.turn = -1;
+      v.results.push_back(ev);
+      break;
+    }
+    onEvent(tb.id, ev);
+  }
+
+  // Émet les cartes du siège pas encore publiées
+  void publishCards(Table &tb, int seat)
+  {
+    const auto &cards = tb.engine.roundHand((size_t)seat).cards;
+    for (size_t i = tb.bridge.view.hands[seat].size(); i < cards.size(); ++i)
+    {
+      TableEvent ev;
+      ev.kind = TableEvent::Kind::Card;
+      ev.seat = seat;
+      ev.card = cards[i];
+      emit(tb, ev);
+    }
+  }
+
+  void publishRoundStart(Table &tb)
+  {
+    if (!onEvent)
+      return;
+    std::lock_guard<std::mutex> lk(tb.bridge.m);
+    TableSnapshot &v = tb.bridge.view;
+    v.round = tb.engine.roundNumber();
+    v.turn = -1;
+    v.hands.assign(tb.engine.players().size(), {});
+    v.bets.resize(v.hands.size());
+    for (size_t p = 0; p < v.bets.size(); ++p)
+      v.bets[p] = tb.engine.roundBet(p);
+    v.dealer.assign(1, tb.engine.roundDealer().cards.front());
+    v.results.clear();
+    TableEvent ev;
+    ev.kind = TableEvent::Kind::Round;
+    ev.card = v.dealer.front();
+    emit(tb, ev);
+    for (int p = 0; p < (int)v.hands.size(); ++p)
+      publishCards(tb, p);
+  }
+
+  void publishAction(Table &tb, int seat)
+  {
+    if (!onEvent)
+      return;
+    std::lock_guard<std::mutex> lk(tb.bridge.m);
+    tb.bridge.view.bets[seat] = tb.engine.roundBet((size_t)seat);
+    publishCards(tb, seat);
+  }
+
+  void publishRoundEnd(Table &tb, const RoundResult &rr)
+  {
+    if (!onEvent)
+      return;
+    // Cartes des joueurs déjà publiées après chaque action : reste le croupier
+    const auto &dc = rr.dealer.cards;
+    for (size_t i = tb.bridge.view.dealer.size(); i < dc.size(); ++i)
+    {
+      TableEvent ev;
+      ev.kind = TableEvent::Kind::Dealer;
+      ev.card = dc[i];
+      emit(tb, ev);
+    }
+    for (int p = 0; p < (int)rr.players.size(); ++p)
+    {
+      const auto &pr = rr.players[p];
+      if (pr.hand.cards.empty())
+        continue; // siège inactif
+      TableEvent ev;
+      ev.kind = TableEvent::Kind::Result;
+      ev.seat = p;
+      ev.playerTotal = pr.hand.total();
+      ev.dealerTotal = rr.dealer.total();
+      ev.delta = pr.outcome.deltaChips;
+      ev.blackjack = pr.outcome.blackjack;
+      emit(tb, ev);
+    }
+  }
+
+  // Fait progresser une table autant que possible. Retourne true si elle entre en pause.
+  bool advance(Table &tb)
+  {
+    if (tb.phase == Table::Phase::Pause)
+    {
+      if (Clock::now() < tb.resumeAt)
+        return false; // réveil anticipé : la minuterie de pause est toujours armée
+      tb.engine.beginRound();
+      tb.phase = Table::Phase::Playing;
+      publishRoundStart(tb);
+    }
+
+    while (auto ctx = tb.engine.pendingDecision())
+    {
+      const int seat = ctx->playerIndex;
+      if (seat < tb.numHuman)
+      {
+        if (!tb.awaiting)
+          openDecision(tb, *ctx);
+        // Actions en file : la première qui vise cette décision (et qu'elle permet) ; les
+        // autres (décision déjà jouée, double appui) sont écartées
+        std::optional<PlayerAction> act;
+        bool timedOut = false;
+        QueuedAction qa;
+        while (tb.actions.try_pop(qa))
+        {
+          if (act || qa.serial != tb.decisionSerial || (qa.seat >= 0 && qa.seat != seat) ||
+              (qa.action == PlayerAction::DoubleDown && ctx->hand.cards.size() != 2))
+          {
+            if (!qa.timeout)
+              totalDiscarded.fetch_add(1, std::memory_order_relaxed);
+            continue;
+          }
+          act = qa.action;
+          timedOut = qa.timeout;
+          if (!timedOut)
+            totalApplied.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (!act && tb.bridge.quit.load())
+          act = PlayerAction::Stand; // si on quitte, Stand par défaut
+        if (!act)
+          return false; // attente du joueur : submit() re-planifiera la table
+        closeDecision(tb, timedOut);
+        tb.engine.applyAction(*act);
+      }
+      else
+      {
+        const auto &pl = tb.engine.players()[seat];
+        tb.engine.applyAction(pl.decide ? pl.decide(*ctx) : PlayerAction::Stand);
+      }
+      publishAction(tb, seat);
+    }
+
+    RoundResult rr = tb.engine.finishRound();
+    const bool shuffled = rr.shuffledThisRound;
+    {
+      std::lock_guard<std::mutex> lk(tb.bridge.m);
+      if (tb.bridge.stats.size() != rr.players.size())
+        tb.bridge.stats.assign(rr.players.size(), {});
+      for (size_t i = 0; i < rr.players.size(); ++i)
+      {
+        double d = rr.players[i].outcome.deltaChips;
+        if (d > 0)
+          tb.bridge.stats[i].win++;
+        else if (d < 0)
+          tb.bridge.stats[i].loss++;
+        else
+          tb.bridge.stats[i].push++;
+      }
+      publishRoundEnd(tb, rr);
+      if (onRoundEnd)
+        onRoundEnd(tb.id, tb.numHuman, rr);
+      tb.bridge.lastRound = std::make_shared<const RoundResult>(std::move(rr));
+      tb.bridge.roundSerial++;
+      pushUi(tb);
+    }
+    tb.rounds.fetch_add(1, std::memory_order_relaxed);
+    totalRounds.fetch_add(1, std::memory_order_relaxed);
+    if (shuffled)
+      totalShuffles.fetch_add(1, std::memory_order_relaxed);
+
+    tb.phase = Table::Phase::Pause;
+    tb.resumeAt = Clock::now() + std::chrono::milliseconds(tb.pauseMs);
+    return true;
+  }
+
+  std::vector<std::unique_ptr<Table>> tables;
+  std::vector<std::unique_ptr<Shard>> shards;
+  std::shared_ptr<ThreadPool> aiPool;
+  std::atomic<bool> running{false};
+  std::atomic<uint64_t> totalRounds{0};
+  std::atomic<uint64_t> totalShuffles{0};
+  std::atomic<uint64_t> totalAutoStands{0};
+  std::atomic<uint64_t> totalApplied{0};
+  std::atomic<uint64_t> totalDiscarded{0};
+  std::atomic<uint64_t> totalRefused{0};
+  BusyMeter busy;
+  TimerWheel wheel;
+};
+
+// ============================= Charge synthétique =============================
+
+#ifdef BLACKJACK_TABLES_BENCH
+#include <cstdlib>
+#include <iostream>
+
+// Latence action -> moteur : submit() sur la table 0 jusqu'à l'événement qui suit l'action
+// (émis par le shard). En parallèle : 15 tables à siège humain joué en continu sur 2 workers, et
+// une UI qui suit la table 0 à 60 Hz avec ~3 ms de rendu par image.
+static void benchActionLatency(int seconds)
+{
+  using Clock = std::chrono::steady_clock;
+  TableCfg tc;
+  tc.numHuman = 1;
+  tc.numAI = 2;
+  tc.pauseMs = 0;
+  TableManager mgr(16, tc, 2);
+  std::atomic<bool> turn{false};
+  std::atomic<int64_t> eventNs{0};
+  auto nowNs = []
+  { return (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count(); };
+  mgr.onEvent = [&](int t, const TableEvent &ev)
+  {
+    if (t != 0)
+      return;
+    if (ev.kind == TableEvent::Kind::Turn && ev.seat == 0)
+      turn = true;
+    else
+      eventNs = nowNs();
+  };
+  UiView view = mgr.attachUi(0);
+  mgr.start();
+
+  std::atomic<bool> stop{false};
+  std::thread load([&]
+                   {
+                     while (!stop)
+                     {
+                       for (int t = 1; t < 16; ++t)
+                         mgr.submit(t, 0, PlayerAction::Stand);
+                       std::this_thread::sleep_for(std::chrono::microseconds(200));
+                     } });
+  std::thread ui([&]
+                 {
+                   while (!stop)
+                   {
+                     mgr.pollUi(0, view);
+                     const auto f0 = Clock::now();
+                     while (Clock::now() - f0 < std::chrono::milliseconds(3))
+                     {
+                     }
+                     std::this_thread::sleep_for(std::chrono::milliseconds(13));
+                   } });
+
+  std::vector<double> us;
+  uint64_t rng = 0x9E3779B97F4A7C15ull;
+  const auto end = Clock::now() + std::chrono::seconds(seconds);
+  while (Clock::now() < end)
+  {
+    while (!turn.load())
+      std::this_thread::yield();
+    turn = false;
+    rng = rng * 6364136223846793005ull + 1442695040888963407ull;
+    std::this_thread::sleep_for(std::chrono::microseconds(300 + (rng >> 33) % 5000)); // "réaction"
+    eventNs = 0;
+    const int64_t t0 = nowNs();
+    mgr.submit(0, 0, PlayerAction::Stand);
+    while (eventNs.load() == 0)
+      std::this_thread::yield();
+    us.push_back((eventNs.load() - t0) / 1000.0);
+  }
+  stop = true;
+  load.join();
+  ui.join();
+  mgr.stop();
+  std::sort(us.begin(), us.end());
+  auto q = [&](double p)
+  { return us.empty() ? 0.0 : us[(size_t)(p * (us.size() - 1))]; };
+  std::cout << "latence submit -> moteur (µs) : n=" << us.size() << " p50=" << q(0.5) << " p95=" << q(0.95)
+            << " p99=" << q(0.99) << " max=" << (us.empty() ? 0.0 : us.back()) << "\n";
+}
+
+// Tables 100% IA (4 sièges basicStrategy), sans pause : mesure le débit brut du gestionnaire.
+int main(int argc, char **argv)
+{
+  int seconds = argc > 1 ? std::max(1, std::atoi(argv[1])) : 3;
+  unsigned workers = argc > 2 ? (unsigned)std::max(0, std::atoi(argv[2])) : 0;
+
+  TableCfg tc;
+  tc.numHuman = 0;
+  tc.numAI = 4;
+  tc.pauseMs = 0;
+
+  std::cout << "tables  workers  rounds/s  rounds/s/table\n";
+  for (int n : {1, 8, 32, 128})
+  {
+    TableManager mgr(n, tc, workers);
+    auto t0 = std::chrono::steady_clock::now();
+    mgr.start();
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    mgr.stop();
+    double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    double rps = (double)mgr.roundsPlayed() / dt;
+    std::cout << n << "\t" << mgr.numWorkers() << "\t " << (uint64_t)rps << "\t   " << (uint64_t)(rps / n) << "\n";
+  }
+  benchActionLatency(seconds);
+  return 0;
+}
+#endif
+
+/*
+Charge synthétique (débit du gestionnaire, tables 100% IA) :
+    g++ -std=c++17 -O2 -DBLACKJACK_TABLES_BENCH blackjack_tables.cpp -o tables_bench -pthread
+    ./tables_bench [secondes] [workers]
+
+Latence submit -> moteur (même banc, 4 s, machine de développement) :
+    Bridge sous mutex, UI qui rend sous le verrou : p50 8 µs   p95 1524 µs  p99 2270 µs
+    Files sans verrou (MPSC actions, SPSC UiView) : p50 9 µs   p95 51 µs    p99 159 µs
+*/
@@ -0,0 +1,78 @@
+// blackjack_thread_pool.cpp
+// Pool de threads fixe, partagé par les composants qui ont du calcul parallèle
+// (ex: rollouts Monte Carlo des IA).
+// - Nombre de workers fixé à la construction (0 = nb de coeurs disponibles).
+// - submit() retourne un std::future ; les tâches s'exécutent en FIFO.
+// - Destruction : les tâches déjà en file sont terminées, puis les workers sont joints.
+// C++17
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned numWorkers = 0) {
+        if (numWorkers == 0) numWorkers = std::max(1u, std::thread::hardware_concurrency());
+        m_workers.reserve(numWorkers);
+        for (unsigned i = 0; i < numWorkers; ++i) {
+            m_workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lk(m_m);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        for (auto &t : m_workers) if (t.joinable()) t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(m_workers.size()); }
+
+    template <class F>
+    auto submit(F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using R = std::invoke_result_t<std::decay_t<F>>;
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        std::future<R> fut = task->get_future();
+        {
+            std::lock_guard<std::mutex> lk(m_m);
+            m_tasks.emplace_back([task] { (*task)(); });
+        }
+        m_cv.notify_one();
+        return fut;
+    }
+
+private:
+    void workerLoop() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lk(m_m);
+                m_cv.wait(lk, [this] { return m_stop || !m_tasks.empty(); });
+                if (m_tasks.empty()) return; // m_stop et plus rien à faire
+                job = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            job();
+        }
+    }
+
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_m;
+    std::condition_variable m_cv;
+    bool m_stop = false;
+};
@@ -0,0 +1,462 @@
+// blackjack_udp_loss_test.cpp
+// Essai du canal d'actions UDP du WsHub sur un lien à pertes, en local.
+// - Hub + tables en interne (canal UDP actif), un relais UDP entre les terminaux et le hub qui
+//   jette une fraction des datagrammes dans chaque sens (actions et acquittements).
+// - Terminaux simulés : WebSocket (JSON) pour le siège et le jeton, actions en UDP avec le même
+//   algorithme que l'ESP32 (src/websocket.cpp) : renvoi du même numéro toutes les rtoMs, puis
+//   repli sur le WebSocket avec ce numéro après N essais.
+// - Chaque terminal répond "pret" (rester) à chaque événement "tour" de son siège. Vérifie au
+//   niveau du moteur (compteurs du TableManager) que chaque action est appliquée exactement une
+//   fois : autant d'actions appliquées que d'envoyées, aucune écartée ni refusée (un renvoi ou un
+//   repli passé au travers du hub viserait une décision déjà jouée). Rapporte aussi doublons
+//   écartés par le hub, replis et délai d'acquittement (p50/p95/p99) pour chaque taux de perte.
+// Code de sortie 1 si une action est perdue ou appliquée deux fois.
+// C++17
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "blackjack_engine.cpp"
+#include "blackjack_thread_pool.cpp"
+#include "blackjack_montecarlo.cpp"
+#include "blackjack_tables.cpp"
+#include "blackjack_action_parser.cpp"
+#include "blackjack_ws_hub.cpp"
+
+#include <websocketpp/config/asio_no_tls_client.hpp>
+#include <websocketpp/client.hpp>
+
+using client = websocketpp::client<websocketpp::config::asio_client>;
+
+static const char *USAGE =
+    "Usage: blackjack_udp_loss_test [options]\n"
+    "  --terminals=N     terminaux simulés (1..4, 4)\n"
+    "  --actions=K       actions par terminal (50)\n"
+    "  --gap-ms=MS       réflexion entre l'appel du siège et l'action (2)\n"
+    "  --rto-ms=MS       délai avant renvoi (40, comme WEBSOCKET_UDP_RTO_MS)\n"
+    "  --tries=N         envois UDP avant repli WebSocket (4, comme WEBSOCKET_UDP_ESSAIS)\n"
+    "  --loss=P[,P...]   taux de perte par sens, en % (0,10,30,50)\n"
+    "  --port=P          premier port utilisé (18900)\n";
+
+static int udp_socket(unsigned short bindPort)
+{
+  const int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+  sockaddr_in a{};
+  a.sin_family = AF_INET;
+  a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  a.sin_port = htons(bindPort);
+  if (fd < 0 || ::bind(fd, reinterpret_cast<sockaddr *>(&a), sizeof(a)) != 0)
+  {
+    std::perror("udp bind");
+    std::exit(1);
+  }
+  return fd;
+}
+
+static sockaddr_in loopback(unsigned short port)
+{
+  sockaddr_in a{};
+  a.sin_family = AF_INET;
+  a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  a.sin_port = htons(port);
+  return a;
+}
+
+// ============================= Relais à pertes =============================
+
+// Un port côté terminaux ; par terminal, un socket côté hub (les réponses du hub reviennent
+// ainsi au bon terminal). Chaque datagramme, dans chaque sens, est jeté avec la probabilité loss.
+class LossyShim
+{
+public:
+  LossyShim(unsigned short front, unsigned short upstream, double lossRate, uint32_t seed)
+      : frontFd(udp_socket(front)), hub(loopback(upstream)), loss(lossRate), rng(seed)
+  {
+    th = std::thread([this]
+                     { run(); });
+  }
+
+  ~LossyShim()
+  {
+    stopping = true;
+    th.join();
+    ::close(frontFd);
+    for (auto &kv : backs)
+      ::close(kv.second.fd);
+  }
+
+  uint64_t dropped() const { return numDropped.load(); }
+
+private:
+  struct Back
+  {
+    int fd;
+    sockaddr_in terminal;
+  };
+
+  bool drop()
+  {
+    if (std::uniform_real_distribution<double>(0, 1)(rng) >= loss)
+      return false;
+    numDropped++;
+    return true;
+  }
+
+  void run()
+  {
+    uint8_t buf[256];
+    std::vector<pollfd> fds;
+    while (!stopping)
+    {
+      fds.assign(1, pollfd{frontFd, POLLIN, 0});
+      for (auto &kv : backs)
+        fds.push_back(pollfd{kv.second.fd, POLLIN, 0});
+      if (::poll(fds.data(), fds.size(), 20) <= 0)
+        continue;
+      if (fds[0].revents & POLLIN)
+      {
+        sockaddr_in from{};
+        socklen_t len = sizeof(from);
+        const ssize_t n = ::recvfrom(frontFd, buf, sizeof(buf), 0, reinterpret_cast<sockaddr *>(&from), &len);
+        const uint32_t key = from.sin_port;
+        if (n > 0 && backs.find(key) == backs.end())
+          backs[key] = Back{udp_socket(0), from};
+        if (n > 0 && !drop())
+          ::sendto(backs[key].fd, buf, (size_t)n, 0, reinterpret_cast<const sockaddr *>(&hub), sizeof(hub));
+      }
+      for (size_t i = 1; i < fds.size(); ++i)
+      {
+        if (!(fds[i].revents & POLLIN))
+          continue;
+        const ssize_t n = ::recv(fds[i].fd, buf, sizeof(buf), 0);
+        for (auto &kv : backs)
+          if (kv.second.fd == fds[i].fd && n > 0 && !drop())
+            ::sendto(frontFd, buf, (size_t)n, 0, reinterpret_cast<const sockaddr *>(&kv.second.terminal), sizeof(sockaddr_in));
+      }
+    }
+  }
+
+  const int frontFd;
+  const sockaddr_in hub;
+  const double loss;
+  std::mt19937 rng;
+  std::map<uint32_t, Back> backs; // clé : port source du terminal (thread du relais seulement)
+  std::atomic<uint64_t> numDropped{0};
+  std::atomic<bool> stopping{false};
+  std::thread th;
+};
+
+// ============================= Terminal simulé =============================
+
+struct Terminal
+{
+  int seat = 0;
+  int fd = -1; // socket UDP vers le relais
+  websocketpp::connection_hdl hdl;
+  std::atomic<uint64_t> token{0};
+  std::atomic<int> udpPort{0};
+  std::atomic<int> turns{0}; // événements "tour" reçus pour ce siège
+  int64_t turnSeenUs = 0;     // dernier appel remarqué par la boucle des terminaux
+
+  struct InFlight
+  {
+    uint32_t seq;
+    int tries;
+    int64_t firstUs;
+    int64_t lastUs;
+  };
+  std::vector<InFlight> inFlight;
+  uint32_t nextSeq = 0;
+  int sent = 0;
+  int fallbacks = 0;
+};
+
+struct Result
+{
+  uint64_t expected = 0;
+  uint64_t applied = 0;   // appliquées par le moteur
+  uint64_t discarded = 0; // écartées par le moteur (décision déjà jouée)
+  uint64_t refused = 0;   // refusées par submit() (aucune décision de ce siège)
+  WsHub::UdpStats hub;
+  int fallbacks = 0;
+  uint64_t dropped = 0;
+  std::vector<int64_t> ackUs;
+  bool seated = true;
+};
+
+static Result runLoss(int numTerminals, int actions, int gapMs, int rtoMs, int tries, double lossRate, unsigned short port)
+{
+  Result res;
+  const unsigned short wsPort = port, udpPort = port + 1, shimPort = port + 2;
+
+  TableCfg tc;
+  tc.numHuman = 4;
+  tc.numAI = 0;
+  tc.pauseMs = 0;
+  TableManager tables(1, tc, 1);
+  WsHub hub;
+  hub.setUdpPort(udpPort);
+  hub.start(wsPort, &tables, 1);
+  LossyShim shim(shimPort, udpPort, lossRate, 1234);
+
+  // Sièges par WebSocket : jeton et port UDP lus dans siege_attribue
+  client c;
+  c.clear_access_channels(websocketpp::log::alevel::all);
+  c.clear_error_channels(websocketpp::log::elevel::all);
+  c.init_asio();
+  std::vector<std::unique_ptr<Terminal>> terms;
+  for (int i = 0; i < numTerminals; ++i)
+  {
+    terms.push_back(std::make_unique<Terminal>());
+    Terminal *t = terms.back().get();
+    t->seat = i;
+    t->fd = udp_socket(0);
+    websocketpp::lib::error_code ec;
+    client::connection_ptr con = c.get_connection("ws://127.0.0.1:" + std::to_string(wsPort) + "/", ec);
+    if (ec)
+      break;
+    con->set_open_handler([&c, t](websocketpp::connection_hdl h)
+                          {
+      t->hdl = h;
+      websocketpp::lib::error_code e;
+      c.send(h, "{\"action\":\"rejoindre\",\"table\":0,\"siege\":" + std::to_string(t->seat) + "}",
+             websocketpp::frame::opcode::text, e); });
+    con->set_message_handler([t](websocketpp::connection_hdl, client::message_ptr msg)
+                             {
+      const std::string &p = msg->get_payload();
+      if (p.rfind("{\"action\":\"tour\"", 0) == 0)
+      {
+        const size_t s = p.find("\"siege\":");
+        if (s != std::string::npos && std::atoi(p.c_str() + s + 8) == t->seat)
+          t->turns++;
+        return;
+      }
+      if (p.rfind("{\"action\":\"siege_attribue\"", 0) != 0)
+        return;
+      const size_t j = p.find("\"jeton\":\"");
+      const size_t u = p.find("\"udp\":");
+      if (j != std::string::npos)
+        t->token = std::strtoull(p.c_str() + j + 9, nullptr, 16);
+      if (u != std::string::npos)
+        t->udpPort = std::atoi(p.c_str() + u + 6); });
+    c.connect(con);
+  }
+  std::thread clientThread([&c]
+                           { c.run(); });
+
+  const int64_t t0 = steady_us();
+  auto ready = [&]
+  {
+    for (auto &t : terms)
+      if (t->token == 0 || t->udpPort == 0)
+        return false;
+    return true;
+  };
+  while (!ready() && steady_us() - t0 < 5000000)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  res.seated = ready();
+  tables.start(); // sièges tous attribués : aucun appel manqué
+
+  // Boucle des terminaux : une action toutes les gapMs, renvois, acquittements, repli
+  const sockaddr_in shimAddr = loopback(shimPort);
+  auto send_datagram = [&](Terminal &t, uint32_t seq)
+  {
+    uint8_t d[14];
+    d[0] = bin_proto::UdpAction;
+    for (int i = 0; i < 8; ++i)
+      d[1 + i] = (uint8_t)(t.token >> (8 * i));
+    for (int i = 0; i < 4; ++i)
+      d[9 + i] = (uint8_t)(seq >> (8 * i));
+    d[13] = bin_proto::Pret;
+    ::sendto(t.fd, d, sizeof(d), 0, reinterpret_cast<const sockaddr *>(&shimAddr), sizeof(shimAddr));
+  };
+  auto fallback = [&](Terminal &t, uint32_t seq)
+  {
+    websocketpp::lib::error_code e;
+    c.send(t.hdl, "{\"action\":\"pret\",\"seq\":" + std::to_string(seq) + "}", websocketpp::frame::opcode::text, e);
+    t.fallbacks++;
+  };
+
+  // Sièges joués l'un après l'autre : budget d'une action perdue dans les deux sens (repli)
+  const int64_t deadline = steady_us() + (int64_t)numTerminals * actions * (gapMs + rtoMs * tries) * 1000 + 10000000;
+  while (res.seated && steady_us() < deadline)
+  {
+    const int64_t now = steady_us();
+    bool busy = false;
+    for (auto &tp : terms)
+    {
+      Terminal &t = *tp;
+      // Un appel pour ce siège, pas encore joué : action après gapMs de réflexion
+      const bool called = t.sent < actions && t.turns.load() > t.sent;
+      if (called && t.turnSeenUs == 0)
+        t.turnSeenUs = now;
+      if (called && now - t.turnSeenUs >= gapMs * 1000)
+      {
+        t.turnSeenUs = 0;
+        const uint32_t seq = ++t.nextSeq;
+        t.inFlight.push_back({seq, 1, now, now});
+        t.sent++;
+        send_datagram(t, seq);
+      }
+      for (auto it = t.inFlight.begin(); it != t.inFlight.end();)
+      {
+        if (now - it->lastUs < rtoMs * 1000)
+        {
+          ++it;
+          continue;
+        }
+        if (it->tries < tries)
+        {
+          it->tries++;
+          it->lastUs = now;
+          send_datagram(t, it->seq);
+          ++it;
+          continue;
+        }
+        fallback(t, it->seq);
+        it = t.inFlight.erase(it);
+      }
+      busy |= t.sent < actions || !t.inFlight.empty();
+    }
+    if (!busy)
+      break;
+
+    std::vector<pollfd> fds;
+    for (auto &t : terms)
+      fds.push_back(pollfd{t->fd, POLLIN, 0});
+    if (::poll(fds.data(), fds.size(), 1) <= 0)
+      continue;
+    for (size_t i = 0; i < fds.size(); ++i)
+    {
+      uint8_t d[16];
+      while ((fds[i].revents & POLLIN) && ::recv(fds[i].fd, d, sizeof(d), MSG_DONTWAIT) >= 5)
+      {
+        const uint32_t seq = (uint32_t)d[1] | (uint32_t)d[2] << 8 | (uint32_t)d[3] << 16 | (uint32_t)d[4] << 24;
+        Terminal &t = *terms[i];
+        for (auto it = t.inFlight.begin(); it != t.inFlight.end(); ++it)
+          if (it->seq == seq)
+          {
+            if (d[0] == bin_proto::UdpAck)
+              res.ackUs.push_back(steady_us() - it->firstUs);
+            else
+              fallback(t, seq);
+            t.inFlight.erase(it);
+            break;
+          }
+      }
+    }
+  }
+
+  // Replis WebSocket encore en route
+  res.expected = (uint64_t)numTerminals * actions;
+  const int64_t settle = steady_us();
+  while (tables.appliedActions() < res.expected && steady_us() - settle < 2000000)
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100)); // un doublon tardif serait compté
+
+  res.applied = tables.appliedActions();
+  res.discarded = tables.discardedActions();
+  res.refused = tables.refusedActions();
+  res.hub = hub.udpStats();
+  res.dropped = shim.dropped();
+  for (auto &t : terms)
+  {
+    res.fallbacks += t->fallbacks;
+    ::close(t->fd);
+  }
+  tables.stop();
+  hub.stop();
+  c.stop();
+  clientThread.join();
+  return res;
+}
+
+int main(int argc, char **argv)
+{
+  int numTerminals = 4, actions = 50, gapMs = 2, rtoMs = 40, tries = 4;
+  unsigned short port = 18900;
+  std::vector<double> losses = {0, 10, 30, 50};
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string a = argv[i];
+    auto val = [&](const char *prefix) -> const char *
+    { return a.rfind(prefix, 0) == 0 ? a.c_str() + std::strlen(prefix) : nullptr; };
+    const char *v = nullptr;
+    if (a == "--help" || a == "-h")
+    {
+      std::cout << USAGE;
+      return 0;
+    }
+    else if ((v = val("--terminals=")))
+      numTerminals = std::max(1, std::min(4, std::atoi(v)));
+    else if ((v = val("--actions=")))
+      actions = std::max(1, std::atoi(v));
+    else if ((v = val("--gap-ms=")))
+      gapMs = std::max(1, std::atoi(v));
+    else if ((v = val("--rto-ms=")))
+      rtoMs = std::max(1, std::atoi(v));
+    else if ((v = val("--tries=")))
+      tries = std::max(1, std::atoi(v));
+    else if ((v = val("--port=")))
+      port = (unsigned short)std::atoi(v);
+    else if ((v = val("--loss=")))
+    {
+      losses.clear();
+      for (const char *p = v; *p; p = std::strchr(p, ',') ? std::strchr(p, ',') + 1 : p + std::strlen(p))
+        losses.push_back(std::atof(p));
+    }
+    else
+    {
+      std::cerr << "Option inconnue: " << a << "\n"
+                << USAGE;
+      return 1;
+    }
+  }
+
+  bool ok = true;
+  std::printf("perte %%  actions  appliquées  doublons  replis_ws  jetés  ack p50/p95/p99 ms       résultat\n");
+  for (double loss : losses)
+  {
+    Result r = runLoss(numTerminals, actions, gapMs, rtoMs, tries, loss / 100.0, port);
+    port += 3;
+    std::sort(r.ackUs.begin(), r.ackUs.end());
+    auto at = [&](double q)
+    { return r.ackUs.empty() ? 0.0 : r.ackUs[std::min(r.ackUs.size() - 1, (size_t)(q * r.ackUs.size()))] / 1000.0; };
+    // Exactement une fois, vu du moteur : ni perdue, ni appliquée en trop, ni rejouée sur une
+    // décision déjà close (écartée) ou sur un siège qui n'avait plus la main (refusée)
+    const bool doubled = r.applied > r.expected || r.discarded > 0 || r.refused > 0;
+    const bool pass = r.seated && r.applied == r.expected && !doubled;
+    ok &= pass;
+    std::printf("%7.0f  %7llu  %10llu  %8llu  %9d  %5llu  %6.1f / %6.1f / %6.1f  %s\n", loss,
+                (unsigned long long)r.expected, (unsigned long long)r.applied, (unsigned long long)r.hub.duplicates,
+                r.fallbacks, (unsigned long long)r.dropped, at(0.50), at(0.95), at(0.99),
+                !r.seated ? "ÉCHEC (sièges)" : pass ? "OK" : doubled ? "ÉCHEC (doublées)" : "ÉCHEC (perdues)");
+  }
+  return ok ? 0 : 1;
+}
+
+/*
+BUILD (Ubuntu / Raspberry Pi OS) — pas besoin de SDL :
+    sudo apt install g++ libwebsocketpp-dev libasio-dev
+    g++ -std=c++17 -O2 blackjack_udp_loss_test.cpp -o blackjack_udp_loss_test -pthread
+
+Exemples :
+    ./blackjack_udp_loss_test
+    ./blackjack_udp_loss_test --loss=20 --actions=250 --rto-ms=25
+*/
@@ -0,0 +1,2405 @@
+// blackjack_ws_hub.cpp
+// Serveur WebSocket (websocketpp + Asio, sans TLS) pour les terminaux ESP32.
+// - Protocole JSON : événements incrémentaux numérotés (manche / carte / tour / croupier /
+//   resultat) vers le terminal, état complet ("etat") sur demande (resync) ; tirer_carte /
+//   pret / stand / double / rejouer depuis le terminal. Variante binaire compacte négociée à
+//   la connexion (sous-protocole "echoplay.bin"), même sémantique.
+// - Poignée de main : {"action":"rejoindre","table":T,"siege":N} lie la connexion à un siège
+//   d'une table (table 0 / premier siège libre si absents) et renvoie l'état de la table. Les
+//   actions ne sont appliquées qu'au siège lié.
+// - Reprise de session : siege_attribue porte un jeton ; après une coupure WiFi,
+//   {"action":"reprendre","jeton":"..."} rend le siège (l'ancienne connexion, souvent encore
+//   ouverte côté serveur, est évincée) et renvoie aussitôt l'état compact du siège ("reprise").
+//   Le siège reste réservé au jeton kResumeGraceMs après la déconnexion, puis est libéré par une
+//   minuterie de la roue des tables (TableManager::timers()).
+// - Spectateurs : {"action":"regarder","table":T} (lecture seule). Pas d'événements : l'état
+//   complet de la table au plus spectatorHz fois par seconde (10 par défaut), les événements
+//   intermédiaires fusionnés dans le dernier état ; construit par le hub, pas par le moteur.
+// - Envois : trame construite une fois, boîte d'envoi vidée par les threads asio dans des files
+//   bornées par connexion (aucun ws.send sur le thread moteur, un client WiFi lent ne le
+//   ralentit pas). Client lent : état complet périmé remplacé, file pleine -> déconnexion.
+// - N threads asio ; chaque connexion a son strand (ordre de ses trames et de ses actions) et
+//   les connexions sont rangées par table (un verrou par table, pas de verrou global).
+// - GET /metrics sur le même port : compteurs texte (format Prometheus) lus sans verrou.
+// - Canal UDP optionnel (setUdpPort) pour les actions du siège : pas de retransmission TCP sur
+//   un WiFi saturé. Datagramme lié à la session par le jeton, numéroté, acquitté ; doublons
+//   écartés par une fenêtre de 64 numéros par siège. L'état reste sur le WebSocket ; le terminal
+//   sans acquittement renvoie l'action sur le WebSocket avec le même numéro ("seq").
+// - Télémétrie des terminaux ("telemetrie" / 0x88, toutes les 5 s) : durée de boucle, tas libre,
+//   RSSI, temps d'affichage JPEG, reconnexions ; fenêtre glissante par connexion (clientStats).
+// - Partagé par l'UI SDL et tout autre exécutable qui héberge un TableManager.
+// À inclure après blackjack_tables.cpp et blackjack_action_parser.cpp.
+// C++17
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// --- WebSocketpp + Asio ---
+#define ASIO_STANDALONE
+#include <asio.hpp>
+#include <websocketpp/config/asio_no_tls.hpp>
+#include <websocketpp/server.hpp>
+
+#ifdef BLACKJACK_WS_HUB_BENCH
+#include <websocketpp/config/asio_no_tls_client.hpp>
+#include <websocketpp/client.hpp>
+
+#include "blackjack_engine.cpp"
+#include "blackjack_thread_pool.cpp"
+#include "blackjack_montecarlo.cpp"
+#include "blackjack_tables.cpp"
+#include "blackjack_action_parser.cpp"
+#endif
+
+// ============================= Indices de cartes (0..51) =============================
+// Même numérotation que les images card_0.jpg .. card_51.jpg (UI SDL et carte SD de l'ESP32)
+
+static int rankToIndex(Rank r)
+{
+  // Ordre des fichiers: A,2,3,4,5,6,7,8,9,10,J,Q,K
+  if (r == Rank::Ace)
+    return 0;
+  return static_cast<int>(r) - 1; // 2->1 ... 10->9, J->10, Q->11, K->12
+}
+
+static int suitToPackIndex(Suit s)
+{
+  // Ordre des dossiers selon l'utilisateur: Trèfle (Clubs), Coeur (Hearts), Pique (Spades), Carreaux (Diamonds)
+  switch (s)
+  {
+  case Suit::Clubs:
+    return 0;
+  case Suit::Hearts:
+    return 1;
+  case Suit::Spades:
+    return 2;
+  case Suit::Diamonds:
+    return 3;
+  }
+  return 0;
+}
+
+static int cardToImageIndex(const Card &c)
+{
+  int ri = rankToIndex(c.rank);     // 0..12
+  int si = suitToPackIndex(c.suit); // 0..3
+  return si * 13 + ri;              // 0..51
+}
+
+// ============================= Messages JSON =============================
+// Flux incrémental par table : chaque événement porte seq (strictement croissant, +1 par
+// événement). Le client applique les événements à son état local ; s'il détecte un trou il
+// envoie {"action":"resync"} et reçoit l'état complet ("etat") au seq courant. Un événement
+// de seq <= au dernier appliqué est ignoré.
+//   manche   {"seq","round","dealer_up"}        nouvelle manche (mains vidées)
+//   carte    {"seq","siege","carte"}            carte ajoutée à un siège
+//   tour     {"seq","siege"}                    ce siège doit décider
+//   croupier {"seq","carte"}                    carte du croupier révélée
+//   resultat {"seq","siege","dealer_total","player_total","delta","resultat"}
+// Hors flux (réponses à un terminal) :
+//   siege_attribue {"table","siege","jeton","udp"}  jeton : 16 chiffres hexa, à présenter pour
+//            reprendre ; udp : port du canal d'actions UDP (absent si désactivé)
+//   reprise  {"table","siege","jeton","seq","round","main","croupier","mise","a_jouer"}
+//            état compact du siège après reprise ; le flux reprend à seq + 1
+
+// Tampons de sérialisation réutilisés, un jeu par thread (moteur, asio) : clear() conserve la
+// capacité, la construction d'un message n'alloue plus rien en régime établi.
+enum class ScratchSlot
+{
+  Json,
+  Bin,
+  Count,
+};
+
+static std::string &scratch(ScratchSlot slot)
+{
+  thread_local std::string bufs[(int)ScratchSlot::Count];
+  std::string &b = bufs[(int)slot];
+  if (b.capacity() < 512)
+    b.reserve(512);
+  b.clear();
+  return b;
+}
+
+// Écrivain JSON en flux : virgules et imbrication gérées par l'écrivain, entiers via
+// std::to_chars, directement dans le tampon fourni (aucune chaîne temporaire).
+class JsonWriter
+{
+public:
+  explicit JsonWriter(std::string &buf) : out(buf) {}
+
+  JsonWriter &beginObject() { return open('{'); }
+  JsonWriter &endObject() { return close('}'); }
+  JsonWriter &beginArray() { return open('['); }
+  JsonWriter &endArray() { return close(']'); }
+
+  // Clés : littéraux ASCII du protocole, non échappés
+  JsonWriter &key(std::string_view k)
+  {
+    separate();
+    out.push_back('"');
+    out.append(k.data(), k.size());
+    out.append("\":", 2);
+    afterKey = true;
+    return *this;
+  }
+
+  JsonWriter &value(long long v)
+  {
+    separate();
+    char tmp[24];
+    auto r = std::to_chars(tmp, tmp + sizeof(tmp), v);
+    out.append(tmp, (size_t)(r.ptr - tmp));
+    return *this;
+  }
+  JsonWriter &value(int v) { return value((long long)v); }
+  JsonWriter &value(uint32_t v) { return value((long long)v); }
+
+  JsonWriter &value(std::string_view v)
+  {
+    separate();
+    out.push_back('"');
+    for (char c : v)
+    {
+      if (c == '"' || c == '\\')
+        out.push_back('\\');
+      if ((unsigned char)c >= 0x20)
+        out.push_back(c);
+    }
+    out.push_back('"');
+    return *this;
+  }
+  JsonWriter &value(const char *v) { return value(std::string_view(v)); }
+  JsonWriter &value(bool v)
+  {
+    separate();
+    out.append(v ? "true" : "false");
+    return *this;
+  }
+
+  // Indices de cartes 0..51
+  JsonWriter &cards(const std::vector<Card> &cs)
+  {
+    beginArray();
+    for (const auto &c : cs)
+      value(cardToImageIndex(c));
+    return endArray();
+  }
+
+  template <class T>
+  JsonWriter &field(std::string_view k, const T &v) { return key(k).value(v); }
+
+private:
+  // Profondeur d'imbrication maximale des messages du hub
+  static constexpr int kMaxDepth = 8;
+
+  void separate()
+  {
+    if (afterKey)
+    {
+      afterKey = false;
+      return;
+    }
+    if (depth > 0 && !first[depth - 1])
+      out.push_back(',');
+    if (depth > 0)
+      first[depth - 1] = false;
+  }
+
+  JsonWriter &open(char c)
+  {
+    assert(depth < kMaxDepth && "JsonWriter : imbrication trop profonde");
+    separate();
+    out.push_back(c);
+    if (depth < kMaxDepth) // au-delà (NDEBUG) : niveau ignoré, first[] reste dans ses bornes
+    {
+      first[depth] = true;
+      ++depth;
+    }
+    else
+      ++overflow;
+    return *this;
+  }
+
+  JsonWriter &close(char c)
+  {
+    if (overflow > 0)
+      --overflow;
+    else
+      --depth;
+    out.push_back(c);
+    return *this;
+  }
+
+  std::string &out;
+  bool first[kMaxDepth] = {};
+  int depth = 0;
+  int overflow = 0; // niveaux ouverts au-delà de kMaxDepth
+  bool afterKey = false;
+};
+
+// Code de résultat : 0 Defaite, 1 Egalite, 2 Victoire, 3 Blackjack
+static int result_code(const TableEvent &ev)
+{
+  return ev.blackjack ? 3 : (ev.delta > 0 ? 2 : (ev.delta < 0 ? 0 : 1));
+}
+
+static const char *result_name(int code)
+{
+  static const char *const names[] = {"Defaite", "Egalite", "Victoire", "Blackjack"};
+  return names[code];
+}
+
+static void result_fields_json(JsonWriter &w, const TableEvent &ev)
+{
+  w.field("siege", ev.seat)
+      .field("dealer_total", ev.dealerTotal)
+      .field("player_total", ev.playerTotal)
+      .field("delta", (int)std::round(ev.delta))
+      .field("resultat", result_name(result_code(ev)));
+}
+
+static void event_json(std::string &out, const TableEvent &ev)
+{
+  JsonWriter w(out);
+  w.beginObject();
+  switch (ev.kind)
+  {
+  case TableEvent::Kind::Round:
+    w.field("action", "manche").field("seq", ev.seq).field("round", ev.round).field("dealer_up", cardToImageIndex(ev.card));
+    break;
+  case TableEvent::Kind::Card:
+    w.field("action", "carte").field("seq", ev.seq).field("siege", ev.seat).field("carte", cardToImageIndex(ev.card));
+    break;
+  case TableEvent::Kind::Turn:
+    w.field("action", "tour").field("seq", ev.seq).field("siege", ev.seat);
+    break;
+  case TableEvent::Kind::Dealer:
+    w.field("action", "croupier").field("seq", ev.seq).field("carte", cardToImageIndex(ev.card));
+    break;
+  case TableEvent::Kind::Result:
+    w.field("action", "resultat").field("seq", ev.seq);
+    result_fields_json(w, ev);
+    break;
+  }
+  w.endObject();
+}
+
+// État complet d'une table au seq donné (réponse à "resync" et à "rejoindre")
+static void snapshot_json(std::string &out, const TableSnapshot &v)
+{
+  JsonWriter w(out);
+  w.beginObject().field("action", "etat").field("seq", v.seq).field("round", v.round).field("tour", v.turn);
+  w.key("dealer_cartes").cards(v.dealer);
+  w.key("mains").beginArray();
+  for (const auto &h : v.hands)
+    w.cards(h);
+  w.endArray();
+  w.key("resultats").beginArray();
+  for (const auto &r : v.results)
+  {
+    w.beginObject();
+    result_fields_json(w, r);
+    w.endObject();
+  }
+  w.endArray().endObject();
+}
+
+// ============================= Protocole binaire (opt-in) =============================
+// Négocié à la connexion : le client demande le sous-protocole WebSocket "echoplay.bin".
+// Trames binaires : 1 octet d'opcode, cartes sur 1 octet (indice 0..51), listes préfixées
+// par leur longueur (1 octet), entiers multi-octets en little-endian. Mêmes événements et
+// même règle de seq que le JSON.
+// Garder synchronisé avec include/websocket.hpp (ProtoBin) côté ESP32.
+//
+//   Serveur -> terminal
+//     0x01 siege_attribue  [table u8][siege u8][jeton u64][udp u16 (si canal UDP actif)]
+//     0x02 siege_refuse
+//     0x03 spectateur      [table u8]
+//     0x04 reprise         [table u8][siege u8][jeton u64][seq u32][round u32]
+//                          [croupier u8 (0xFF = aucune)][mise u16][a_jouer u8][n u8][cartes]
+//     0x10 manche          [seq u32][round u32][dealer_up u8]
+//     0x11 carte           [seq u32][siege u8][carte u8]
+//     0x12 tour            [seq u32][siege u8]
+//     0x13 croupier        [seq u32][carte u8]
+//     0x14 resultat        [seq u32][siege u8][dealer_total u8][player_total u8][delta i16][resultat u8]
+//                          resultat : 0 Defaite, 1 Egalite, 2 Victoire, 3 Blackjack
+//     0x15 etat            [seq u32][round u32][tour u8 (0xFF = aucun)][n u8][cartes croupier]
+//                          [nb sièges u8] puis par siège [n u8][cartes]
+//                          [nb résultats u8] puis par résultat les champs de 0x14 après seq
+//   Terminal -> serveur
+//     0x80 rejoindre       [table u8][siege u8 (0xFF = premier libre)]  (champs optionnels)
+//     0x81 tirer_carte, 0x82 pret (stand), 0x83 double, 0x84 rejouer  [seq u32 (optionnel)]
+//     0x85 resync
+//     0x86 regarder        [table u8]
+//     0x87 reprendre       [jeton u64]
+//     0x88 telemetrie      [boucle_us u32][boucle_max_us u32][jpeg_n u16][jpeg_us u32][jpeg_max_us u32]
+//                          [tas_libre u32][tas_min u32][rssi i8][reconnexions u16]
+//   Canal UDP (datagrammes, port annoncé dans siege_attribue)
+//     0xA0 action          [jeton u64][seq u32][op u8 : 0x81..0x84]   terminal -> serveur
+//     0xA1 acquittement    [seq u32]      reçue (appliquée ou doublon déjà appliqué)
+//     0xA2 refus           [seq u32]      jeton inconnu ou siège hors ligne : passer par le WebSocket
+//   seq : numéro d'action du terminal, croissant à partir de 1 pour un jeton ; le même numéro
+//   sur le WebSocket (champ "seq" JSON ou 4 octets après l'opcode) n'est appliqué qu'une fois.
+
+namespace bin_proto
+{
+  static const char *const kSubprotocol = "echoplay.bin";
+
+  enum Op : uint8_t
+  {
+    SiegeAttribue = 0x01,
+    SiegeRefuse = 0x02,
+    Spectateur = 0x03,
+    Reprise = 0x04,
+    Manche = 0x10,
+    Carte = 0x11,
+    Tour = 0x12,
+    Croupier = 0x13,
+    Resultat = 0x14,
+    Etat = 0x15,
+    Rejoindre = 0x80,
+    TirerCarte = 0x81,
+    Pret = 0x82,
+    Double = 0x83,
+    Rejouer = 0x84,
+    Resync = 0x85,
+    Regarder = 0x86,
+    Reprendre = 0x87,
+    Telemetrie = 0x88,
+    UdpAction = 0xA0,
+    UdpAck = 0xA1,
+    UdpRefus = 0xA2,
+  };
+
+  static void put_u8(std::string &out, int v) { out.push_back((char)(uint8_t)v); }
+
+  static uint32_t get_le(const uint8_t *p, int bytes)
+  {
+    uint32_t v = 0;
+    for (int i = 0; i < bytes; ++i)
+      v |= (uint32_t)p[i] << (8 * i);
+    return v;
+  }
+
+  static void put_le(std::string &out, uint64_t v, int bytes)
+  {
+    for (int i = 0; i < bytes; ++i)
+      out.push_back((char)((v >> (8 * i)) & 0xFF));
+  }
+
+  static void put_cards(std::string &out, const std::vector<Card> &cards)
+  {
+    put_u8(out, (int)std::min<size_t>(cards.size(), 255));
+    for (size_t i = 0; i < cards.size() && i < 255; ++i)
+      put_u8(out, cardToImageIndex(cards[i]));
+  }
+
+  static void put_result(std::string &out, const TableEvent &ev)
+  {
+    put_u8(out, ev.seat);
+    put_u8(out, ev.dealerTotal);
+    put_u8(out, ev.playerTotal);
+    put_le(out, (uint32_t)(uint16_t)(int16_t)std::round(ev.delta), 2);
+    put_u8(out, result_code(ev));
+  }
+
+  // Trame 0x88 (30 octets, voir en-tête) -> relevé ; false si trop courte
+  static bool get_telemetry(const uint8_t *p, size_t n, TelemetrySample &t)
+  {
+    if (n < 30 || p[0] != Telemetrie)
+      return false;
+    t.loopAvgUs = get_le(p + 1, 4);
+    t.loopMaxUs = get_le(p + 5, 4);
+    t.jpegCount = get_le(p + 9, 2);
+    t.jpegAvgUs = get_le(p + 11, 4);
+    t.jpegMaxUs = get_le(p + 15, 4);
+    t.heapFree = get_le(p + 19, 4);
+    t.heapMin = get_le(p + 23, 4);
+    t.rssi = (int8_t)p[27];
+    t.reconnects = get_le(p + 28, 2);
+    return true;
+  }
+} // namespace bin_proto
+
+static void event_bin(std::string &out, const TableEvent &ev)
+{
+  using namespace bin_proto;
+  switch (ev.kind)
+  {
+  case TableEvent::Kind::Round:
+    put_u8(out, Manche);
+    put_le(out, ev.seq, 4);
+    put_le(out, (uint32_t)ev.round, 4);
+    put_u8(out, cardToImageIndex(ev.card));
+    break;
+  case TableEvent::Kind::Card:
+    put_u8(out, Carte);
+    put_le(out, ev.seq, 4);
+    put_u8(out, ev.seat);
+    put_u8(out, cardToImageIndex(ev.card));
+    break;
+  case TableEvent::Kind::Turn:
+    put_u8(out, Tour);
+    put_le(out, ev.seq, 4);
+    put_u8(out, ev.seat);
+    break;
+  case TableEvent::Kind::Dealer:
+    put_u8(out, Croupier);
+    put_le(out, ev.seq, 4);
+    put_u8(out, cardToImageIndex(ev.card));
+    break;
+  case TableEvent::Kind::Result:
+    put_u8(out, Resultat);
+    put_le(out, ev.seq, 4);
+    put_result(out, ev);
+    break;
+  }
+}
+
+static void snapshot_bin(std::string &out, const TableSnapshot &v)
+{
+  using namespace bin_proto;
+  put_u8(out, Etat);
+  put_le(out, v.seq, 4);
+  put_le(out, (uint32_t)v.round, 4);
+  put_u8(out, v.turn < 0 ? 0xFF : v.turn);
+  put_cards(out, v.dealer);
+  put_u8(out, (int)v.hands.size());
+  for (auto &h : v.hands)
+    put_cards(out, h);
+  put_u8(out, (int)v.results.size());
+  for (auto &r : v.results)
+    put_result(out, r);
+}
+
+// Un message serveur dans ses deux encodages (chaque connexion reçoit le sien).
+// Vues sur les tampons du thread appelant : valides jusqu'au prochain msg_* sur ce thread,
+// à consommer immédiatement (broadcast / sendToTable / send_now copient dans la trame).
+struct WireMsg
+{
+  std::string_view json;
+  std::string_view bin;
+};
+
+static WireMsg msg_event(const TableEvent &ev)
+{
+  std::string &j = scratch(ScratchSlot::Json);
+  std::string &b = scratch(ScratchSlot::Bin);
+  event_json(j, ev);
+  event_bin(b, ev);
+  return {j, b};
+}
+
+static WireMsg msg_snapshot(const TableSnapshot &v)
+{
+  std::string &j = scratch(ScratchSlot::Json);
+  std::string &b = scratch(ScratchSlot::Bin);
+  snapshot_json(j, v);
+  snapshot_bin(b, v);
+  return {j, b};
+}
+
+// Jeton de session en 16 chiffres hexa (longueur fixe : comparé tel quel par les terminaux)
+struct JetonHex
+{
+  char s[17];
+  explicit JetonHex(uint64_t v)
+  {
+    static const char kHex[] = "0123456789abcdef";
+    for (int i = 15; i >= 0; --i, v >>= 4)
+      s[i] = kHex[v & 0xF];
+    s[16] = '\0';
+  }
+};
+
+static WireMsg msg_siege_attribue(int table, int seat, uint64_t jeton, int udpPort)
+{
+  std::string &j = scratch(ScratchSlot::Json);
+  std::string &b = scratch(ScratchSlot::Bin);
+  JsonWriter w(j);
+  w.beginObject().field("action", "siege_attribue").field("table", table).field("siege", seat).field("jeton", JetonHex(jeton).s);
+  if (udpPort > 0)
+    w.field("udp", udpPort);
+  w.endObject();
+  bin_proto::put_u8(b, bin_proto::SiegeAttribue);
+  bin_proto::put_u8(b, table);
+  bin_proto::put_u8(b, seat);
+  bin_proto::put_le(b, jeton, 8);
+  if (udpPort > 0)
+    bin_proto::put_le(b, (uint64_t)udpPort, 2);
+  return {j, b};
+}
+
+// État compact d'un seul siège : main, carte visible du croupier, mise, décision attendue
+static WireMsg msg_reprise(int table, int seat, uint64_t jeton, const TableSnapshot &v)
+{
+  std::string &j = scratch(ScratchSlot::Json);
+  std::string &b = scratch(ScratchSlot::Bin);
+  static const std::vector<Card> kNoCards;
+  const std::vector<Card> &hand = seat < (int)v.hands.size() ? v.hands[seat] : kNoCards;
+  const int up = v.dealer.empty() ? -1 : cardToImageIndex(v.dealer.front());
+  const int bet = seat < (int)v.bets.size() ? (int)std::lround(v.bets[seat]) : 0;
+  const bool pending = v.turn == seat;
+  JsonWriter w(j);
+  w.beginObject().field("action", "reprise").field("table", table).field("siege", seat).field("jeton", JetonHex(jeton).s);
+  w.field("seq", v.seq).field("round", v.round).key("main").cards(hand);
+  w.field("croupier", up).field("mise", bet).field("a_jouer", pending).endObject();
+  bin_proto::put_u8(b, bin_proto::Reprise);
+  bin_proto::put_u8(b, table);
+  bin_proto::put_u8(b, seat);
+  bin_proto::put_le(b, jeton, 8);
+  bin_proto::put_le(b, v.seq, 4);
+  bin_proto::put_le(b, (uint32_t)v.round, 4);
+  bin_proto::put_u8(b, up < 0 ? 0xFF : up);
+  bin_proto::put_le(b, (uint32_t)std::min(std::max(bet, 0), 0xFFFF), 2);
+  bin_proto::put_u8(b, pending ? 1 : 0);
+  bin_proto::put_cards(b, hand);
+  return {j, b};
+}
+
+static WireMsg msg_spectateur(int table)
+{
+  std::string &j = scratch(ScratchSlot::Json);
+  std::string &b = scratch(ScratchSlot::Bin);
+  JsonWriter(j).beginObject().field("action", "spectateur").field("table", table).endObject();
+  bin_proto::put_u8(b, bin_proto::Spectateur);
+  bin_proto::put_u8(b, table);
+  return {j, b};
+}
+
+static WireMsg msg_siege_refuse()
+{
+  std::string &j = scratch(ScratchSlot::Json);
+  std::string &b = scratch(ScratchSlot::Bin);
+  JsonWriter(j).beginObject().field("action", "siege_refuse").endObject();
+  bin_proto::put_u8(b, bin_proto::SiegeRefuse);
+  return {j, b};
+}
+
+// ============================= Latences =============================
+
+// Histogramme glissant de latences (µs) : classes logarithmiques d'un quart d'octave (~19 %),
+// de 1 µs à ~2 min, compteurs 16 bits. Deux fenêtres de kWindow mesures (courante + précédente) :
+// les percentiles portent sur les 64..128 dernières mesures, sans allocation ni tri.
+class LatencyHist
+{
+public:
+  static constexpr int kWindow = 64;
+  static constexpr int kBuckets = 27 * 4;
+
+  void add(int64_t us)
+  {
+    if (cur.n == kWindow)
+    {
+      prev = cur;
+      cur = Window{};
+    }
+    cur.counts[bucket(us)]++;
+    cur.n++;
+  }
+
+  int samples() const { return cur.n + prev.n; }
+
+  // Percentile p (0..1), valeur centrale de la classe en µs ; 0 sans mesure
+  uint32_t percentile(double p) const
+  {
+    const int total = samples();
+    if (total == 0)
+      return 0;
+    const int target = std::max(1, (int)std::ceil(p * total));
+    int acc = 0;
+    for (int i = 0; i < kBuckets; ++i)
+    {
+      acc += cur.counts[i] + prev.counts[i];
+      if (acc >= target)
+        return bucketMid(i);
+    }
+    return bucketMid(kBuckets - 1);
+  }
+
+private:
+  struct Window
+  {
+    uint16_t counts[kBuckets] = {};
+    int n = 0;
+  };
+
+  // Classe = 4 * log2(us) + 2 bits de mantisse
+  static int bucket(int64_t us)
+  {
+    if (us < 4)
+      return us < 1 ? 0 : (int)us * 2; // 1 -> 2, 2 -> 4, 3 -> 6 (classes exactes)
+    int msb = 63;
+    while (!((uint64_t)us >> msb))
+      --msb;
+    return std::min(kBuckets - 1, msb * 4 + (int)((us >> (msb - 2)) & 3));
+  }
+
+  static uint32_t bucketMid(int i)
+  {
+    const int msb = i / 4;
+    if (msb < 2)
+      return (uint32_t)(i / 2);
+    const uint64_t lo = ((uint64_t)(4 + i % 4)) << (msb - 2);
+    const uint64_t width = (uint64_t)1 << (msb - 2);
+    return (uint32_t)(lo + width / 2);
+  }
+
+  Window cur, prev;
+};
+
+// Télémétrie d'un terminal : ses kWindow derniers relevés (une minute à la période par défaut
+// du terminal, 5 s), résumés à la lecture. Taille fixe, aucune allocation.
+class TelemetryWindow
+{
+public:
+  static constexpr int kWindow = 12;
+
+  struct Summary
+  {
+    int samples = 0;           // relevés dans la fenêtre (0 : terminal sans télémétrie)
+    uint64_t reports = 0;      // relevés reçus depuis la connexion
+    int64_t ageMs = -1;        // âge du dernier relevé
+    uint32_t loopAvgUs = 0;    // moyenne des durées moyennes d'itération
+    uint32_t loopMaxUs = 0;    // pire itération de la fenêtre
+    uint32_t jpegCount = 0;    // cartes affichées dans la fenêtre
+    uint32_t jpegAvgUs = 0;    // moyenne pondérée par le nombre de cartes
+    uint32_t jpegMaxUs = 0;
+    uint32_t heapFree = 0;     // dernier relevé
+    uint32_t heapLow = 0;      // plus bas tas libre relevé dans la fenêtre
+    uint32_t heapMin = 0;      // plus bas depuis le démarrage du terminal
+    int rssi = 0;              // dernier relevé (dBm)
+    int rssiMin = 0;           // pire relevé de la fenêtre
+    uint32_t reconnects = 0;   // depuis le démarrage du terminal
+    uint32_t reconnectsWindow = 0; // dont pendant la fenêtre
+  };
+
+  void add(const TelemetrySample &s, int64_t atUs)
+  {
+    ring[next] = s;
+    next = (next + 1) % kWindow;
+    n = std::min(n + 1, kWindow);
+    reports++;
+    lastUs = atUs;
+  }
+
+  Summary summary(int64_t nowUs) const
+  {
+    Summary r;
+    r.samples = n;
+    r.reports = reports;
+    if (n == 0)
+      return r;
+    r.ageMs = (nowUs - lastUs) / 1000;
+    const TelemetrySample &last = ring[(next + kWindow - 1) % kWindow];
+    const TelemetrySample &oldest = ring[(next + kWindow - n) % kWindow];
+    uint64_t loopSum = 0, jpegSum = 0;
+    r.heapLow = UINT32_MAX;
+    for (int i = 0; i < n; ++i)
+    {
+      const TelemetrySample &t = ring[(next + kWindow - n + i) % kWindow];
+      loopSum += t.loopAvgUs;
+      r.loopMaxUs = std::max(r.loopMaxUs, t.loopMaxUs);
+      r.jpegCount += t.jpegCount;
+      jpegSum += (uint64_t)t.jpegAvgUs * t.jpegCount;
+      r.jpegMaxUs = std::max(r.jpegMaxUs, t.jpegMaxUs);
+      if (t.heapFree != 0)
+        r.heapLow = std::min(r.heapLow, t.heapFree);
+      if (t.rssi != 0 && (r.rssiMin == 0 || t.rssi < r.rssiMin))
+        r.rssiMin = t.rssi;
+    }
+    r.loopAvgUs = (uint32_t)(loopSum / n);
+    r.jpegAvgUs = r.jpegCount ? (uint32_t)(jpegSum / r.jpegCount) : 0;
+    if (r.heapLow == UINT32_MAX)
+      r.heapLow = 0;
+    r.heapFree = last.heapFree;
+    r.heapMin = last.heapMin;
+    r.rssi = last.rssi;
+    r.reconnects = last.reconnects;
+    r.reconnectsWindow = last.reconnects - std::min(last.reconnects, oldest.reconnects);
+    return r;
+  }
+
+private:
+  TelemetrySample ring[kWindow];
+  int next = 0;
+  int n = 0;
+  uint64_t reports = 0;
+  int64_t lastUs = 0;
+};
+
+static int64_t steady_us()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Histogramme cumulé de tous les clients, seuils fixes (ms) au format Prometheus : compteurs
+// atomiques, enregistrement depuis les strands et lecture par la page de métriques sans verrou.
+class CounterHist
+{
+public:
+  static constexpr int kMaxBounds = 12;
+
+  CounterHist(std::initializer_list<uint32_t> boundsMs)
+  {
+    for (uint32_t b : boundsMs)
+      if (numBounds < kMaxBounds)
+        bounds[numBounds++] = (int64_t)b * 1000;
+  }
+
+  void add(int64_t us)
+  {
+    int i = 0;
+    while (i < numBounds && us > bounds[i])
+      ++i;
+    counts[i].fetch_add(1, std::memory_order_relaxed); // i == numBounds : au-delà du dernier seuil
+    sumUs.fetch_add((uint64_t)std::max<int64_t>(us, 0), std::memory_order_relaxed);
+  }
+
+  // Lignes name_bucket{le=...} (cumulées), name_sum (s), name_count
+  void render(std::string &out, const char *name) const
+  {
+    char line[160];
+    uint64_t acc = 0;
+    for (int i = 0; i <= numBounds; ++i)
+    {
+      acc += counts[i].load(std::memory_order_relaxed);
+      if (i < numBounds)
+        std::snprintf(line, sizeof(line), "%s_bucket{le=\"%g\"} %llu\n", name, bounds[i] / 1e6, (unsigned long long)acc);
+      else
+        std::snprintf(line, sizeof(line), "%s_bucket{le=\"+Inf\"} %llu\n", name, (unsigned long long)acc);
+      out += line;
+    }
+    std::snprintf(line, sizeof(line), "%s_sum %.6f\n%s_count %llu\n", name,
+                  sumUs.load(std::memory_order_relaxed) / 1e6, name, (unsigned long long)acc);
+    out += line;
+  }
+
+private:
+  int64_t bounds[kMaxBounds] = {};
+  int numBounds = 0;
+  std::atomic<uint64_t> counts[kMaxBounds + 1] = {};
+  std::atomic<uint64_t> sumUs{0};
+};
+
+// ============================= WebSocket Server =============================
+
+// Trafic d'une connexion tel que vu par le hub (enregistreur : blackjack_ws_recorder.cpp)
+enum class TrafficKind : uint8_t
+{
+  Open = 1, // charge utile : sous-protocole négocié ("" = JSON)
+  Close,
+  InText,
+  InBinary,
+  OutText,
+  OutBinary,
+};
+
+class WsHub
+{
+public:
+  using server = websocketpp::server<websocketpp::config::asio>;
+  using message_type = websocketpp::config::asio::message_type;
+  using con_msg_manager_type = websocketpp::config::asio::con_msg_manager_type;
+
+  // File d'envoi par connexion (trames en attente côté hub, hors tampon websocketpp)
+  static constexpr size_t kMaxQueuedFrames = 32;        // au-delà : client trop lent -> déconnexion
+  static constexpr size_t kMaxBufferedBytes = 16 * 1024; // tampon websocketpp max avant de retenir
+  static constexpr long kRetryMs = 20;                  // relance du vidage si client en retard
+  static constexpr int kSpectatorHz = 10;               // cadence par défaut de l'état envoyé aux spectateurs
+  static constexpr long kPingMs = 2000;                 // ping WebSocket par connexion (mesure du RTT)
+  static constexpr uint32_t kDegradedRttUs = 300000;    // RTT p95 au-delà : client dégradé
+  static constexpr int kDegradedMissedPongs = 2;        // pings sans réponse : client dégradé
+  static constexpr int kMinRttSamples = 8;              // mesures avant de juger le p95
+  static constexpr long kResumeGraceMs = 10000;         // siège réservé au jeton après une coupure
+  static constexpr int kActionSeqWindow = 64;           // numéros d'action mémorisés par siège (doublons)
+
+  // Type de trame : un état complet (Snapshot) plus récent remplace celui encore en file
+  // (les événements qui le suivent en file ont un seq <= au sien et seront ignorés)
+  enum class FrameKind : uint8_t
+  {
+    Event, // jamais fusionnée ni supprimée (un trou de seq forcerait une resynchronisation)
+    Snapshot,
+  };
+
+  // Trafic de chaque connexion (ouverture, trames reçues et envoyées, fermeture), dans l'ordre
+  // de son strand. À brancher avant start ; appelé depuis les threads asio.
+  std::function<void(TrafficKind kind, uint32_t conn, std::string_view payload)> onTraffic;
+
+  // Latences d'un client : RTT ping/pong et délai de décision (appel du siège -> action reçue),
+  // plus la télémétrie que le terminal publie lui-même
+  struct ClientStats
+  {
+    std::string remote;
+    int table = -1;
+    int seat = -1;
+    bool spectator = false;
+    bool binary = false;
+    uint32_t rttP50Us = 0, rttP95Us = 0, rttP99Us = 0;
+    int rttSamples = 0;
+    uint32_t decisionP50Us = 0, decisionP95Us = 0, decisionP99Us = 0;
+    int decisionSamples = 0;
+    int missedPongs = 0;
+    bool degraded = false;
+    TelemetryWindow::Summary telemetry; // relevés envoyés par le terminal (ESP32)
+  };
+
+  // Canal d'actions UDP : issue de chaque datagramme ou action numérotée reçue
+  struct UdpStats
+  {
+    uint64_t applied = 0;       // actions appliquées (UDP ou WebSocket numéroté)
+    uint64_t duplicates = 0;    // numéro déjà vu : acquitté, pas réappliqué
+    uint64_t refused = 0;       // jeton inconnu ou siège hors ligne
+    uint64_t malformed = 0;     // datagramme invalide, ignoré
+    uint64_t viaWebSocket = 0;  // dont appliquées après repli sur le WebSocket
+  };
+
+  WsHub() : running(false), tables(nullptr) {}
+
+  // Cadence max de l'état envoyé aux spectateurs (avant start)
+  void setSpectatorHz(int hz) { spectatorHz = std::max(1, std::min(1000, hz)); }
+
+  // Temps de travail d'un thread de l'hôte (ex. boucle UI) publié sur la page de métriques.
+  // Avant start ; le compteur doit survivre au hub.
+  void addBusyMeter(const char *thread, const BusyMeter *m) { busyMeters.emplace_back(thread, m); }
+
+  // Port UDP des actions (avant start ; 0 = désactivé). Peut être le même numéro que le port
+  // WebSocket (TCP) ; annoncé aux terminaux dans siege_attribue.
+  void setUdpPort(unsigned short port) { udpPort = port; }
+
+  // Branche le hub sur les tables (flux d'événements) et écoute le port.
+  // ioThreads : threads asio (0 = nb de coeurs) ; l'ordre par client est garanti par son strand.
+  void start(unsigned short port, TableManager *t, unsigned ioThreads = 1)
+  {
+    tables = t;
+    groups.clear();
+    for (int i = 0; i <= tables->numTables(); ++i) // une par table + salle d'attente (dernière)
+    {
+      groups.push_back(std::make_unique<Group>());
+      Group &g = *groups.back();
+      g.numSeats = i < tables->numTables() ? tables->humanSeats(i) : 0;
+      g.turnAt = std::make_unique<std::atomic<int64_t>[]>(g.numSeats);
+      g.sessions.resize(g.numSeats);
+      g.graceTimers = std::make_unique<TimerWheel::Timer[]>(g.numSeats);
+      for (int s = 0; s < g.numSeats; ++s)
+        g.graceTimers[s].fn = [this, i, s]
+        { expire_session(i, s); };
+    }
+    // Événements incrémentaux : diffusés aux joueurs de la table, dans l'ordre. Pour les
+    // spectateurs, le thread moteur ne fait que marquer la table (état envoyé par spectator_tick)
+    tables->onEvent = [this](int table, const TableEvent &ev)
+    {
+      Group &g = *groups[table];
+      if (ev.kind == TableEvent::Kind::Turn && ev.seat >= 0 && ev.seat < g.numSeats)
+        g.turnAt[ev.seat].store(steady_us(), std::memory_order_relaxed);
+      if (g.numSpectators.load(std::memory_order_relaxed) > 0)
+        g.dirty.store(true, std::memory_order_relaxed);
+      if (g.numPlayers.load(std::memory_order_relaxed) > 0)
+        sendToTable(table, msg_event(ev));
+    };
+
+    ws.clear_access_channels(websocketpp::log::alevel::all);
+    ws.init_asio();
+    ws.set_reuse_addr(true);
+    distStrand = std::make_unique<asio::io_context::strand>(ws.get_io_service());
+    ws.set_validate_handler([this](websocketpp::connection_hdl hdl)
+                            {
+            // Négociation du protocole binaire (sous-protocole demandé par le client)
+            server::connection_ptr con = ws.get_con_from_hdl(hdl);
+            for (auto const &p : con->get_requested_subprotocols())
+              if (p == bin_proto::kSubprotocol)
+              {
+                con->select_subprotocol(p);
+                break;
+              }
+            return true; });
+    ws.set_open_handler([this](websocketpp::connection_hdl hdl)
+                        { on_open(hdl); });
+    // HTTP simple sur le même port : GET /metrics (texte, format Prometheus)
+    ws.set_http_handler([this](websocketpp::connection_hdl hdl)
+                        { on_http(hdl); });
+    ws.listen(port);
+    ws.start_accept();
+    running.store(true);
+    if (udpPort != 0)
+    {
+      // Socket créée ici : l'io_service de websocketpp n'existe qu'après init_asio(). Port
+      // indisponible : le hub tourne sans canal UDP (non annoncé aux terminaux)
+      asio::error_code uec;
+      udp = std::make_unique<asio::ip::udp::socket>(ws.get_io_service());
+      udp->open(asio::ip::udp::v4(), uec);
+      if (!uec)
+        udp->bind(asio::ip::udp::endpoint(asio::ip::udp::v4(), udpPort), uec);
+      if (uec)
+      {
+        std::cerr << "[UDP] port " << udpPort << " : " << uec.message() << " (canal d'actions désactivé)\n";
+        udp.reset();
+        udpPort = 0;
+      }
+      else
+      {
+        arm_udp_receive();
+      }
+    }
+    startUs = lastScrapeUs = steady_us();
+    lastScrapeRounds = tables->roundsPlayed();
+    if (ioThreads == 0)
+      ioThreads = std::max(1u, std::thread::hardware_concurrency());
+    arm_spectator_tick();
+    arm_ping_tick();
+    for (unsigned i = 0; i < ioThreads; ++i)
+      ioPool.emplace_back([this]
+                          { ws.run(); });
+  }
+
+  void stop()
+  {
+    if (!running.exchange(false))
+      return;
+    websocketpp::lib::error_code ec;
+    ws.stop_listening(ec);
+    for (auto &c : allConns())
+      ws.close(c->hdl, websocketpp::close::status::normal, "shutdown", ec);
+    for (auto &g : groups)
+    {
+      std::lock_guard<std::mutex> lk(g->m);
+      g->members.clear();
+      g->spectators.clear();
+    }
+    ws.stop();
+    for (auto &th : ioPool)
+      if (th.joinable())
+        th.join();
+    ioPool.clear();
+    if (udp)
+    {
+      asio::error_code uec;
+      udp->close(uec); // threads asio arrêtés : plus de réception en cours
+      udp.reset();
+    }
+    for (auto &g : groups) // la roue appartient aux tables, qui survivent au hub
+      for (int s = 0; s < g->numSeats; ++s)
+        tables->timers().cancel(g->graceTimers[s]);
+  }
+
+  unsigned numIoThreads() const { return (unsigned)ioPool.size(); }
+  int numSpectators(int table) const { return groups[table]->numSpectators.load(); }
+  int numConnections() const { return numText.load() + numBinary.load(); }
+  int numDegraded() const { return numDegradedConns.load(); }
+
+  UdpStats udpStats() const
+  {
+    UdpStats st;
+    st.applied = udpApplied.load();
+    st.duplicates = udpDuplicates.load();
+    st.refused = udpRefused.load();
+    st.malformed = udpMalformed.load();
+    st.viaWebSocket = seqViaWs.load();
+    return st;
+  }
+
+  // Instantané des latences de tous les clients (n'importe quel thread : UI, journal)
+  std::vector<ClientStats> clientStats()
+  {
+    std::vector<ClientStats> out;
+    const int64_t now = steady_us();
+    for (auto &c : allConns())
+    {
+      ClientStats st;
+      st.remote = c->remote;
+      st.binary = c->binary;
+      st.seat = c->seat.load();
+      std::lock_guard<std::mutex> lk(c->statsM);
+      st.table = c->stats.table;
+      st.spectator = c->stats.spectator;
+      st.rttP50Us = c->stats.rtt.percentile(0.50);
+      st.rttP95Us = c->stats.rtt.percentile(0.95);
+      st.rttP99Us = c->stats.rtt.percentile(0.99);
+      st.rttSamples = c->stats.rtt.samples();
+      st.decisionP50Us = c->stats.decision.percentile(0.50);
+      st.decisionP95Us = c->stats.decision.percentile(0.95);
+      st.decisionP99Us = c->stats.decision.percentile(0.99);
+      st.decisionSamples = c->stats.decision.samples();
+      st.missedPongs = c->stats.missedPongs;
+      st.degraded = c->stats.degraded;
+      st.telemetry = c->stats.telemetry.summary(now);
+      out.push_back(std::move(st));
+    }
+    return out;
+  }
+
+  // Diffuse à toutes les connexions de joueurs (hors spectateurs). Coût O(1) pour l'appelant :
+  // la trame est construite une fois par encodage utilisé, la distribution se fait sur les
+  // threads asio.
+  void broadcast(const WireMsg &m, FrameKind kind = FrameKind::Event)
+  {
+    enqueue(Outgoing{frames(m), kind, -1, -1});
+  }
+
+  // Envoie à tous les joueurs d'une table (les spectateurs reçoivent l'état à cadence fixe)
+  void sendToTable(int table, const WireMsg &m, FrameKind kind = FrameKind::Event)
+  {
+    enqueue(Outgoing{frames(m), kind, table, -1});
+  }
+
+  // Envoie uniquement au client propriétaire du siège
+  void sendToSeat(int table, int seat, const WireMsg &m, FrameKind kind = FrameKind::Event)
+  {
+    enqueue(Outgoing{frames(m), kind, table, seat});
+  }
+
+private:
+  struct Frame
+  {
+    server::message_ptr msg;
+    FrameKind kind;
+  };
+
+  // État d'une connexion : modifié uniquement sur son strand (ordre des trames et des actions
+  // d'un client préservé quel que soit le thread asio qui l'exécute)
+  struct Conn
+  {
+    Conn(asio::io_context &io, websocketpp::connection_hdl h, bool bin, uint32_t connId)
+        : strand(io), hdl(std::move(h)), binary(bin), id(connId) {}
+
+    asio::io_context::strand strand;
+    const websocketpp::connection_hdl hdl;
+    const bool binary; // sous-protocole echoplay.bin négocié
+    const uint32_t id;  // numéro de connexion (enregistrement du trafic)
+    int table = -1;             // -1 = pas encore rejoint (salle d'attente)
+    std::atomic<int> seat{-1}; // lu aussi par distribute()
+    bool spectator = false;     // dans Group::spectators de sa table
+    std::deque<Frame> queue;
+    bool retryArmed = false;
+    bool closed = false;
+    uint64_t token = 0; // jeton de session du siège tenu
+    std::string remote;
+
+    // Latences et télémétrie : écrites sur le strand, lues par clientStats() (verrou statsM)
+    struct Stats
+    {
+      LatencyHist rtt;
+      LatencyHist decision;
+      TelemetryWindow telemetry;
+      int table = -1;
+      bool spectator = false;
+      int missedPongs = 0; // pings envoyés depuis le dernier pong
+      bool degraded = false;
+    };
+    std::mutex statsM;
+    Stats stats;
+  };
+  using ConnPtr = std::shared_ptr<Conn>;
+
+  // Connexions d'une table (ou de la salle d'attente) : un verrou par groupe, aucune structure
+  // globale traversée par tous les clients. Les spectateurs sont à part : la diffusion des
+  // événements aux joueurs ne les parcourt jamais.
+  struct Group
+  {
+    std::mutex m;
+    std::vector<ConnPtr> members;
+    std::vector<ConnPtr> spectators;
+    std::atomic<int> numPlayers{0}; // membres liés à un siège
+    std::atomic<int> numSpectators{0};
+    std::atomic<bool> dirty{false}; // événement depuis le dernier état envoyé aux spectateurs
+    // Instant (µs, steady_clock) de l'appel de chaque siège ; 0 = pas de décision en attente
+    std::unique_ptr<std::atomic<int64_t>[]> turnAt;
+    int numSeats = 0;
+    // Session par siège (sous m) : jeton en cours, instant de la déconnexion de son titulaire
+    // et derniers numéros d'action vus (UDP ou WebSocket), gardés à travers une reprise
+    struct Session
+    {
+      uint64_t token = 0;
+      int64_t releasedAt = 0; // 0 : titulaire connecté
+      uint32_t seqTop = 0;    // plus grand numéro d'action accepté
+      uint64_t seqSeen = 0;   // bit i : numéro seqTop - i déjà accepté
+
+      // true si seq est nouveau (et le marque vu) ; trop ancien pour la fenêtre = doublon
+      bool accept_seq(uint32_t seq)
+      {
+        if (seq == 0)
+          return false;
+        if (seq > seqTop)
+        {
+          const uint32_t shift = seq - seqTop;
+          seqSeen = shift >= (uint32_t)kActionSeqWindow ? 1 : (seqSeen << shift) | 1;
+          seqTop = seq;
+          return true;
+        }
+        const uint32_t back = seqTop - seq;
+        if (back >= (uint32_t)kActionSeqWindow || (seqSeen >> back) & 1)
+          return false;
+        seqSeen |= 1ull << back;
+        return true;
+      }
+    };
+    std::vector<Session> sessions;
+    // Fin du délai de reprise par siège (roue des tables) : libère la session
+    std::unique_ptr<TimerWheel::Timer[]> graceTimers;
+  };
+
+  // Trames prêtes à l'envoi, une par encodage (nullptr si aucun client ne l'utilise)
+  struct FramePair
+  {
+    server::message_ptr text;
+    server::message_ptr bin;
+  };
+
+  // Trame à distribuer (table = -1 : toutes les connexions ; seat = -1 : toute la table)
+  struct Outgoing
+  {
+    FramePair msg;
+    FrameKind kind;
+    int table;
+    int seat;
+  };
+
+  FramePair frames(const WireMsg &m) const
+  {
+    FramePair f;
+    if (numText.load() > 0)
+      f.text = make_frame(m.json, websocketpp::frame::opcode::text);
+    if (numBinary.load() > 0)
+      f.bin = make_frame(m.bin, websocketpp::frame::opcode::binary);
+    return f;
+  }
+
+  // Construit la trame une seule fois : en-tête serveur (non masqué) identique pour tous,
+  // websocketpp l'envoie telle quelle à chaque destinataire (message "prepared").
+  static server::message_ptr make_frame(std::string_view text, websocketpp::frame::opcode::value op)
+  {
+    auto msg = std::make_shared<message_type>(con_msg_manager_type::ptr(), op, text.size());
+    msg->set_payload(text.data(), text.size());
+    std::string h;
+    h.push_back((char)(0x80 | op)); // FIN + opcode
+    const uint64_t n = text.size();
+    if (n < 126)
+    {
+      h.push_back((char)n);
+    }
+    else if (n <= 0xFFFF)
+    {
+      h.push_back((char)126);
+      h.push_back((char)(n >> 8));
+      h.push_back((char)(n & 0xFF));
+    }
+    else
+    {
+      h.push_back((char)127);
+      for (int i = 7; i >= 0; --i)
+        h.push_back((char)((n >> (8 * i)) & 0xFF));
+    }
+    msg->set_header(h);
+    msg->set_prepared(true);
+    return msg;
+  }
+
+  Group &lobby() { return *groups.back(); }
+
+  static void group_add(Group &g, const ConnPtr &c)
+  {
+    std::lock_guard<std::mutex> lk(g.m);
+    g.members.push_back(c);
+  }
+
+  static void erase_conn(std::vector<ConnPtr> &v, const ConnPtr &c)
+  {
+    auto it = std::find(v.begin(), v.end(), c);
+    if (it != v.end())
+    {
+      *it = std::move(v.back()); // ordre des membres sans importance
+      v.pop_back();
+    }
+  }
+
+  // Retire la connexion de son groupe actuel (salle d'attente, joueurs ou spectateurs d'une table).
+  // closing : connexion perdue, son siège reste réservé au jeton pendant kResumeGraceMs
+  // (minuterie de la roue, voir expire_session).
+  void detach(const ConnPtr &c, bool closing = false)
+  {
+    Group &g = c->table >= 0 ? *groups[c->table] : lobby();
+    std::lock_guard<std::mutex> lk(g.m);
+    if (c->spectator)
+    {
+      erase_conn(g.spectators, c);
+      g.numSpectators--;
+    }
+    else
+    {
+      erase_conn(g.members, c);
+      if (c->table >= 0)
+      {
+        g.numPlayers--;
+        const int s = c->seat.load();
+        if (closing && s >= 0 && s < g.numSeats && g.sessions[s].token == c->token)
+        {
+          g.sessions[s].releasedAt = steady_us();
+          tables->timers().arm(g.graceTimers[s], std::chrono::steady_clock::now() + std::chrono::milliseconds(kResumeGraceMs));
+        }
+      }
+    }
+  }
+
+  // Rappel de la roue (thread de la roue) : délai de reprise écoulé, le siège redevient libre et
+  // le jeton n'est plus valable. Revalidé sous verrou (reprise ou nouveau titulaire entre-temps).
+  void expire_session(int table, int seat)
+  {
+    Group &g = *groups[table];
+    std::lock_guard<std::mutex> lk(g.m);
+    Group::Session &ss = g.sessions[seat];
+    if (ss.token == 0 || ss.releasedAt == 0 || steady_us() - ss.releasedAt < kResumeGraceMs * 1000)
+      return;
+    ss = Group::Session{};
+    sessionsExpired.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Départ volontaire du siège (autre siège, spectateur) : le jeton n'est plus valable
+  void drop_session(const ConnPtr &c)
+  {
+    const int s = c->seat.load();
+    if (c->table < 0 || c->spectator || s < 0 || c->token == 0)
+      return;
+    release_session(c->table, s, c->token);
+    c->token = 0;
+  }
+
+  // Libère la session du siège si elle porte encore ce jeton (sinon reprise ou nouveau titulaire)
+  void release_session(int table, int s, uint64_t token)
+  {
+    if (table < 0 || s < 0 || token == 0)
+      return;
+    Group &g = *groups[table];
+    std::lock_guard<std::mutex> lk(g.m);
+    if (s < g.numSeats && g.sessions[s].token == token)
+      g.sessions[s] = Group::Session{};
+  }
+
+  static uint64_t new_token()
+  {
+    thread_local std::mt19937_64 rng(std::random_device{}());
+    uint64_t t = 0;
+    while (t == 0)
+      t = rng();
+    return t;
+  }
+
+  std::vector<ConnPtr> allConns()
+  {
+    std::vector<ConnPtr> out;
+    for (auto &g : groups)
+    {
+      std::lock_guard<std::mutex> lk(g->m);
+      out.insert(out.end(), g->members.begin(), g->members.end());
+      out.insert(out.end(), g->spectators.begin(), g->spectators.end());
+    }
+    return out;
+  }
+
+  // Nouvelle connexion : handlers propres à la connexion, exécutés sur son strand
+  void on_open(websocketpp::connection_hdl hdl)
+  {
+    server::connection_ptr con = ws.get_con_from_hdl(hdl);
+    auto c = std::make_shared<Conn>(ws.get_io_service(), hdl, con->get_subprotocol() == bin_proto::kSubprotocol,
+                                    nextConnId.fetch_add(1, std::memory_order_relaxed));
+    c->remote = con->get_remote_endpoint();
+    (c->binary ? numBinary : numText)++;
+    group_add(lobby(), c);
+    if (onTraffic)
+      asio::post(c->strand, [this, c]
+                 { onTraffic(TrafficKind::Open, c->id, c->binary ? bin_proto::kSubprotocol : ""); });
+    con->set_pong_handler([this, c](websocketpp::connection_hdl, std::string payload)
+                          { asio::post(c->strand, [this, c, payload = std::move(payload)]
+                                       { on_pong(c, payload); }); });
+    con->set_message_handler([this, c](websocketpp::connection_hdl, server::message_ptr msg)
+                             {
+      bytesIn.fetch_add(msg->get_payload().size(), std::memory_order_relaxed);
+      asio::post(c->strand, [this, c, msg]
+                 {
+        if (onTraffic)
+          onTraffic(msg->get_opcode() == websocketpp::frame::opcode::binary ? TrafficKind::InBinary : TrafficKind::InText,
+                    c->id, msg->get_payload());
+        handle_message(c, msg->get_opcode(), msg->get_payload()); }); });
+    con->set_close_handler([this, c](websocketpp::connection_hdl)
+                           { asio::post(c->strand, [this, c]
+                                        {
+              if (c->closed)
+                return;
+              c->closed = true;
+              if (onTraffic)
+                onTraffic(TrafficKind::Close, c->id, {});
+              queuedFrames.fetch_sub(c->queue.size(), std::memory_order_relaxed);
+              c->queue.clear();
+              detach(c, true);
+              {
+                std::lock_guard<std::mutex> lk(c->statsM);
+                if (c->stats.degraded)
+                  numDegradedConns--;
+              }
+              (c->binary ? numBinary : numText)--; }); });
+  }
+
+  // Appelé depuis n'importe quel thread (moteur, UI) : ajout en boîte d'envoi + un seul post
+  void enqueue(Outgoing out)
+  {
+    bool wake = false;
+    {
+      std::lock_guard<std::mutex> lk(outboxM);
+      outbox.push_back(std::move(out));
+      outboxDepth.store(outbox.size(), std::memory_order_relaxed);
+      wake = !outboxPosted;
+      outboxPosted = true;
+    }
+    if (wake && running.load())
+      asio::post(*distStrand, [this]
+                 { distribute(); });
+  }
+
+  // Sur distStrand (une distribution à la fois : l'ordre global des trames est conservé) :
+  // répartit la boîte d'envoi par connexion, puis un post par connexion sur son strand
+  void distribute()
+  {
+    std::vector<Outgoing> batch;
+    {
+      std::lock_guard<std::mutex> lk(outboxM);
+      batch.swap(outbox);
+      outboxPosted = false;
+      outboxDepth.store(0, std::memory_order_relaxed);
+    }
+    // Trames par destinataire, dans l'ordre du lot ; index par connexion (lot en O(messages x
+    // destinataires)). lastMsg : une connexion vue dans deux groupes pendant un changement de
+    // table (ajoutée à la nouvelle avant d'être retirée de l'ancienne) ne reçoit la trame qu'une fois
+    struct Pending
+    {
+      ConnPtr conn;
+      std::vector<Frame> frames;
+      size_t lastMsg;
+    };
+    std::vector<Pending> perConn;
+    std::unordered_map<const Conn *, size_t> index;
+    size_t msgNo = 0;
+    auto add = [&](const ConnPtr &c, const Outgoing &o)
+    {
+      const auto &msg = c->binary ? o.msg.bin : o.msg.text;
+      if (!msg)
+        return; // connexion ouverte après la construction de la trame
+      auto it = index.find(c.get());
+      if (it == index.end())
+      {
+        index.emplace(c.get(), perConn.size());
+        perConn.push_back(Pending{c, {Frame{msg, o.kind}}, msgNo});
+        return;
+      }
+      Pending &pc = perConn[it->second];
+      if (pc.lastMsg == msgNo)
+        return;
+      pc.lastMsg = msgNo;
+      pc.frames.push_back(Frame{msg, o.kind});
+    };
+    for (auto &o : batch)
+    {
+      ++msgNo;
+      const size_t first = o.table >= 0 ? (size_t)o.table : 0;
+      const size_t last = o.table >= 0 ? first + 1 : groups.size();
+      for (size_t g = first; g < last && g < groups.size(); ++g)
+      {
+        std::lock_guard<std::mutex> lk(groups[g]->m);
+        for (auto &c : groups[g]->members)
+          if (o.seat < 0 || c->seat == o.seat)
+            add(c, o);
+      }
+    }
+    for (auto &pc : perConn)
+    {
+      ConnPtr c = pc.conn;
+      asio::post(c->strand, [this, c, frames = std::move(pc.frames)]() mutable
+                 {
+        if (c->closed)
+          return;
+        for (auto &f : frames)
+          push_frame(*c, std::move(f));
+        drain(c); });
+    }
+  }
+
+  // Politique client lent : un état complet plus récent remplace le précédent s'il est en queue de file ; file pleine -> déconnexion
+  void push_frame(Conn &ci, Frame f)
+  {
+    // Fusion seulement en queue de file : remplacer une trame plus ancienne ferait passer le
+    // nouvel état devant les trames mises en file après elle (ordre d'envoi inversé)
+    if (f.kind != FrameKind::Event && !ci.queue.empty() && ci.queue.back().kind == f.kind)
+    {
+      ci.queue.back() = std::move(f); // mise à jour périmée remplacée
+      return;
+    }
+    ci.queue.push_back(std::move(f));
+    queuedFrames.fetch_add(1, std::memory_order_relaxed);
+    // Plus longue file observée (max approché : deux strands peuvent se croiser, sans gravité)
+    if (ci.queue.size() > queueHighWater.load(std::memory_order_relaxed))
+      queueHighWater.store(ci.queue.size(), std::memory_order_relaxed);
+  }
+
+  // Strand de la connexion : envoie tant que le tampon websocketpp reste sous kMaxBufferedBytes
+  void drain(const ConnPtr &c)
+  {
+    Conn &ci = *c;
+    websocketpp::lib::error_code ec;
+    server::connection_ptr con = ws.get_con_from_hdl(ci.hdl, ec);
+    if (ec || !con)
+      return;
+
+    while (!ci.queue.empty() && con->get_buffered_amount() < kMaxBufferedBytes)
+    {
+      const server::message_ptr &msg = ci.queue.front().msg;
+      bytesOut.fetch_add(msg->get_header().size() + msg->get_payload().size(), std::memory_order_relaxed);
+      framesOut.fetch_add(1, std::memory_order_relaxed);
+      if (onTraffic)
+        onTraffic(ci.binary ? TrafficKind::OutBinary : TrafficKind::OutText, ci.id, msg->get_payload());
+      con->send(msg);
+      ci.queue.pop_front();
+      queuedFrames.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    if (ci.queue.size() > kMaxQueuedFrames)
+    {
+      queuedFrames.fetch_sub(ci.queue.size(), std::memory_order_relaxed);
+      ci.queue.clear();
+      slowDisconnects.fetch_add(1, std::memory_order_relaxed);
+      ws.close(ci.hdl, websocketpp::close::status::try_again_later, "client trop lent", ec);
+      return;
+    }
+    if (!ci.queue.empty() && !ci.retryArmed)
+    {
+      ci.retryArmed = true;
+      ws.set_timer(kRetryMs, [this, c](const websocketpp::lib::error_code &)
+                   { asio::post(c->strand, [this, c]
+                                {
+          c->retryArmed = false;
+          if (!c->closed)
+            drain(c); }); });
+    }
+  }
+
+  // Envoi direct (réponses de poignée de main) : strand de la connexion uniquement
+  void send_now(const ConnPtr &c, const WireMsg &m, FrameKind kind = FrameKind::Event)
+  {
+    push_frame(*c, Frame{c->binary ? make_frame(m.bin, websocketpp::frame::opcode::binary)
+                                   : make_frame(m.json, websocketpp::frame::opcode::text),
+                         kind});
+    drain(c);
+  }
+
+  void handle_message(const ConnPtr &c, websocketpp::frame::opcode::value op, const std::string &payload)
+  {
+    if (!tables)
+      return;
+    ParsedAction act;
+    if (op == websocketpp::frame::opcode::binary)
+    {
+      // Trame binaire : opcode sur le 1er octet (accepté sur toute connexion)
+      if (payload.empty())
+        return;
+      const auto *p = reinterpret_cast<const uint8_t *>(payload.data());
+      switch (p[0])
+      {
+      case bin_proto::Rejoindre:
+        act.action = WsAction::Rejoindre;
+        if (payload.size() > 1)
+          act.table = p[1];
+        if (payload.size() > 2 && p[2] != 0xFF)
+          act.siege = p[2];
+        break;
+      case bin_proto::TirerCarte:
+        act.action = WsAction::TirerCarte;
+        break;
+      case bin_proto::Pret:
+        act.action = WsAction::Pret;
+        break;
+      case bin_proto::Double:
+        act.action = WsAction::Double;
+        break;
+      case bin_proto::Rejouer:
+        act.action = WsAction::Rejouer;
+        break;
+      case bin_proto::Resync:
+        act.action = WsAction::Resync;
+        break;
+      case bin_proto::Regarder:
+        act.action = WsAction::Regarder;
+        if (payload.size() > 1)
+          act.table = p[1];
+        break;
+      case bin_proto::Reprendre:
+        act.action = WsAction::Reprendre;
+        for (size_t i = 0; i < 8 && 1 + i < payload.size(); ++i)
+          act.jeton |= (uint64_t)p[1 + i] << (8 * i);
+        break;
+      case bin_proto::Telemetrie:
+        if (!bin_proto::get_telemetry(p, payload.size(), act.telemetry))
+          return;
+        act.action = WsAction::Telemetrie;
+        break;
+      default:
+        return;
+      }
+      // Action de siège numérotée (repli après un envoi UDP non acquitté)
+      if (p[0] >= bin_proto::TirerCarte && p[0] <= bin_proto::Rejouer && payload.size() >= 5)
+        act.seq = (long long)p[1] | (long long)p[2] << 8 | (long long)p[3] << 16 | (long long)p[4] << 24;
+    }
+    else if (!parseAction(payload, act))
+    {
+      return; // inconnu ou malformé
+    }
+
+    if (act.action == WsAction::Rejoindre)
+    {
+      handle_join(c, act.table, act.siege);
+      return;
+    }
+    if (act.action == WsAction::Regarder)
+    {
+      handle_spectate(c, act.table);
+      return;
+    }
+    if (act.action == WsAction::Reprendre)
+    {
+      handle_resume(c, act.jeton);
+      return;
+    }
+    if (act.action == WsAction::Telemetrie)
+    {
+      record_telemetry(c, act.telemetry);
+      return;
+    }
+
+    // Siège lié à cette connexion
+    if (c->table < 0)
+      return;
+    if (act.seq > 0 && act.action != WsAction::Resync)
+    {
+      // Même numéro déjà reçu par UDP (acquittement perdu) : ne pas rejouer l'action
+      if (!accept_seq(c, (uint32_t)act.seq))
+        return;
+      seqViaWs.fetch_add(1, std::memory_order_relaxed);
+    }
+    play(c, act.action);
+  }
+
+  // Action du siège lié (WebSocket ou UDP), sur le strand de la connexion
+  void play(const ConnPtr &c, WsAction action)
+  {
+    if (c->table < 0)
+      return;
+    const Conn &ci = *c;
+
+    if (ci.seat >= 0 && (action == WsAction::TirerCarte || action == WsAction::Pret ||
+                         action == WsAction::Stand || action == WsAction::Double))
+      record_decision(c);
+
+    switch (action)
+    {
+    case WsAction::Resync:
+      // Trou détecté côté client : état complet au seq courant
+      send_now(c, msg_snapshot(tables->snapshot(ci.table)), FrameKind::Snapshot);
+      break;
+    case WsAction::TirerCarte:
+      if (ci.seat >= 0) // pas de siège réclamé : lecture seule
+        tables->submit(ci.table, ci.seat, PlayerAction::Hit);
+      break;
+    case WsAction::Pret:
+    case WsAction::Stand:
+      if (ci.seat >= 0)
+        tables->submit(ci.table, ci.seat, PlayerAction::Stand);
+      break;
+    case WsAction::Double:
+      if (ci.seat >= 0)
+        tables->submit(ci.table, ci.seat, PlayerAction::DoubleDown);
+      break;
+    default:
+      break; // rejouer : la table relance seule après la pause
+    }
+  }
+
+  // Lie la connexion à un siège d'une table : demandé (siege >= 0) ou premier siège libre.
+  // Strand de la connexion ; la réservation du siège se fait sous le verrou du groupe de la table.
+  void handle_join(const ConnPtr &c, int table, int wanted)
+  {
+    if (table < 0)
+      table = 0;
+    const int numSeats = tables->humanSeats(table);
+    const bool moving = c->table != table || c->spectator;
+    // Place actuelle : rendue seulement si le nouveau siège est accordé (refus : siège et jeton gardés)
+    const int oldTable = c->table;
+    const int oldSeat = c->spectator ? -1 : c->seat.load();
+    const uint64_t oldToken = c->token;
+    uint64_t token = 0;
+    int seat = -1;
+    if (numSeats > 0)
+    {
+      Group &g = *groups[table];
+      std::lock_guard<std::mutex> lk(g.m);
+      auto taken = [&](int s)
+      {
+        for (auto &o : g.members)
+          if (o != c && o->seat == s)
+            return true;
+        // Titulaire déconnecté depuis peu : siège gardé pour sa reprise (jusqu'à expire_session)
+        const Group::Session &ss = g.sessions[s];
+        return ss.token != 0 && ss.releasedAt != 0;
+      };
+      if (wanted >= 0 && wanted < numSeats && !taken(wanted))
+        seat = wanted;
+      else if (wanted < 0)
+        for (int s = 0; s < numSeats && seat < 0; ++s)
+          if (!taken(s))
+            seat = s;
+      if (seat >= 0)
+      {
+        token = new_token(); // nouveau jeton à chaque attribution
+        c->seat = seat;
+        g.sessions[seat] = Group::Session{token, 0};
+        if (moving)
+        {
+          g.members.push_back(c);
+          g.numPlayers++;
+        }
+      }
+    }
+
+    if (seat < 0)
+    {
+      send_now(c, msg_siege_refuse());
+      return;
+    }
+    release_session(oldTable, oldSeat, oldToken); // même siège : déjà remplacée, sans effet
+    if (moving)
+      detach(c);
+    c->token = token;
+    set_place(c, table, false);
+    send_now(c, msg_siege_attribue(table, seat, token, udpPort));
+
+    // Point de départ du flux pour ce client : état complet au seq courant
+    send_now(c, msg_snapshot(tables->snapshot(table)), FrameKind::Snapshot);
+  }
+
+  // Spectateur d'une table : libère un éventuel siège, reçoit l'état complet puis à cadence fixe
+  void handle_spectate(const ConnPtr &c, int table)
+  {
+    if (table < 0)
+      table = 0;
+    if (table >= tables->numTables())
+    {
+      send_now(c, msg_siege_refuse());
+      return;
+    }
+    if (!(c->spectator && c->table == table))
+    {
+      drop_session(c);
+      detach(c);
+      Group &g = *groups[table];
+      {
+        std::lock_guard<std::mutex> lk(g.m);
+        g.spectators.push_back(c);
+        g.numSpectators++;
+      }
+      c->seat = -1;
+      set_place(c, table, true);
+    }
+    send_now(c, msg_spectateur(table));
+    send_now(c, msg_snapshot(tables->snapshot(table)), FrameKind::Snapshot);
+  }
+
+  // Reprise après coupure : le jeton désigne le siège. Une connexion qui le tient encore (demi-
+  // ouverte : le serveur n'a pas vu la coupure) est évincée. Réponse immédiate : état compact
+  // du siège au seq courant, le flux reprend ensuite normalement. Jeton inconnu -> siege_refuse
+  // (le terminal se rabat sur "rejoindre").
+  void handle_resume(const ConnPtr &c, uint64_t token)
+  {
+    if (token == 0)
+    {
+      send_now(c, msg_siege_refuse());
+      return;
+    }
+    if (c->token != token)
+      drop_session(c);
+    const int oldTable = c->table;
+    const bool wasSpectator = c->spectator;
+    ConnPtr evicted;
+    int table = -1, seat = -1;
+    for (int t = 0; t < tables->numTables() && seat < 0; ++t)
+    {
+      Group &g = *groups[t];
+      std::lock_guard<std::mutex> lk(g.m);
+      for (int s = 0; s < g.numSeats; ++s)
+      {
+        if (g.sessions[s].token != token)
+          continue;
+        table = t;
+        seat = s;
+        for (auto &o : g.members)
+          if (o != c && o->seat == s)
+          {
+            o->seat = -1; // plus aucune trame de siège ni action acceptée pour l'ancienne
+            evicted = o;
+          }
+        if (oldTable != t || wasSpectator)
+        {
+          g.members.push_back(c);
+          g.numPlayers++;
+        }
+        g.sessions[s].releasedAt = 0;
+        c->seat = s;
+        break;
+      }
+    }
+
+    if (seat < 0)
+    {
+      send_now(c, msg_siege_refuse());
+      return;
+    }
+    tables->timers().cancel(groups[table]->graceTimers[seat]); // hors verrou de groupe (rappel)
+    if (oldTable != table || wasSpectator)
+      detach(c);
+    c->token = token;
+    set_place(c, table, false);
+    if (evicted)
+    {
+      websocketpp::lib::error_code ec;
+      ws.close(evicted->hdl, websocketpp::close::status::going_away, "session reprise", ec);
+    }
+    send_now(c, msg_reprise(table, seat, token, tables->snapshot(table)), FrameKind::Snapshot);
+  }
+
+  // Place de la connexion (strand) ; recopiée dans les statistiques lues hors strand
+  static void set_place(const ConnPtr &c, int table, bool spectator)
+  {
+    c->table = table;
+    c->spectator = spectator;
+    std::lock_guard<std::mutex> lk(c->statsM);
+    c->stats.table = table;
+    c->stats.spectator = spectator;
+  }
+
+  // Délai de décision : appel du siège (événement "tour") -> action reçue par le hub. Inclut le
+  // trajet descendant, le temps de réaction du joueur et le trajet montant. Une seule mesure par
+  // appel (double appui ignoré) ; un "tirer" suivi d'un nouvel appel relance la mesure.
+  void record_decision(const ConnPtr &c)
+  {
+    Group &g = *groups[c->table];
+    const int seat = c->seat.load();
+    if (seat >= g.numSeats)
+      return;
+    const int64_t t0 = g.turnAt[seat].exchange(0, std::memory_order_relaxed);
+    if (t0 == 0)
+      return;
+    const int64_t us = steady_us() - t0;
+    decisionHist.add(us);
+    std::lock_guard<std::mutex> lk(c->statsM);
+    c->stats.decision.add(us);
+  }
+
+  // Relevé périodique du terminal (quelques octets toutes les 5 s) : fenêtre de la connexion
+  void record_telemetry(const ConnPtr &c, const TelemetrySample &t)
+  {
+    telemetryReports.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lk(c->statsM);
+    c->stats.telemetry.add(t, steady_us());
+  }
+
+  // Ping WebSocket de chaque connexion toutes les kPingMs ; la charge utile porte l'instant
+  // d'envoi (µs), renvoyée telle quelle dans le pong.
+  void arm_ping_tick()
+  {
+    ws.set_timer(kPingMs, [this](const websocketpp::lib::error_code &ec)
+                 {
+      if (ec || !running.load())
+        return;
+      for (auto &c : allConns())
+        asio::post(c->strand, [this, c]
+                   { send_ping(c); });
+      arm_ping_tick(); });
+  }
+
+  void send_ping(const ConnPtr &c)
+  {
+    if (c->closed)
+      return;
+    websocketpp::lib::error_code ec;
+    server::connection_ptr con = ws.get_con_from_hdl(c->hdl, ec);
+    if (ec || !con)
+      return;
+    const int64_t now = steady_us();
+    char payload[sizeof now];
+    std::memcpy(payload, &now, sizeof now);
+    {
+      std::lock_guard<std::mutex> lk(c->statsM);
+      c->stats.missedPongs++; // remis à zéro par le pong
+    }
+    con->ping(std::string(payload, sizeof payload), ec);
+    update_degraded(c);
+  }
+
+  void on_pong(const ConnPtr &c, const std::string &payload)
+  {
+    if (c->closed || payload.size() != sizeof(int64_t))
+      return;
+    int64_t sent = 0;
+    std::memcpy(&sent, payload.data(), sizeof sent);
+    const int64_t rtt = steady_us() - sent;
+    if (rtt < 0)
+      return;
+    rttHist.add(rtt);
+    {
+      std::lock_guard<std::mutex> lk(c->statsM);
+      c->stats.rtt.add(rtt);
+      c->stats.missedPongs = 0;
+    }
+    update_degraded(c);
+  }
+
+  // Client dégradé : RTT p95 > kDegradedRttUs ou pings restés sans réponse. Journalisé aux
+  // transitions seulement ; sortie de l'état à la moitié du seuil (pas d'oscillation).
+  void update_degraded(const ConnPtr &c)
+  {
+    std::lock_guard<std::mutex> lk(c->statsM);
+    Conn::Stats &st = c->stats;
+    // Le ping qui vient de partir n'a pas encore pu recevoir son pong
+    const int missed = st.missedPongs - 1;
+    const uint32_t p95 = st.rtt.samples() >= kMinRttSamples ? st.rtt.percentile(0.95) : 0;
+    bool degraded = st.degraded;
+    if (!degraded && (p95 > kDegradedRttUs || missed >= kDegradedMissedPongs))
+      degraded = true;
+    else if (degraded && p95 <= kDegradedRttUs / 2 && missed < kDegradedMissedPongs)
+      degraded = false;
+    if (degraded == st.degraded)
+      return;
+    st.degraded = degraded;
+    (degraded ? numDegradedConns++ : numDegradedConns--);
+    std::cerr << "[WS] client " << c->remote << " (table " << st.table << ", siège " << c->seat.load()
+              << (degraded ? ") dégradé" : ") rétabli") << " : RTT p95 " << p95 / 1000 << " ms, "
+              << std::max(0, missed) << " pong(s) manquant(s)\n";
+  }
+
+  // Requête HTTP simple sur le port WebSocket
+  void on_http(websocketpp::connection_hdl hdl)
+  {
+    server::connection_ptr con = ws.get_con_from_hdl(hdl);
+    const std::string res = con->get_resource();
+    if (res != "/metrics" && res != "/")
+    {
+      con->set_status(websocketpp::http::status_code::not_found);
+      con->set_body("404\n");
+      return;
+    }
+    con->set_status(websocketpp::http::status_code::ok);
+    con->append_header("Content-Type", "text/plain; version=0.0.4; charset=utf-8");
+    con->set_body(render_metrics());
+  }
+
+  // Page de métriques (format texte Prometheus). Ne lit que des atomiques : ni verrou de table
+  // (Bridge), ni verrou de groupe ; un relevé ne retarde jamais le moteur.
+  std::string render_metrics()
+  {
+    std::string out;
+    out.reserve(4096);
+    char line[192];
+    auto metric = [&](const char *name, const char *type, const char *help)
+    {
+      std::snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+      out += line;
+    };
+    auto value = [&](const char *name, const char *labels, double v)
+    {
+      // Entiers exacts (compteurs), sinon 6 décimales
+      std::snprintf(line, sizeof(line), v == std::floor(v) && std::fabs(v) < 1e15 ? "%s%s %.0f\n" : "%s%s %.6f\n", name, labels, v);
+      out += line;
+    };
+
+    const int64_t now = steady_us();
+    const uint64_t rounds = tables->roundsPlayed();
+    // Débit depuis le relevé précédent (relevés concurrents : chacun prend sa propre fenêtre)
+    const int64_t prevUs = lastScrapeUs.exchange(now);
+    const uint64_t prevRounds = lastScrapeRounds.exchange(rounds);
+    const double uptime = (now - startUs) / 1e6;
+
+    metric("echoplay_uptime_seconds", "gauge", "Temps depuis le démarrage du hub");
+    value("echoplay_uptime_seconds", "", uptime);
+    metric("echoplay_rounds_total", "counter", "Manches jouées, toutes tables");
+    value("echoplay_rounds_total", "", (double)rounds);
+    metric("echoplay_rounds_per_second", "gauge", "Débit de manches (moyenne depuis le démarrage / depuis le relevé précédent)");
+    value("echoplay_rounds_per_second", "{fenetre=\"demarrage\"}", uptime > 0 ? rounds / uptime : 0);
+    value("echoplay_rounds_per_second", "{fenetre=\"releve\"}",
+          now > prevUs ? (double)(rounds - std::min(rounds, prevRounds)) * 1e6 / (double)(now - prevUs) : 0);
+    metric("echoplay_shuffles_total", "counter", "Sabots remélangés, toutes tables");
+    value("echoplay_shuffles_total", "", (double)tables->shuffles());
+    metric("echoplay_tables", "gauge", "Tables hébergées");
+    value("echoplay_tables", "", tables->numTables());
+
+    int spectators = 0, players = 0;
+    for (auto &g : groups)
+    {
+      spectators += g->numSpectators.load(std::memory_order_relaxed);
+      players += g->numPlayers.load(std::memory_order_relaxed);
+    }
+    metric("echoplay_connections", "gauge", "Connexions WebSocket ouvertes par encodage");
+    value("echoplay_connections", "{encodage=\"json\"}", numText.load());
+    value("echoplay_connections", "{encodage=\"binaire\"}", numBinary.load());
+    metric("echoplay_players", "gauge", "Connexions liées à un siège");
+    value("echoplay_players", "", players);
+    metric("echoplay_spectators", "gauge", "Connexions spectatrices");
+    value("echoplay_spectators", "", spectators);
+    metric("echoplay_degraded_clients", "gauge", "Clients à RTT dégradé ou pongs manquants");
+    value("echoplay_degraded_clients", "", numDegradedConns.load());
+
+    metric("echoplay_received_bytes_total", "counter", "Octets reçus des clients (charge utile)");
+    value("echoplay_received_bytes_total", "", (double)bytesIn.load(std::memory_order_relaxed));
+    metric("echoplay_sent_bytes_total", "counter", "Octets envoyés aux clients (en-tête + charge utile)");
+    value("echoplay_sent_bytes_total", "", (double)bytesOut.load(std::memory_order_relaxed));
+    metric("echoplay_sent_frames_total", "counter", "Trames envoyées aux clients");
+    value("echoplay_sent_frames_total", "", (double)framesOut.load(std::memory_order_relaxed));
+    metric("echoplay_outbox_depth", "gauge", "Diffusions en attente de répartition");
+    value("echoplay_outbox_depth", "", (double)outboxDepth.load(std::memory_order_relaxed));
+    metric("echoplay_send_queue_frames", "gauge", "Trames en file d'envoi, toutes connexions");
+    value("echoplay_send_queue_frames", "", (double)queuedFrames.load(std::memory_order_relaxed));
+    metric("echoplay_send_queue_max_frames", "gauge", "Plus longue file d'envoi observée pour une connexion");
+    value("echoplay_send_queue_max_frames", "", (double)queueHighWater.load(std::memory_order_relaxed));
+    metric("echoplay_slow_client_disconnects_total", "counter", "Clients déconnectés pour file d'envoi pleine");
+    value("echoplay_slow_client_disconnects_total", "", (double)slowDisconnects.load(std::memory_order_relaxed));
+
+    if (udpPort != 0)
+    {
+      metric("echoplay_seat_actions_total", "counter", "Actions numérotées (UDP ou repli WebSocket) par issue");
+      value("echoplay_seat_actions_total", "{issue=\"appliquee\"}", (double)udpApplied.load(std::memory_order_relaxed));
+      value("echoplay_seat_actions_total", "{issue=\"doublon\"}", (double)udpDuplicates.load(std::memory_order_relaxed));
+      value("echoplay_seat_actions_total", "{issue=\"refusee\"}", (double)udpRefused.load(std::memory_order_relaxed));
+      value("echoplay_seat_actions_total", "{issue=\"invalide\"}", (double)udpMalformed.load(std::memory_order_relaxed));
+      metric("echoplay_seat_actions_websocket_total", "counter", "Actions numérotées appliquées après repli sur le WebSocket");
+      value("echoplay_seat_actions_websocket_total", "", (double)seqViaWs.load(std::memory_order_relaxed));
+    }
+
+    metric("echoplay_decision_timeouts_total", "counter", "Décisions jouées d'office (rester) faute de réponse");
+    value("echoplay_decision_timeouts_total", "", (double)tables->autoStands());
+    metric("echoplay_sessions_expired_total", "counter", "Sièges libérés à la fin du délai de reprise");
+    value("echoplay_sessions_expired_total", "", (double)sessionsExpired.load(std::memory_order_relaxed));
+
+    metric("echoplay_telemetry_reports_total", "counter", "Relevés de télémétrie reçus des terminaux");
+    value("echoplay_telemetry_reports_total", "", (double)telemetryReports.load(std::memory_order_relaxed));
+
+    metric("echoplay_decision_latency_seconds", "histogram", "Appel du siège -> action reçue par le hub");
+    decisionHist.render(out, "echoplay_decision_latency_seconds");
+    metric("echoplay_rtt_seconds", "histogram", "Aller-retour ping/pong WebSocket");
+    rttHist.render(out, "echoplay_rtt_seconds");
+
+    metric("echoplay_thread_busy_seconds_total", "counter", "Temps de travail cumulé (hors attente)");
+    value("echoplay_thread_busy_seconds_total", "{thread=\"moteur\"}", tables->workerBusy().seconds());
+    for (auto &bm : busyMeters)
+    {
+      std::snprintf(line, sizeof(line), "echoplay_thread_busy_seconds_total{thread=\"%s\"} %.6f\n", bm.first, bm.second->seconds());
+      out += line;
+    }
+    return out;
+  }
+
+  // Numéro d'action reçu sur le WebSocket : false s'il a déjà été appliqué (UDP ou WebSocket).
+  // Sans session de siège (spectateur, salle d'attente), rien à dédoublonner.
+  bool accept_seq(const ConnPtr &c, uint32_t seq)
+  {
+    const int s = c->seat.load();
+    if (c->table < 0 || c->spectator || s < 0 || c->token == 0)
+      return true;
+    Group &g = *groups[c->table];
+    bool fresh = true;
+    {
+      std::lock_guard<std::mutex> lk(g.m);
+      if (s < g.numSeats && g.sessions[s].token == c->token)
+        fresh = g.sessions[s].accept_seq(seq);
+    }
+    (fresh ? udpApplied : udpDuplicates).fetch_add(1, std::memory_order_relaxed);
+    return fresh;
+  }
+
+  // Canal UDP : une seule réception en cours (gestionnaires jamais concurrents), acquittement
+  // envoyé aussitôt (5 octets, send_to ne bloque pas), action appliquée sur le strand de la
+  // connexion qui tient le siège.
+  void arm_udp_receive()
+  {
+    udp->async_receive_from(asio::buffer(udpBuf), udpFrom, [this](const asio::error_code &ec, size_t n)
+                           {
+      if (ec == asio::error::operation_aborted || !running.load())
+        return;
+      if (!ec)
+        on_udp(n);
+      arm_udp_receive(); });
+  }
+
+  void on_udp(size_t n)
+  {
+    const uint8_t *p = udpBuf.data();
+    if (n < 14 || p[0] != bin_proto::UdpAction || p[13] < bin_proto::TirerCarte || p[13] > bin_proto::Rejouer)
+    {
+      udpMalformed.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    uint64_t token = 0;
+    for (int i = 0; i < 8; ++i)
+      token |= (uint64_t)p[1 + i] << (8 * i);
+    const uint32_t seq = (uint32_t)p[9] | (uint32_t)p[10] << 8 | (uint32_t)p[11] << 16 | (uint32_t)p[12] << 24;
+    const uint8_t op = p[13];
+
+    // Le jeton désigne le siège (comme pour une reprise) ; titulaire connecté requis
+    ConnPtr target;
+    bool fresh = false;
+    for (int t = 0; t < tables->numTables() && !target; ++t)
+    {
+      Group &g = *groups[t];
+      std::lock_guard<std::mutex> lk(g.m);
+      for (int s = 0; s < g.numSeats; ++s)
+      {
+        if (g.sessions[s].token != token || g.sessions[s].releasedAt != 0)
+          continue;
+        for (auto &o : g.members)
+          if (o->seat == s)
+          {
+            target = o;
+            fresh = g.sessions[s].accept_seq(seq);
+            break;
+          }
+        break;
+      }
+    }
+
+    uint8_t reply[5] = {(uint8_t)(target ? bin_proto::UdpAck : bin_proto::UdpRefus), p[9], p[10], p[11], p[12]};
+    asio::error_code ec;
+    udp->send_to(asio::buffer(reply), udpFrom, 0, ec);
+    if (!target)
+    {
+      udpRefused.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    if (!fresh)
+    {
+      udpDuplicates.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    udpApplied.fetch_add(1, std::memory_order_relaxed);
+    const WsAction action = op == bin_proto::TirerCarte ? WsAction::TirerCarte
+                            : op == bin_proto::Pret     ? WsAction::Pret
+                            : op == bin_proto::Double   ? WsAction::Double
+                                                        : WsAction::Rejouer;
+    asio::post(target->strand, [this, target, action, op, p9 = p[9], p10 = p[10], p11 = p[11], p12 = p[12]]
+               {
+      if (target->closed)
+        return;
+      // Enregistré comme son équivalent WebSocket numéroté : rejouable tel quel
+      if (onTraffic)
+      {
+        const char frame[5] = {(char)op, (char)p9, (char)p10, (char)p11, (char)p12};
+        onTraffic(TrafficKind::InBinary, target->id, std::string_view(frame, 5));
+      }
+      play(target, action); });
+  }
+
+  // Cadence spectateurs : pour chaque table modifiée, un seul état construit (hors thread moteur)
+  // et une seule trame par encodage, partagée par tous ses spectateurs. Un spectateur lent garde
+  // au plus un état en file (FrameKind::Snapshot fusionné).
+  void arm_spectator_tick()
+  {
+    ws.set_timer(1000 / spectatorHz, [this](const websocketpp::lib::error_code &ec)
+                 {
+      if (ec || !running.load())
+        return;
+      spectator_tick();
+      arm_spectator_tick(); });
+  }
+
+  void spectator_tick()
+  {
+    for (int t = 0; t < tables->numTables(); ++t)
+    {
+      Group &g = *groups[t];
+      if (g.numSpectators.load() == 0 || !g.dirty.exchange(false))
+        continue;
+      {
+        std::lock_guard<std::mutex> lk(g.m);
+        viewers = g.spectators; // capacité réutilisée d'un tick à l'autre
+      }
+      FramePair f = frames(msg_snapshot(tables->snapshot(t)));
+      for (auto &c : viewers)
+      {
+        server::message_ptr msg = c->binary ? f.bin : f.text;
+        if (!msg)
+          continue;
+        asio::post(c->strand, [this, c, msg]
+                   {
+          if (c->closed)
+            return;
+          push_frame(*c, Frame{msg, FrameKind::Snapshot});
+          drain(c); });
+      }
+      viewers.clear();
+    }
+  }
+
+  server ws;
+  std::vector<std::thread> ioPool;
+  // Canal d'actions UDP (arm_udp_receive : une seule réception en cours)
+  std::unique_ptr<asio::ip::udp::socket> udp; // créée par start() si udpPort != 0
+  unsigned short udpPort = 0;
+  std::array<uint8_t, 64> udpBuf{};
+  asio::ip::udp::endpoint udpFrom;
+  // Groupes de connexions : groups[t] = table t, groups.back() = salle d'attente
+  std::vector<std::unique_ptr<Group>> groups;
+  std::vector<ConnPtr> viewers; // spectator_tick uniquement (chaîne de timers : jamais concurrent)
+  // Boîte d'envoi multi-producteurs, vidée sur distStrand
+  std::unique_ptr<asio::io_context::strand> distStrand;
+  std::mutex outboxM;
+  std::vector<Outgoing> outbox;
+  bool outboxPosted = false;
+  // Nb de connexions par encodage (évite de construire une trame que personne ne lira)
+  std::atomic<int> numText{0};
+  std::atomic<int> numBinary{0};
+  std::atomic<int> numDegradedConns{0};
+  std::atomic<uint32_t> nextConnId{1};
+  // Métriques (page HTTP) : compteurs atomiques uniquement, jamais le verrou d'une table
+  std::atomic<uint64_t> bytesIn{0};
+  std::atomic<uint64_t> bytesOut{0};
+  std::atomic<uint64_t> framesOut{0};
+  std::atomic<uint64_t> queuedFrames{0};   // trames en file, toutes connexions
+  std::atomic<uint64_t> queueHighWater{0}; // plus longue file d'une connexion
+  std::atomic<uint64_t> outboxDepth{0};    // boîte d'envoi en attente de distribution
+  std::atomic<uint64_t> slowDisconnects{0};
+  std::atomic<uint64_t> udpApplied{0};
+  std::atomic<uint64_t> udpDuplicates{0};
+  std::atomic<uint64_t> udpRefused{0};
+  std::atomic<uint64_t> udpMalformed{0};
+  std::atomic<uint64_t> seqViaWs{0};
+  std::atomic<uint64_t> sessionsExpired{0};
+  std::atomic<uint64_t> telemetryReports{0};
+  CounterHist decisionHist{100, 250, 500, 1000, 2500, 5000, 10000, 30000};
+  CounterHist rttHist{5, 10, 25, 50, 100, 250, 500, 1000};
+  std::vector<std::pair<const char *, const BusyMeter *>> busyMeters;
+  int64_t startUs = 0;
+  std::atomic<int64_t> lastScrapeUs{0};
+  std::atomic<uint64_t> lastScrapeRounds{0};
+  std::atomic<bool> running;
+  int spectatorHz = kSpectatorHz;
+  TableManager *tables;
+};
+
+// ============================= Banc d'essai : montée en charge =============================
+
+#ifdef BLACKJACK_WS_HUB_BENCH
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+// M clients locaux (4 sièges par table, sans pause) : chaque bot répond "pret" dès que son
+// siège est appelé. Mesure le temps de connexion + attribution des sièges, le débit de trames
+// livrées et de manches jouées, pour 1 thread asio puis ioThreads.
+struct BenchResult
+{
+  double connectMs = 0;
+  double framesPerSec = 0;
+  double roundsPerSec = 0;
+  int connected = 0;
+};
+
+static BenchResult runHubBench(int numConns, unsigned ioThreads, int seconds, unsigned short port)
+{
+  using client = websocketpp::client<websocketpp::config::asio_client>;
+  BenchResult res;
+
+  TableCfg tc;
+  tc.numHuman = 4;
+  tc.numAI = 0;
+  tc.pauseMs = 0;
+  TableManager tables((numConns + 3) / 4, tc, 1);
+  WsHub hub;
+  hub.start(port, &tables, ioThreads);
+  tables.start();
+
+  client c;
+  c.clear_access_channels(websocketpp::log::alevel::all);
+  c.clear_error_channels(websocketpp::log::elevel::all);
+  c.init_asio();
+  std::atomic<int> seated{0};
+  std::atomic<uint64_t> frames{0};
+  std::atomic<bool> counting{false};
+
+  const auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < numConns; ++i)
+  {
+    websocketpp::lib::error_code ec;
+    client::connection_ptr con = c.get_connection("ws://127.0.0.1:" + std::to_string(port) + "/", ec);
+    if (ec)
+      break;
+    const int table = i / 4, seat = i % 4;
+    con->set_open_handler([&c, table, seat](websocketpp::connection_hdl h)
+                          {
+      websocketpp::lib::error_code e;
+      c.send(h, "{\"action\":\"rejoindre\",\"table\":" + std::to_string(table) + ",\"siege\":" + std::to_string(seat) + "}",
+             websocketpp::frame::opcode::text, e); });
+    const std::string seatOk = "{\"action\":\"siege_attribue\"";
+    const std::string myTurn = "{\"action\":\"tour\",\"seq\":";
+    const std::string mySeat = "\"siege\":" + std::to_string(seat) + "}";
+    con->set_message_handler([&, seatOk, myTurn, mySeat](websocketpp::connection_hdl h, client::message_ptr msg)
+                             {
+      const std::string &p = msg->get_payload();
+      if (counting.load(std::memory_order_relaxed))
+        frames.fetch_add(1, std::memory_order_relaxed);
+      if (p.compare(0, seatOk.size(), seatOk) == 0)
+        seated.fetch_add(1);
+      else if (p.compare(0, myTurn.size(), myTurn) == 0 && p.size() >= mySeat.size() &&
+               p.compare(p.size() - mySeat.size(), mySeat.size(), mySeat) == 0)
+      {
+        websocketpp::lib::error_code e;
+        c.send(h, "{\"action\":\"pret\"}", websocketpp::frame::opcode::text, e);
+      } });
+    c.connect(con);
+  }
+  std::thread clientThread([&c]
+                           { c.run(); });
+
+  while (seated.load() < numConns && std::chrono::steady_clock::now() - t0 < std::chrono::seconds(10))
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  res.connectMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+  res.connected = seated.load();
+
+  const uint64_t rounds0 = tables.roundsPlayed();
+  const auto t1 = std::chrono::steady_clock::now();
+  counting = true;
+  std::this_thread::sleep_for(std::chrono::seconds(seconds));
+  counting = false;
+  const double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - t1).count();
+  res.framesPerSec = (double)frames.load() / dt;
+  res.roundsPerSec = (double)(tables.roundsPlayed() - rounds0) / dt;
+
+  tables.stop();
+  hub.stop();
+  c.stop();
+  clientThread.join();
+  return res;
+}
+
+// Vérifications hors réseau : décodage de la trame 0x88 (même disposition que l'ESP32,
+// src/websocket.cpp) et résumé d'une TelemetryWindow qui a fait le tour de son anneau
+static int checkTelemetry()
+{
+  int failures = 0;
+  auto expect = [&](bool ok, const char *what)
+  {
+    if (!ok)
+    {
+      ++failures;
+      std::cout << "ECHEC (télémétrie): " << what << "\n";
+    }
+  };
+
+  std::string f;
+  bin_proto::put_u8(f, bin_proto::Telemetrie);
+  bin_proto::put_le(f, 812, 4);
+  bin_proto::put_le(f, 4301, 4);
+  bin_proto::put_le(f, 14, 2);
+  bin_proto::put_le(f, 23110, 4);
+  bin_proto::put_le(f, 41002, 4);
+  bin_proto::put_le(f, 181204, 4);
+  bin_proto::put_le(f, 150332, 4);
+  bin_proto::put_u8(f, -61);
+  bin_proto::put_le(f, 65535, 2);
+  expect(f.size() == 30, "taille de la trame");
+  const auto *p = reinterpret_cast<const uint8_t *>(f.data());
+  TelemetrySample t;
+  expect(bin_proto::get_telemetry(p, f.size(), t), "trame complète refusée");
+  expect(t.loopAvgUs == 812 && t.loopMaxUs == 4301, "boucle_us / boucle_max_us");
+  expect(t.jpegCount == 14 && t.jpegAvgUs == 23110 && t.jpegMaxUs == 41002, "jpeg_n / jpeg_us / jpeg_max_us");
+  expect(t.heapFree == 181204 && t.heapMin == 150332, "tas_libre / tas_min");
+  expect(t.rssi == -61, "rssi négatif");
+  expect(t.reconnects == 65535, "reconnexions");
+  TelemetrySample u;
+  expect(!bin_proto::get_telemetry(p, 29, u), "trame tronquée acceptée");
+
+  // 15 relevés dans une fenêtre de 12 : seuls les relevés 4..15 comptent
+  TelemetryWindow w;
+  for (uint32_t i = 1; i <= 15; ++i)
+  {
+    TelemetrySample s;
+    s.loopAvgUs = i * 10;
+    s.loopMaxUs = i * 100;
+    s.jpegCount = i;
+    s.jpegAvgUs = i * 1000;
+    s.jpegMaxUs = i == 2 ? 999999 : i * 2000; // pic sorti de la fenêtre
+    s.heapFree = i == 9 ? 0 : 200000 - i * 1000; // 0 : champ absent, ignoré
+    s.heapMin = 150000;
+    s.rssi = i == 3 ? -90 : -40 - (int)i;        // pire rssi sorti de la fenêtre
+    s.reconnects = i / 5;
+    w.add(s, (int64_t)i * 5000000);
+  }
+  const TelemetryWindow::Summary r = w.summary(15 * 5000000 + 1200000);
+  expect(r.samples == 12 && r.reports == 15 && r.ageMs == 1200, "relevés / âge");
+  expect(r.loopAvgUs == 95 && r.loopMaxUs == 1500, "boucle sur la fenêtre");
+  expect(r.jpegCount == 114 && r.jpegAvgUs == 10754 && r.jpegMaxUs == 30000, "jpeg pondéré par le nombre de cartes");
+  expect(r.heapFree == 185000 && r.heapLow == 185000 && r.heapMin == 150000, "tas");
+  expect(r.rssi == -55 && r.rssiMin == -55, "rssi");
+  expect(r.reconnects == 3 && r.reconnectsWindow == 3, "reconnexions sur la fenêtre");
+
+  std::cout << "télémétrie: " << failures << " échec(s)\n";
+  return failures;
+}
+
+int main(int argc, char **argv)
+{
+  if (checkTelemetry() != 0)
+    return 1;
+  const int maxConns = argc > 1 ? std::max(4, std::atoi(argv[1])) : 256;
+  unsigned ioThreads = argc > 2 ? (unsigned)std::max(0, std::atoi(argv[2])) : 0;
+  const int seconds = argc > 3 ? std::max(1, std::atoi(argv[3])) : 3;
+  if (ioThreads == 0)
+    ioThreads = std::max(1u, std::thread::hardware_concurrency());
+
+  std::vector<unsigned> threadCounts = {1};
+  if (ioThreads > 1)
+    threadCounts.push_back(ioThreads);
+
+  unsigned short port = 18765;
+  std::cout << "conns  io_threads  connecté  connexion_ms  trames/s  manches/s\n";
+  for (unsigned th : threadCounts)
+    for (int n = 16; n <= maxConns; n *= 4)
+    {
+      BenchResult r = runHubBench(n, th, seconds, port++);
+      std::printf("%5d  %10u  %8d  %12.1f  %8.0f  %9.0f\n", n, th, r.connected, r.connectMs, r.framesPerSec, r.roundsPerSec);
+    }
+  return 0;
+}
+#endif
+
+/*
+Montée en charge (clients locaux, 4 sièges par table, bots "pret" immédiats) :
+    g++ -std=c++17 -O2 -DBLACKJACK_WS_HUB_BENCH blackjack_ws_hub.cpp -o ws_hub_bench -pthread
+Vérifie d'abord, hors réseau, le décodage de la télémétrie 0x88 et TelemetryWindow (code 1 si échec).
+    ./ws_hub_bench [connexions max (256)] [threads asio (0 = nb de coeurs)] [secondes (3)]
+Les clients partagent la machine : lancer avec moins de threads asio que de coeurs pour
+laisser de la place aux clients, ou comparer 1 thread vs N à charge égale.
+*/
@@ -0,0 +1,245 @@
+// blackjack_ws_recorder.cpp
+// Enregistrement du trafic WebSocket du hub (WsHub::onTraffic) dans un fichier compact, et
+// relecture de ce fichier (outil blackjack_replay).
+// - En-tête : configuration complète des tables (graine incluse) pour rejouer sur un serveur neuf.
+// - Un enregistrement par événement de connexion : ouverture, trame reçue / envoyée, fermeture ;
+//   numéro de connexion, horodatage (µs, delta depuis l'enregistrement précédent) et charge utile.
+// - Entiers en varint (LEB128) : ~4 octets d'en-tête par trame.
+// - Écriture sous verrou dans un FILE* tamponné (1 Mo) ; désactivé = aucun coût dans le hub.
+// À inclure après blackjack_ws_hub.cpp.
+// C++17
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//   Fichier : "EPREC1\n" [taille varint][en-tête texte "cle=valeur\n"...]
+//             puis enregistrements [type u8][connexion varint][delta µs varint][taille varint][octets]
+//   type : valeurs de TrafficKind (1 ouverture, 2 fermeture, 3/4 reçue texte/binaire, 5/6 envoyée)
+namespace rec_format
+{
+  static const char kMagic[] = "EPREC1\n";
+  constexpr size_t kMagicLen = sizeof(kMagic) - 1;
+
+  static void put_varint(std::string &out, uint64_t v)
+  {
+    while (v >= 0x80)
+    {
+      out.push_back((char)((v & 0x7F) | 0x80));
+      v >>= 7;
+    }
+    out.push_back((char)v);
+  }
+
+  static bool get_varint(std::string_view in, size_t &pos, uint64_t &v)
+  {
+    v = 0;
+    for (int shift = 0; shift < 64 && pos < in.size(); shift += 7)
+    {
+      const uint8_t b = (uint8_t)in[pos++];
+      v |= (uint64_t)(b & 0x7F) << shift;
+      if (!(b & 0x80))
+        return true;
+    }
+    return false;
+  }
+} // namespace rec_format
+
+// Configuration nécessaire pour reconstruire les mêmes tables
+static std::string describe_table_cfg(int numTables, const TableCfg &tc)
+{
+  char buf[512];
+  std::snprintf(buf, sizeof(buf),
+                "tables=%d\nhumans=%d\nai=%d\nseed=%llu\npause_ms=%d\ndecision_ms=%d\ndecks=%d\nshuffle_rounds=%d\n"
+                "dealer_hit=%d\nh17=%d\npayout=%.6f\nai_mc=%d\nmc_ms=%d\ndate=%lld\n",
+                numTables, tc.numHuman, tc.numAI, (unsigned long long)tc.seed, tc.pauseMs, tc.decisionMs, tc.cfg.numDecks,
+                tc.cfg.roundsBeforeShuffle, tc.cfg.dealerHitThreshold, tc.cfg.dealerHitsSoft17 ? 1 : 0,
+                tc.cfg.blackjackPayout, tc.aiMonteCarlo ? 1 : 0, tc.mc.budgetMs, (long long)std::time(nullptr));
+  return buf;
+}
+
+static void parse_table_cfg(std::string_view text, int &numTables, TableCfg &tc)
+{
+  while (!text.empty())
+  {
+    const size_t nl = text.find('\n');
+    const std::string_view line = text.substr(0, nl);
+    text = nl == std::string_view::npos ? std::string_view{} : text.substr(nl + 1);
+    const size_t eq = line.find('=');
+    if (eq == std::string_view::npos)
+      continue;
+    const std::string_view k = line.substr(0, eq);
+    const std::string v(line.substr(eq + 1));
+    if (k == "tables")
+      numTables = std::atoi(v.c_str());
+    else if (k == "humans")
+      tc.numHuman = std::atoi(v.c_str());
+    else if (k == "ai")
+      tc.numAI = std::atoi(v.c_str());
+    else if (k == "seed")
+      tc.seed = std::strtoull(v.c_str(), nullptr, 10);
+    else if (k == "pause_ms")
+      tc.pauseMs = std::atoi(v.c_str());
+    else if (k == "decision_ms")
+      tc.decisionMs = std::atoi(v.c_str());
+    else if (k == "decks")
+      tc.cfg.numDecks = std::atoi(v.c_str());
+    else if (k == "shuffle_rounds")
+      tc.cfg.roundsBeforeShuffle = std::atoi(v.c_str());
+    else if (k == "dealer_hit")
+      tc.cfg.dealerHitThreshold = std::atoi(v.c_str());
+    else if (k == "h17")
+      tc.cfg.dealerHitsSoft17 = v == "1";
+    else if (k == "payout")
+      tc.cfg.blackjackPayout = std::atof(v.c_str());
+    else if (k == "ai_mc")
+      tc.aiMonteCarlo = v == "1";
+    else if (k == "mc_ms")
+      tc.mc.budgetMs = std::atoi(v.c_str());
+  }
+}
+
+// ============================= Écriture =============================
+
+class TrafficRecorder
+{
+public:
+  ~TrafficRecorder() { close(); }
+
+  bool open(const std::string &path, int numTables, const TableCfg &tc)
+  {
+    std::lock_guard<std::mutex> lk(m);
+    f = std::fopen(path.c_str(), "wb");
+    if (!f)
+      return false;
+    std::setvbuf(f, nullptr, _IOFBF, 1 << 20);
+    const std::string cfg = describe_table_cfg(numTables, tc);
+    std::string head(rec_format::kMagic, rec_format::kMagicLen);
+    rec_format::put_varint(head, cfg.size());
+    head += cfg;
+    std::fwrite(head.data(), 1, head.size(), f);
+    lastUs = steady_us();
+    return true;
+  }
+
+  // À brancher sur WsHub::onTraffic (n'importe quel thread)
+  void record(TrafficKind kind, uint32_t conn, std::string_view payload)
+  {
+    std::lock_guard<std::mutex> lk(m);
+    if (!f)
+      return;
+    const int64_t now = steady_us();
+    line.clear();
+    line.push_back((char)kind);
+    rec_format::put_varint(line, conn);
+    rec_format::put_varint(line, (uint64_t)std::max<int64_t>(0, now - lastUs));
+    rec_format::put_varint(line, payload.size());
+    line.append(payload.data(), payload.size());
+    std::fwrite(line.data(), 1, line.size(), f);
+    lastUs = now;
+    ++count;
+  }
+
+  void close()
+  {
+    std::lock_guard<std::mutex> lk(m);
+    if (f)
+      std::fclose(f);
+    f = nullptr;
+  }
+
+  uint64_t records()
+  {
+    std::lock_guard<std::mutex> lk(m);
+    return count;
+  }
+
+private:
+  std::mutex m;
+  std::FILE *f = nullptr;
+  int64_t lastUs = 0;
+  std::string line; // tampon réutilisé
+  uint64_t count = 0;
+};
+
+// ============================= Lecture =============================
+
+struct TrafficRecord
+{
+  TrafficKind kind;
+  uint32_t conn;
+  int64_t tUs; // depuis le début de l'enregistrement
+  std::string payload;
+};
+
+struct Recording
+{
+  int numTables = 1;
+  TableCfg tcfg;
+  std::string header; // en-tête texte brut
+  std::vector<TrafficRecord> records;
+};
+
+// Charge un enregistrement complet. Un fichier tronqué (arrêt brutal du serveur) est accepté
+// jusqu'au dernier enregistrement entier.
+static bool load_recording(const std::string &path, Recording &out, std::string &err)
+{
+  std::FILE *f = std::fopen(path.c_str(), "rb");
+  if (!f)
+  {
+    err = "ouverture impossible : " + path;
+    return false;
+  }
+  std::string data;
+  char buf[1 << 16];
+  size_t n;
+  while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0)
+    data.append(buf, n);
+  std::fclose(f);
+
+  const std::string_view in(data);
+  if (in.substr(0, rec_format::kMagicLen) != std::string_view(rec_format::kMagic, rec_format::kMagicLen))
+  {
+    err = "pas un enregistrement EPREC1";
+    return false;
+  }
+  size_t pos = rec_format::kMagicLen;
+  uint64_t len = 0;
+  if (!rec_format::get_varint(in, pos, len) || pos + len > in.size())
+  {
+    err = "en-tête tronqué";
+    return false;
+  }
+  out.header.assign(in.substr(pos, len));
+  parse_table_cfg(out.header, out.numTables, out.tcfg);
+  pos += len;
+
+  int64_t t = 0;
+  while (pos < in.size())
+  {
+    TrafficRecord r;
+    r.kind = (TrafficKind)(uint8_t)in[pos++];
+    uint64_t conn = 0, dt = 0, size = 0;
+    if (!rec_format::get_varint(in, pos, conn) || !rec_format::get_varint(in, pos, dt) ||
+        !rec_format::get_varint(in, pos, size) || pos + size > in.size())
+      break; // fin tronquée
+    t += (int64_t)dt;
+    r.conn = (uint32_t)conn;
+    r.tUs = t;
+    r.payload.assign(in.substr(pos, size));
+    pos += size;
+    out.records.push_back(std::move(r));
+  }
+  return true;
+}
+
+/*
+Enregistrement (serveur) :
+    ./blackjack_server --humans=2 --record=salle.rec
+Relecture : voir blackjack_replay.cpp
+*/
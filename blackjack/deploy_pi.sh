@@ -9,11 +9,12 @@ ssh "$PI_HOST" "mkdir -p $REMOTE_DIR"
 
 # 2) Transférer sources + cartes
 rsync -av --delete \
-  blackjack_sdl_ui.cpp blackjack_engine.cpp PlayingCards/ \
+  blackjack_sdl_ui.cpp blackjack_engine.cpp blackjack_thread_pool.cpp blackjack_montecarlo.cpp \
+  blackjack_tables.cpp blackjack_ledger.cpp blackjack_shm.cpp blackjack_action_parser.cpp blackjack_ws_hub.cpp PlayingCards/ \
   "$PI_HOST:$REMOTE_DIR/"
 
 # 3) Compiler sur le Pi
-ssh "$PI_HOST" "cd $REMOTE_DIR && g++ -std=c++17 -O2 blackjack_sdl_ui.cpp -o blackjack_touch -lSDL2 -lSDL2_ttf -lSDL2_image -pthread"
+ssh "$PI_HOST" "cd $REMOTE_DIR && g++ -std=c++17 -O2 blackjack_sdl_ui.cpp -o blackjack_touch -lSDL2 -lSDL2_ttf -lSDL2_image -pthread -lrt"
 
 # 4) Lancer (plein écran)
 ssh "$PI_HOST" "$REMOTE_DIR/blackjack_touch --fullscreen"
@@ -29,11 +29,29 @@ echo
 echo "Compilation exemples:"
 echo "  # UI (Pi/Ubuntu) :"
 echo "  g++ -std=c++17 -O2 blackjack_sdl_ui.cpp -o blackjack_touch \\"
-echo "     -lSDL2 -lSDL2_ttf -lSDL2_image -lpthread"
+echo "     -lSDL2 -lSDL2_ttf -lSDL2_image -lpthread -lrt"
+echo
+echo "  # Serveur de table sans IHM (pas de SDL) :"
+echo "  g++ -std=c++17 -O2 blackjack_server.cpp -o blackjack_server -lpthread -lrt"
+echo "  # UI séparée du serveur : ./blackjack_server --shm puis ./blackjack_touch --shm"
+echo
+echo "  # Relecture d'un enregistrement du serveur (--record=FILE) :"
+echo "  g++ -std=c++17 -O2 blackjack_replay.cpp -o blackjack_replay -lpthread"
+echo
+echo "  # Essai du canal d'actions UDP sur lien à pertes (local) :"
+echo "  g++ -std=c++17 -O2 blackjack_udp_loss_test.cpp -o blackjack_udp_loss_test -lpthread"
+echo
+echo "  # Débit du registre des soldes (lancer sur la carte SD) :"
+echo "  g++ -std=c++17 -O2 -DBLACKJACK_LEDGER_BENCH blackjack_ledger.cpp -o ledger_bench -lpthread"
+echo
+echo "  # Latence UI <-> serveur par mémoire partagée :"
+echo "  g++ -std=c++17 -O2 -DBLACKJACK_SHM_BENCH blackjack_shm.cpp -o shm_bench -lpthread -lrt"
 echo
 echo "  # Client WS C++ (localhost) :"
 echo "  g++ -std=c++17 -O2 ws_test_client.cpp -o ws_test_client -lpthread"
+echo "  # Charge : ./blackjack_server --humans=4 --pause-ms=0 --tables=16 puis"
+echo "  #          ./ws_test_client --load 64 --tables 16 --duration 30 [--bin]"
 echo
 echo "Notes:"
 echo "  * WebSocket sans TLS (asio_no_tls) : pas besoin de libssl-dev."
-echo "  * Si besoin de corriger des fins de lignes Windows : dos2unix <fichier>."
\ No newline at end of file
+echo "  * Si besoin de corriger des fins de lignes Windows : dos2unix <fichier>."
@@ -5,8 +5,25 @@
 //   sudo apt install -y g++ libwebsocketpp-dev libasio-dev
 //   g++ -std=c++17 -O2 ws_test_client.cpp -o ws_test_client -lpthread
 // Usage:
-//   ./ws_test_client --host localhost --port 8765 --path /
-//   Commandes: hit | stand | double | pret | rejouer | help | quit
+//   ./ws_test_client --host localhost --port 8765 --path / [--table T] [--seat N] [--bin] [--watch]
+//                    [--resume JETON]
+//   Commandes: hit | stand | double | pret | rejouer | join [N] | watch | resume J | resync | help | quit
+//   À la connexion, le client réclame un siège ({"action":"rejoindre"}) : le serveur
+//   n'envoie la main et n'accepte les actions que pour ce siège.
+//   --bin demande le sous-protocole binaire "echoplay.bin" (trames reçues affichées en hex).
+//   --watch : spectateur de la table (état complet à cadence fixe, aucune action acceptée).
+//   --resume JETON : reprend le siège d'une session précédente (jeton reçu dans siege_attribue)
+//   au lieu d'en réclamer un ; simule la reconnexion d'un terminal après une coupure WiFi.
+// Mode charge (sans REPL) :
+//   ./ws_test_client --load N [--tables K] [--duration S] [--bin] [--host H] [--port P]
+//   N connexions sur un seul io_context, réparties sur K tables (connexion i -> table i % K,
+//   premier siège libre). Chaque bot joue seul : il suit ses cartes ("carte") et la carte
+//   visible du croupier ("manche"), et quand son siège est appelé ("tour") choisit
+//   tirer / rester / doubler selon la stratégie de base (sans séparation). Chaque action est
+//   horodatée : latence = envoi -> premier événement suivant de la table (conséquence de
+//   l'action). Une ligne par seconde (manches/s, actions/s, p50/p99) puis un bilan.
+//   Côté serveur : --humans=N --pause-ms=0 pour ne mesurer que le hub et le moteur. Au-delà
+//   d'environ 1000 connexions, relever la limite de descripteurs (ulimit -n).
 
 #define ASIO_STANDALONE
 #include <asio.hpp>
@@ -20,6 +37,13 @@
 #include <mutex>
 #include <sstream>
 #include <cctype>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <functional>
 
 using client = websocketpp::client<websocketpp::config::asio_client>;
 
@@ -38,29 +62,293 @@ static const char* HELP_TXT =
 "  double / d    -> {\"action\":\"double\"}\n"
 "  pret / p      -> {\"action\":\"pret\"}\n"
 "  rejouer / r   -> {\"action\":\"rejouer\"}\n"
+"  join [N] / j  -> {\"action\":\"rejoindre\",\"table\":T,\"siege\":N} (siège libre si N absent)\n"
+"  watch / w     -> {\"action\":\"regarder\",\"table\":T} (spectateur, libère le siège)\n"
+"  resume J      -> {\"action\":\"reprendre\",\"jeton\":\"J\"} (reprise de session)\n"
+"  resync        -> {\"action\":\"resync\"} (état complet de la table)\n"
 "  help          -> cette aide\n"
 "  quit / exit   -> fermer la connexion\n";
 
+// ============================= Mode charge =============================
+
+static int64_t now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Valeur d'une carte (indice 0..51, As = 11)
+static int card_value(int idx) {
+    const int r = idx % 13; // 0 = As, 1..9 = 2..10, 10..12 = figures
+    return r == 0 ? 11 : r >= 9 ? 10 : r + 1;
+}
+
+enum class BotMove { Hit, Stand, Double };
+
+// Stratégie de base (sabot, croupier reste sur 17, sans séparation) ; doubler sur 2 cartes seulement
+static BotMove basic_strategy(const std::vector<int>& cards, int dealer_up) {
+    int total = 0, aces = 0;
+    for (int c : cards) { total += card_value(c); if (c % 13 == 0) ++aces; }
+    while (total > 21 && aces > 0) { total -= 10; --aces; }
+    const bool soft = aces > 0;
+    const int d = dealer_up >= 0 ? card_value(dealer_up) : 10;
+    const bool can_double = cards.size() == 2;
+    auto dbl = [&](bool cond, BotMove other) { return cond && can_double ? BotMove::Double : other; };
+
+    if (soft) {
+        if (total >= 19) return BotMove::Stand;
+        if (total == 18) return d >= 3 && d <= 6 ? dbl(true, BotMove::Stand) : d <= 8 ? BotMove::Stand : BotMove::Hit;
+        if (total == 17) return dbl(d >= 3 && d <= 6, BotMove::Hit);
+        if (total >= 15) return dbl(d >= 4 && d <= 6, BotMove::Hit);
+        return dbl(d >= 5 && d <= 6, BotMove::Hit);
+    }
+    if (total >= 17) return BotMove::Stand;
+    if (total >= 13) return d <= 6 ? BotMove::Stand : BotMove::Hit;
+    if (total == 12) return d >= 4 && d <= 6 ? BotMove::Stand : BotMove::Hit;
+    if (total == 11) return dbl(d <= 10, BotMove::Hit);
+    if (total == 10) return dbl(d <= 9, BotMove::Hit);
+    if (total == 9) return dbl(d >= 3 && d <= 6, BotMove::Hit);
+    return BotMove::Hit;
+}
+
+// Entier qui suit "key": dans un objet JSON plat du hub ; def si absent
+static long long json_int(const std::string& p, const char* key, long long def = -1) {
+    const std::string k = std::string("\"") + key + "\":";
+    const size_t i = p.find(k);
+    if (i == std::string::npos) return def;
+    return std::strtoll(p.c_str() + i + k.size(), nullptr, 10);
+}
+
+static uint32_t le32(const std::string& p, size_t i) {
+    uint32_t v = 0;
+    for (int b = 0; b < 4; ++b) v |= (uint32_t)(uint8_t)p[i + b] << (8 * b);
+    return v;
+}
+
+// Percentile p (0..1) d'un échantillon trié
+static double pct_ms(const std::vector<uint32_t>& v, double p) {
+    if (v.empty()) return 0;
+    const size_t i = std::min(v.size() - 1, (size_t)(p * (double)(v.size() - 1) + 0.5));
+    return v[i] / 1000.0;
+}
+
+static int run_load(const std::string& uri, int n, int num_tables, int seconds, bool bin) {
+    // Tout s'exécute sur le thread de c.run() : état des bots et compteurs sans verrou
+    struct Bot {
+        websocketpp::connection_hdl hdl;
+        int table = -1;
+        int seat = -1;
+        int dealer_up = -1;
+        std::vector<int> cards;
+        int64_t sent_us = 0; // action en attente de son premier événement (0 = aucune)
+    };
+    std::vector<Bot> bots((size_t)n);
+    std::vector<uint32_t> last_round((size_t)num_tables, 0);
+    std::vector<uint32_t> lat_all, lat_tick;
+    lat_all.reserve((size_t)seconds * 20000);
+    uint64_t rounds = 0, hands = 0, actions = 0, frames = 0;
+    int seated = 0, refused = 0, failed = 0, open_conns = 0;
+    uint64_t tick_rounds = 0, tick_actions = 0;
+
+    client c;
+    c.clear_access_channels(websocketpp::log::alevel::all);
+    c.clear_error_channels(websocketpp::log::elevel::all);
+    c.init_asio();
+
+    auto play = [&](Bot& b) {
+        const BotMove m = basic_strategy(b.cards, b.dealer_up);
+        websocketpp::lib::error_code se;
+        if (bin) {
+            const uint8_t op = m == BotMove::Hit ? 0x81 : m == BotMove::Double ? 0x83 : 0x82;
+            c.send(b.hdl, &op, 1, websocketpp::frame::opcode::binary, se);
+        } else {
+            c.send(b.hdl, m == BotMove::Hit ? "{\"action\":\"tirer_carte\"}" : m == BotMove::Double ? "{\"action\":\"double\"}" : "{\"action\":\"pret\"}",
+                   websocketpp::frame::opcode::text, se);
+        }
+        if (se) return;
+        b.sent_us = now_us();
+        ++actions;
+    };
+
+    // Événement de la table : kind = manche / carte / tour / croupier / resultat
+    enum class Ev { Other, Seat, Refused, Round, Card, Turn, Dealer, Result };
+    auto on_event = [&](Bot& b, Ev ev, int seat, uint32_t round, int card) {
+        if (ev == Ev::Seat) { b.seat = seat; ++seated; return; }
+        if (ev == Ev::Refused) { ++refused; websocketpp::lib::error_code e; c.close(b.hdl, websocketpp::close::status::normal, "", e); return; }
+        if (ev == Ev::Other || b.seat < 0) return;
+        if (b.sent_us != 0) { // premier événement après l'action : sa conséquence
+            const uint32_t us = (uint32_t)std::min<int64_t>(now_us() - b.sent_us, UINT32_MAX);
+            lat_all.push_back(us);
+            lat_tick.push_back(us);
+            b.sent_us = 0;
+        }
+        switch (ev) {
+        case Ev::Round:
+            b.cards.clear();
+            b.dealer_up = card;
+            if ((size_t)b.table < last_round.size() && round > last_round[(size_t)b.table]) {
+                last_round[(size_t)b.table] = round;
+                ++rounds;
+            }
+            break;
+        case Ev::Card:
+            if (seat == b.seat) b.cards.push_back(card);
+            break;
+        case Ev::Turn:
+            if (seat == b.seat) play(b);
+            break;
+        case Ev::Result:
+            if (seat == b.seat) ++hands;
+            break;
+        default:
+            break;
+        }
+    };
+
+    auto on_message = [&](Bot& b, client::message_ptr msg) {
+        ++frames;
+        const std::string& p = msg->get_payload();
+        if (msg->get_opcode() == websocketpp::frame::opcode::binary) {
+            if (p.empty()) return;
+            const uint8_t op = (uint8_t)p[0];
+            const auto u8 = [&](size_t i) { return i < p.size() ? (int)(uint8_t)p[i] : -1; };
+            switch (op) {
+            case 0x01: on_event(b, Ev::Seat, u8(2), 0, -1); break;
+            case 0x02: on_event(b, Ev::Refused, -1, 0, -1); break;
+            case 0x10: if (p.size() >= 10) on_event(b, Ev::Round, -1, le32(p, 5), u8(9)); break;
+            case 0x11: on_event(b, Ev::Card, u8(5), 0, u8(6)); break;
+            case 0x12: on_event(b, Ev::Turn, u8(5), 0, -1); break;
+            case 0x13: on_event(b, Ev::Dealer, -1, 0, u8(5)); break;
+            case 0x14: on_event(b, Ev::Result, u8(5), 0, -1); break;
+            default: on_event(b, Ev::Other, -1, 0, -1); break;
+            }
+            return;
+        }
+        const size_t a = p.find("\"action\":\"");
+        if (a == std::string::npos) return;
+        const size_t s = a + 10, e = p.find('"', s);
+        if (e == std::string::npos) return;
+        const std::string act = p.substr(s, e - s);
+        if (act == "siege_attribue") on_event(b, Ev::Seat, (int)json_int(p, "siege"), 0, -1);
+        else if (act == "siege_refuse") on_event(b, Ev::Refused, -1, 0, -1);
+        else if (act == "manche") on_event(b, Ev::Round, -1, (uint32_t)json_int(p, "round", 0), (int)json_int(p, "dealer_up"));
+        else if (act == "carte") on_event(b, Ev::Card, (int)json_int(p, "siege"), 0, (int)json_int(p, "carte"));
+        else if (act == "tour") on_event(b, Ev::Turn, (int)json_int(p, "siege"), 0, -1);
+        else if (act == "croupier") on_event(b, Ev::Dealer, -1, 0, (int)json_int(p, "carte"));
+        else if (act == "resultat") on_event(b, Ev::Result, (int)json_int(p, "siege"), 0, -1);
+        else on_event(b, Ev::Other, -1, 0, -1);
+    };
+
+    std::cout << "[Charge] " << n << " connexion(s) vers " << uri << ", " << num_tables << " table(s), "
+              << seconds << " s, " << (bin ? "binaire" : "JSON") << std::endl;
+    const int64_t t0 = now_us();
+    for (int i = 0; i < n; ++i) {
+        websocketpp::lib::error_code ec;
+        client::connection_ptr con = c.get_connection(uri, ec);
+        if (ec) {
+            std::cerr << "[ERR] get_connection: " << ec.message() << "\n";
+            return 1;
+        }
+        if (bin) con->add_subprotocol("echoplay.bin");
+        Bot& b = bots[(size_t)i];
+        b.table = i % num_tables;
+        con->set_open_handler([&c, &b, &open_conns](websocketpp::connection_hdl h) {
+            b.hdl = h;
+            ++open_conns;
+            websocketpp::lib::error_code se;
+            c.send(h, "{\"action\":\"rejoindre\",\"table\":" + std::to_string(b.table) + "}", websocketpp::frame::opcode::text, se);
+        });
+        con->set_fail_handler([&failed](websocketpp::connection_hdl) { ++failed; });
+        con->set_close_handler([&open_conns](websocketpp::connection_hdl) { --open_conns; });
+        con->set_message_handler([&on_message, &b](websocketpp::connection_hdl, client::message_ptr msg) { on_message(b, msg); });
+        c.connect(con);
+    }
+
+    // Relevé chaque seconde ; fermeture de toutes les connexions à la fin de la durée
+    int elapsed = 0;
+    std::function<void(const websocketpp::lib::error_code&)> tick = [&](const websocketpp::lib::error_code&) {
+        ++elapsed;
+        std::sort(lat_tick.begin(), lat_tick.end());
+        std::printf("[t+%3ds] %5d conn, %5d sièges  %8.1f manches/s  %9.1f actions/s  latence p50 %6.2f p99 %7.2f ms\n",
+                    elapsed, open_conns, seated, (double)(rounds - tick_rounds), (double)(actions - tick_actions),
+                    pct_ms(lat_tick, 0.50), pct_ms(lat_tick, 0.99));
+        std::fflush(stdout);
+        tick_rounds = rounds;
+        tick_actions = actions;
+        lat_tick.clear();
+        if (elapsed < seconds) {
+            c.set_timer(1000, tick);
+            return;
+        }
+        for (Bot& b : bots) {
+            websocketpp::lib::error_code e;
+            if (b.hdl.lock()) c.close(b.hdl, websocketpp::close::status::normal, "fin", e);
+        }
+        c.set_timer(2000, [&c](const websocketpp::lib::error_code&) { c.stop(); }); // fermetures lentes
+    };
+    c.set_timer(1000, tick);
+    c.run();
+
+    const double dt = (double)(now_us() - t0) / 1e6;
+    std::sort(lat_all.begin(), lat_all.end());
+    std::printf("[Bilan] %.1f s : %d siège(s), %d refusé(s), %d échec(s) de connexion\n", dt, seated, refused, failed);
+    std::printf("  manches  %10llu  (%.1f/s)   mains %llu (%.1f/s)\n", (unsigned long long)rounds, rounds / dt,
+                (unsigned long long)hands, hands / dt);
+    std::printf("  actions  %10llu  (%.1f/s)   trames reçues %llu (%.1f/s)\n", (unsigned long long)actions, actions / dt,
+                (unsigned long long)frames, frames / dt);
+    std::printf("  latence action -> événement : p50 %.2f  p95 %.2f  p99 %.2f  p99.9 %.2f  max %.2f ms (%zu mesures)\n",
+                pct_ms(lat_all, 0.50), pct_ms(lat_all, 0.95), pct_ms(lat_all, 0.99), pct_ms(lat_all, 0.999),
+                pct_ms(lat_all, 1.0), lat_all.size());
+    return seated > 0 ? 0 : 1;
+}
+
 int main(int argc, char** argv) {
     std::string host = "localhost";
     std::string path = "/";
     int port = 8765;
     // Permettre de choisir le mot pour Stand côté serveur ("pret" par défaut)
     std::string stand_word = "pret"; // changez en "stand" si nécessaire
+    int seat = -1;  // siège demandé à la connexion (-1 = premier libre)
+    int table = 0;  // table rejointe
+    bool bin = false; // demander le protocole binaire
+    bool watch = false; // spectateur au lieu de réclamer un siège
+    std::string resume; // jeton de session à reprendre à la connexion
+    int load = 0;       // mode charge : nb de connexions (0 = REPL)
+    int tables = 1;     // mode charge : tables réparties entre les bots
+    int duration = 30;  // mode charge : durée (s)
 
     for (int i=1; i<argc; ++i) {
         std::string a = argv[i];
         if (a == "--help" || a == "-h") {
-            std::cout << "Usage: " << argv[0] << " [--host H] [--port P] [--path /ws] [--stand-word pret|stand]\n";
+            std::cout << "Usage: " << argv[0] << " [--host H] [--port P] [--path /ws] [--stand-word pret|stand] [--table T] [--seat N] [--bin] [--watch] [--resume JETON]\n";
+            std::cout << "       " << argv[0] << " --load N [--tables K] [--duration S] [--bin] [--host H] [--port P]  (bots, sans REPL)\n";
             std::cout << HELP_TXT;
             return 0;
         } else if (a == "--host" && i+1 < argc) { host = argv[++i]; }
         else if (a == "--port" && i+1 < argc) { port = std::atoi(argv[++i]); }
         else if (a == "--path" && i+1 < argc) { path = argv[++i]; }
         else if (a == "--stand-word" && i+1 < argc) { stand_word = argv[++i]; }
+        else if (a == "--seat" && i+1 < argc) { seat = std::atoi(argv[++i]); }
+        else if (a == "--table" && i+1 < argc) { table = std::atoi(argv[++i]); }
+        else if (a == "--bin") { bin = true; }
+        else if (a == "--watch") { watch = true; }
+        else if (a == "--resume" && i+1 < argc) { resume = argv[++i]; }
+        else if (a == "--load" && i+1 < argc) { load = std::atoi(argv[++i]); }
+        else if (a == "--tables" && i+1 < argc) { tables = std::max(1, std::atoi(argv[++i])); }
+        else if (a == "--duration" && i+1 < argc) { duration = std::max(1, std::atoi(argv[++i])); }
     }
 
+    auto join_json = [&table](int s) {
+        std::string j = "{\"action\":\"rejoindre\",\"table\":" + std::to_string(table);
+        if (s >= 0) j += ",\"siege\":" + std::to_string(s);
+        return j + "}";
+    };
+    const std::string watch_json = "{\"action\":\"regarder\",\"table\":" + std::to_string(table) + "}";
+    auto resume_json = [](const std::string& jeton) {
+        return "{\"action\":\"reprendre\",\"jeton\":\"" + jeton + "\"}";
+    };
+
     std::stringstream uri; uri << "ws://" << host << ":" << port << path;
+    if (load > 0) return run_load(uri.str(), load, tables, duration, bin);
     std::cout << "[Connex] " << uri.str() << "\n";
 
     client c;
@@ -79,6 +367,10 @@ int main(int argc, char** argv) {
         connected.store(true);
         std::cout << "[OK] Connecté" << std::endl;
         std::cout << HELP_TXT;
+        websocketpp::lib::error_code se;
+        std::string j = !resume.empty() ? resume_json(resume) : watch ? watch_json : join_json(seat);
+        c.send(h, j, websocketpp::frame::opcode::text, se);
+        if (!se) std::cout << "--> " << j << std::endl;
     });
 
     c.set_fail_handler([&](websocketpp::connection_hdl){
@@ -96,7 +388,11 @@ int main(int argc, char** argv) {
         if (op == websocketpp::frame::opcode::text) {
             std::cout << "<-- " << msg->get_payload() << std::endl;
         } else {
-            std::cout << "<-- [binaire] " << msg->get_payload().size() << " octets" << std::endl;
+            const std::string& p = msg->get_payload();
+            char hex[4];
+            std::cout << "<-- [binaire] " << p.size() << " octets:";
+            for (unsigned char b : p) { std::snprintf(hex, sizeof(hex), " %02x", b); std::cout << hex; }
+            std::cout << std::endl;
         }
     });
 
@@ -106,6 +402,7 @@ int main(int argc, char** argv) {
         std::cerr << "[ERR] get_connection: " << ec.message() << "\n";
         return 1;
     }
+    if (bin) con->add_subprotocol("echoplay.bin");
 
     c.connect(con);
 
@@ -127,6 +424,11 @@ int main(int argc, char** argv) {
             else if (cmd == "d" || cmd == "double") json = "{\"action\":\"double\"}";
             else if (cmd == "p" || cmd == "pret") json = "{\"action\":\"pret\"}";
             else if (cmd == "r" || cmd == "rejouer") json = "{\"action\":\"rejouer\"}";
+            else if (cmd == "j" || cmd == "join") json = join_json(-1);
+            else if (cmd == "w" || cmd == "watch") json = watch_json;
+            else if (cmd == "resync") json = "{\"action\":\"resync\"}";
+            else if (cmd.rfind("resume ", 0) == 0) json = resume_json(trim_lower(cmd.substr(7)));
+            else if (cmd.rfind("join ", 0) == 0 || cmd.rfind("j ", 0) == 0) json = join_json(std::atoi(cmd.c_str() + cmd.find(' ') + 1));
             else if (cmd == "help") { std::cout << HELP_TXT; continue; }
             else { std::cout << "[!] Commande inconnue. Tapez 'help'.\n"; continue; }
 
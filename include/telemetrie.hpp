@@ -0,0 +1,60 @@
+#pragma once
+#include <Arduino.h>
+#include <cstdint>
+
+// Période d'envoi de la télémétrie au serveur (0 = désactivée)
+#ifndef TELEMETRIE_PERIODE_MS
+#define TELEMETRIE_PERIODE_MS 5000
+#endif
+
+// Durées (µs) relevées sur une période d'envoi : nombre, somme, maximum
+struct CompteurDuree
+{
+  uint32_t n = 0;
+  uint32_t sommeUs = 0; // bornée par la durée de la période : pas de débordement
+  uint32_t maxUs = 0;
+
+  void ajouter(uint32_t us)
+  {
+    n++;
+    sommeUs += us;
+    if (us > maxUs)
+      maxUs = us;
+  }
+
+  uint32_t moyenneUs() const { return n ? sommeUs / n : 0; }
+};
+
+// Télémétrie du terminal, alimentée par la boucle principale, l'affichage des cartes et le
+// client WebSocket, puis envoyée et remise à zéro par WebSocket à chaque période.
+// Champs fixes, aucune allocation : une mesure = deux lectures de micros() et trois opérations.
+// Tâche Arduino uniquement (les callbacks WebSocket s'exécutent dans ws.loop()).
+struct Telemetrie
+{
+  CompteurDuree boucle; // itérations de loop()
+  CompteurDuree jpeg;   // lecture SD + décodage + affichage d'une carte (drawJpg)
+  uint16_t reconnexions = 0; // connexions WebSocket rétablies depuis le démarrage
+
+  void nouvellePeriode()
+  {
+    boucle = CompteurDuree();
+    jpeg = CompteurDuree();
+  }
+};
+
+extern Telemetrie telemetrie;
+
+// Mesure la durée de la portée courante dans un compteur
+class ChronoTelemetrie
+{
+public:
+  explicit ChronoTelemetrie(CompteurDuree &c) : compteur(c), debut(micros()) {}
+  ~ChronoTelemetrie() { compteur.ajouter(micros() - debut); }
+
+  ChronoTelemetrie(const ChronoTelemetrie &) = delete;
+  ChronoTelemetrie &operator=(const ChronoTelemetrie &) = delete;
+
+private:
+  CompteurDuree &compteur;
+  uint32_t debut;
+};
@@ -1,21 +1,103 @@
 #pragma once
 
 #include <WebSocketsClient.h>
+#include <WiFiUdp.h>
 #include <vector>     // Pour std::vector
 #include <functional> // Pour std::function
 #include <ArduinoJson.h>
 
+#include "telemetrie.hpp"
+
 // Forward declarations pour éviter les dépendances complètes des fichiers d'en-tête LGFX_ESP32.hpp, gestion_cartes.hpp et menu.hpp
 class MainJoueur;
 class Menu;
 class LGFX;
 
+// Table et siège demandés au serveur lors de la connexion (-1 = premier siège libre)
+#ifndef WEBSOCKET_TABLE
+#define WEBSOCKET_TABLE 0
+#endif
+#ifndef WEBSOCKET_SIEGE
+#define WEBSOCKET_SIEGE -1
+#endif
+
+// Protocole binaire compact (sous-protocole "echoplay.bin") ; 0 = JSON uniquement
+#ifndef WEBSOCKET_BINAIRE
+#define WEBSOCKET_BINAIRE 1
+#endif
+
+// Heartbeat (ping toutes les WEBSOCKET_PING_MS, coupure après 2 pongs manqués) et reconnexion
+// à intervalle croissant (x2 par échec, de MIN à MAX ; remis à MIN à la connexion)
+#ifndef WEBSOCKET_PING_MS
+#define WEBSOCKET_PING_MS 500
+#endif
+#ifndef WEBSOCKET_PONG_MS
+#define WEBSOCKET_PONG_MS 300
+#endif
+#ifndef WEBSOCKET_RECONNEXION_MIN_MS
+#define WEBSOCKET_RECONNEXION_MIN_MS 50
+#endif
+#ifndef WEBSOCKET_RECONNEXION_MAX_MS
+#define WEBSOCKET_RECONNEXION_MAX_MS 5000
+#endif
+
+// Canal UDP des actions (si le serveur annonce un port dans siege_attribue) : chaque action
+// attend son acquittement WEBSOCKET_UDP_RTO_MS, est renvoyée jusqu'à WEBSOCKET_UDP_ESSAIS fois,
+// puis part sur le WebSocket avec le même numéro (le serveur écarte les doublons)
+#ifndef WEBSOCKET_UDP
+#define WEBSOCKET_UDP 1
+#endif
+#ifndef WEBSOCKET_UDP_RTO_MS
+#define WEBSOCKET_UDP_RTO_MS 40
+#endif
+#ifndef WEBSOCKET_UDP_ESSAIS
+#define WEBSOCKET_UDP_ESSAIS 4
+#endif
+#ifndef WEBSOCKET_UDP_PORT_LOCAL
+#define WEBSOCKET_UDP_PORT_LOCAL 8766
+#endif
+
+// Opcodes du protocole binaire (1er octet de chaque trame).
+// À garder synchronisé avec bin_proto dans blackjack/blackjack_ws_hub.cpp.
+namespace ProtoBin
+{
+  // Serveur -> terminal
+  constexpr uint8_t SiegeAttribue = 0x01; // [table][siege][jeton u64][port UDP u16, optionnel]
+  constexpr uint8_t SiegeRefuse = 0x02;
+  constexpr uint8_t Spectateur = 0x03;    // [table] (mode lecture seule, non utilisé par le terminal)
+  constexpr uint8_t Reprise = 0x04;       // [table][siege][jeton u64][seq][round][croupier][mise u16][a_jouer][n][cartes]
+  constexpr uint8_t Manche = 0x10;        // [seq u32 LE][round u32 LE][carte croupier]
+  constexpr uint8_t Carte = 0x11;         // [seq][siege][carte]
+  constexpr uint8_t Tour = 0x12;          // [seq][siege]
+  constexpr uint8_t Croupier = 0x13;      // [seq][carte]
+  constexpr uint8_t Resultat = 0x14;      // [seq][siege][total croupier][total joueur][delta i16 LE][resultat]
+  constexpr uint8_t Etat = 0x15;          // [seq][round][tour][croupier][mains][résultats] (voir hub)
+  // Terminal -> serveur
+  constexpr uint8_t Rejoindre = 0x80;     // [table][siege, 0xFF = premier libre]
+  constexpr uint8_t TirerCarte = 0x81;    // 0x81..0x84 : [seq u32 LE] optionnel (repli UDP)
+  constexpr uint8_t Pret = 0x82;
+  constexpr uint8_t Double = 0x83;
+  constexpr uint8_t Rejouer = 0x84;
+  constexpr uint8_t Resync = 0x85;
+  constexpr uint8_t Regarder = 0x86;      // [table]
+  constexpr uint8_t Reprendre = 0x87;     // [jeton u64 LE]
+  constexpr uint8_t Telemetrie = 0x88;    // [boucle_us u32][boucle_max_us u32][jpeg_n u16][jpeg_us u32]
+                                          // [jpeg_max_us u32][tas_libre u32][tas_min u32][rssi i8][reconnexions u16]
+  // Datagrammes UDP
+  constexpr uint8_t UdpAction = 0xA0;     // [jeton u64][seq u32][op 0x81..0x84]   terminal -> serveur
+  constexpr uint8_t UdpAck = 0xA1;        // [seq u32] reçue
+  constexpr uint8_t UdpRefus = 0xA2;      // [seq u32] session inconnue : passer par le WebSocket
+}
+
 // Enumération des actions WebSocket pour une meilleure lisibilité
 enum class ActionWebSocket
 {
   Pret,
   TirerCarte,
-  Rejouer
+  Rejouer,
+  Rejoindre,
+  Resync,
+  Reprendre
 };
 
 // Classe WebSocket : gère la connexion et les interactions avec le serveur WebSocket
@@ -34,6 +116,9 @@ public:
   // Envoie une action au serveur
   void envoyerAction(ActionWebSocket action);
 
+  // Siège attribué par le serveur (-1 tant que non attribué)
+  int obtenirSiege() const { return siege; }
+
   // Envoie un message JSON au serveur
   void envoyer(const JsonDocument &doc);
 
@@ -44,15 +129,72 @@ public:
   void onMainInitiale(std::function<void(std::vector<int>)> cb);
   void onCarteRecue(std::function<void(std::vector<int>)> cb);
   void onFinPartie(std::function<void(const String &resultat)> cb);
+  void onReprise(std::function<void(bool aJouer)> cb);
 
 private:
   WebSocketsClient ws;
+  int siege = -1;
+  bool binaire = false; // vrai dès la première trame binaire reçue (protocole négocié)
+
+  // Flux d'événements : dernier seq appliqué, état complet reçu, resync en cours
+  uint32_t seq = 0;
+  bool synchro = false;
+  bool resyncDemande = false;
+  std::vector<int> mainLocale; // cartes de notre siège pour la manche en cours
+
+  // Session : jeton reçu avec le siège, présenté à la reconnexion pour reprendre la main en cours
+  uint64_t jeton = 0;
+  bool repriseEnCours = false;
+  unsigned long delaiReconnexion = WEBSOCKET_RECONNEXION_MIN_MS;
+  unsigned long debutIntervalle = 0; // millis() du début de l'intervalle de reconnexion en cours
+  bool wifiConnecte = false;
+  bool dejaConnecte = false; // une connexion a déjà abouti : les suivantes sont des reconnexions
+
+  // Télémétrie : début de la période en cours
+  unsigned long debutTelemetrie = 0;
+
+  // Canal UDP des actions : numéro par jeton, actions en attente d'acquittement
+  struct ActionEnVol
+  {
+    uint32_t seq = 0; // 0 : emplacement libre
+    uint8_t op = 0;
+    uint8_t essais = 0;
+    unsigned long envoiMs = 0;
+  };
+  WiFiUDP udp;
+  uint16_t portUdp = 0; // 0 : serveur sans canal UDP
+  uint32_t seqAction = 0;
+  ActionEnVol enVol[4];
 
   // Callbacks pour les événements WebSocket
   std::function<void(std::vector<int>)> cbMainInitiale;
   std::function<void(std::vector<int>)> cbCarteRecue;
   std::function<void(const String &)> cbFinPartie;
+  std::function<void(bool)> cbReprise;
 
   // Gère les événements WebSocket reçus
   void onEvent(WStype_t type, uint8_t *payload, size_t length);
+
+  // Décode une trame du protocole binaire
+  void onBinaire(const uint8_t *payload, size_t length);
+
+  // Application des événements (communs JSON / binaire)
+  bool accepterSeq(uint32_t s);
+  void appliquerEtat(uint32_t s, const std::vector<int> &cartes, const String &resultat);
+  void appliquerManche();
+  void appliquerCarte(int siegeCarte, int carte);
+  void appliquerResultat(int siegeResultat, const String &resultat);
+  void appliquerReprise(int siegeRepris, uint32_t s, const std::vector<int> &cartes, bool aJouer);
+  void onSiegeRefuse();
+
+  // Canal UDP : envoi, acquittements, renvois et repli sur le WebSocket
+  bool envoyerUdp(uint8_t op);
+  void envoyerDatagramme(ActionEnVol &a);
+  void recevoirUdp();
+  void relancerUdp();
+  void envoyerActionNumerotee(uint8_t op, uint32_t s);
+  void nouvelleSession(uint64_t nouveauJeton, uint16_t port);
+
+  // Envoie le relevé de la période écoulée (toutes les TELEMETRIE_PERIODE_MS) puis le remet à zéro
+  void envoyerTelemetrie();
 };
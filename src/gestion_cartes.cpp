@@ -3,6 +3,7 @@
 
 #include "gestion_cartes.hpp"
 #include "menu.hpp"
+#include "telemetrie.hpp"
 // #include "websocket_client.hpp"  // pour le socket global
 
 // Initialise les attributs de la carte avec l'index, position x/y et état de sélection
@@ -31,7 +32,10 @@ void Carte::afficher(LGFX &tft)
     return;
   }
 
-  tft.drawJpg(&file, posX, posY);
+  {
+    ChronoTelemetrie chrono(telemetrie.jpeg);
+    tft.drawJpg(&file, posX, posY);
+  }
   file.close();
 }
 
@@ -8,6 +8,7 @@
 #include "audio.hpp"
 #include "hardware.hpp"
 #include "websocket.hpp"
+#include "telemetrie.hpp"
 
 LGFX tft;
 UnitTest test(tft);
@@ -16,6 +17,7 @@ Menu menuBas(tft);
 WebSocket wsClient;
 HardwareConfig Hardware(tft);
 EtatReseau IndicateurConnexion;
+Telemetrie telemetrie;
 
 unsigned long dernierRefresh = 0;
 const unsigned long intervalleRefresh = 500;
@@ -52,6 +54,7 @@ void setup()
 
 void loop()
 {
+  ChronoTelemetrie chrono(telemetrie.boucle); // durée de l'itération, y compris anti-rebond
   wsClient.actualiser();
 
   IndicateurConnexion.mettreAJour(tft, wsClient, menuBas); 
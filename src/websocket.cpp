@@ -1,4 +1,6 @@
+#include <WiFi.h>
 #include <WiFiClient.h>
+#include <cstdlib>
 #include <cstring>
 
 #include "LGFX_ESP32.hpp"
@@ -19,14 +21,49 @@ void WebSocket::demarrer()
     return;
   }
 
-  ws.begin(WEBSOCKET_HOST, WEBSOCKET_PORT, "/");
+  // Le sous-protocole "echoplay.bin" demande au serveur des trames binaires compactes ;
+  // un serveur qui l'ignore répond en JSON et le client reste en JSON.
+  ws.begin(WEBSOCKET_HOST, WEBSOCKET_PORT, "/", WEBSOCKET_BINAIRE ? "echoplay.bin" : "arduino");
   ws.onEvent([this](WStype_t type, uint8_t *payload, size_t length)
                  { this->onEvent(type, payload, length); });
+  // Lien mort détecté par les pings (sans attendre le timeout TCP), reconnexion rapide
+  ws.enableHeartbeat(WEBSOCKET_PING_MS, WEBSOCKET_PONG_MS, 2);
+  ws.setReconnectInterval(delaiReconnexion);
+  if (WEBSOCKET_UDP)
+    udp.begin(WEBSOCKET_UDP_PORT_LOCAL);
 }
 
 void WebSocket::actualiser()
 {
+  // La perte du WiFi est connue immédiatement : inutile d'attendre les pongs manqués.
+  // À son retour, reconnexion sans attendre la fin de l'intervalle en cours.
+  const bool wifi = WiFi.status() == WL_CONNECTED;
+  if (!wifi && wifiConnecte && ws.isConnected())
+    ws.disconnect();
+  if (wifi && !wifiConnecte)
+  {
+    delaiReconnexion = WEBSOCKET_RECONNEXION_MIN_MS;
+    ws.setReconnectInterval(delaiReconnexion);
+    debutIntervalle = millis();
+  }
+  wifiConnecte = wifi;
+
+  // La bibliothèque retente à chaque intervalle sans signaler les échecs : un intervalle écoulé
+  // sans connexion = un essai manqué, le suivant attend deux fois plus longtemps
+  if (!ws.isConnected() && millis() - debutIntervalle >= delaiReconnexion)
+  {
+    delaiReconnexion = min(delaiReconnexion * 2, (unsigned long)WEBSOCKET_RECONNEXION_MAX_MS);
+    ws.setReconnectInterval(delaiReconnexion);
+    debutIntervalle = millis();
+  }
   ws.loop();
+  if (WEBSOCKET_UDP)
+  {
+    recevoirUdp();
+    relancerUdp();
+  }
+  if (TELEMETRIE_PERIODE_MS > 0 && millis() - debutTelemetrie >= TELEMETRIE_PERIODE_MS)
+    envoyerTelemetrie();
 }
 
 // ========================================================
@@ -35,7 +72,28 @@ void WebSocket::actualiser()
 
 void WebSocket::envoyerAction(ActionWebSocket action)
 {
+  // Actions du siège : par UDP si le serveur l'a annoncé (pas de retransmission TCP)
+  const bool actionSiege = action == ActionWebSocket::Pret || action == ActionWebSocket::TirerCarte ||
+                           action == ActionWebSocket::Rejouer;
+  uint8_t op = ProtoBin::Pret;
+  if (action == ActionWebSocket::TirerCarte)
+    op = ProtoBin::TirerCarte;
+  else if (action == ActionWebSocket::Rejouer)
+    op = ProtoBin::Rejouer;
+  else if (action == ActionWebSocket::Resync)
+    op = ProtoBin::Resync;
+  if (WEBSOCKET_UDP && actionSiege && envoyerUdp(op))
+    return;
+
+  // Rejoindre / Reprendre partent à la connexion, avant de savoir si le binaire est actif
+  if (binaire && action != ActionWebSocket::Rejoindre && action != ActionWebSocket::Reprendre)
+  {
+    ws.sendBIN(&op, 1);
+    return;
+  }
+
   StaticJsonDocument<64> doc;
+  char hex[17];
 
   switch (action)
   {
@@ -48,6 +106,20 @@ void WebSocket::envoyerAction(ActionWebSocket action)
   case ActionWebSocket::Rejouer:
     doc["action"] = "rejouer";
     break;
+  case ActionWebSocket::Rejoindre:
+    doc["action"] = "rejoindre";
+    doc["table"] = WEBSOCKET_TABLE;
+    if (WEBSOCKET_SIEGE >= 0)
+      doc["siege"] = WEBSOCKET_SIEGE;
+    break;
+  case ActionWebSocket::Resync:
+    doc["action"] = "resync";
+    break;
+  case ActionWebSocket::Reprendre:
+    doc["action"] = "reprendre";
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)jeton);
+    doc["jeton"] = hex;
+    break;
   default:
     Serial.println("[WebSocket] ⚠️ Action inconnue");
     return;
@@ -63,6 +135,172 @@ void WebSocket::envoyer(const JsonDocument &doc)
   ws.sendTXT(buffer);
 }
 
+// Relevé de la période : trame de 30 octets (binaire) ou objet JSON plat, sans allocation.
+// Hors connexion, la période est simplement abandonnée (seul le compteur de reconnexions est cumulé).
+void WebSocket::envoyerTelemetrie()
+{
+  debutTelemetrie = millis();
+  if (!ws.isConnected())
+  {
+    telemetrie.nouvellePeriode();
+    return;
+  }
+
+  const uint32_t tasLibre = ESP.getFreeHeap();
+  const uint32_t tasMin = ESP.getMinFreeHeap();
+  const int rssi = WiFi.status() == WL_CONNECTED ? WiFi.RSSI() : 0;
+  const Telemetrie &t = telemetrie;
+
+  if (binaire)
+  {
+    uint8_t d[30];
+    size_t n = 0;
+    auto le = [&](uint32_t v, int octets)
+    {
+      for (int i = 0; i < octets; ++i)
+        d[n++] = (uint8_t)(v >> (8 * i));
+    };
+    d[n++] = ProtoBin::Telemetrie;
+    le(t.boucle.moyenneUs(), 4);
+    le(t.boucle.maxUs, 4);
+    le(min(t.jpeg.n, (uint32_t)0xFFFF), 2);
+    le(t.jpeg.moyenneUs(), 4);
+    le(t.jpeg.maxUs, 4);
+    le(tasLibre, 4);
+    le(tasMin, 4);
+    d[n++] = (uint8_t)(int8_t)rssi;
+    le(t.reconnexions, 2);
+    ws.sendBIN(d, n);
+  }
+  else
+  {
+    StaticJsonDocument<256> doc;
+    doc["action"] = "telemetrie";
+    doc["boucle_us"] = t.boucle.moyenneUs();
+    doc["boucle_max_us"] = t.boucle.maxUs;
+    doc["jpeg_n"] = t.jpeg.n;
+    doc["jpeg_us"] = t.jpeg.moyenneUs();
+    doc["jpeg_max_us"] = t.jpeg.maxUs;
+    doc["tas_libre"] = tasLibre;
+    doc["tas_min"] = tasMin;
+    doc["rssi"] = rssi;
+    doc["reconnexions"] = t.reconnexions;
+    envoyer(doc);
+  }
+  telemetrie.nouvellePeriode();
+}
+
+// ========================================================
+// 📡 Canal UDP des actions
+// ========================================================
+
+// Réserve un numéro et envoie le datagramme ; false si le canal n'est pas utilisable
+bool WebSocket::envoyerUdp(uint8_t op)
+{
+  if (portUdp == 0 || jeton == 0 || siege < 0 || WiFi.status() != WL_CONNECTED)
+    return false;
+  for (ActionEnVol &a : enVol)
+  {
+    if (a.seq != 0)
+      continue;
+    a.seq = ++seqAction;
+    a.op = op;
+    a.essais = 0;
+    envoyerDatagramme(a);
+    return true;
+  }
+  return false; // trop d'actions sans acquittement : le WebSocket prend le relais
+}
+
+// [0xA0][jeton u64 LE][seq u32 LE][op]
+void WebSocket::envoyerDatagramme(ActionEnVol &a)
+{
+  uint8_t d[14];
+  d[0] = ProtoBin::UdpAction;
+  for (int i = 0; i < 8; ++i)
+    d[1 + i] = (uint8_t)(jeton >> (8 * i));
+  for (int i = 0; i < 4; ++i)
+    d[9 + i] = (uint8_t)(a.seq >> (8 * i));
+  d[13] = a.op;
+  udp.beginPacket(WEBSOCKET_HOST, portUdp);
+  udp.write(d, sizeof(d));
+  udp.endPacket();
+  a.essais++;
+  a.envoiMs = millis();
+}
+
+void WebSocket::recevoirUdp()
+{
+  while (udp.parsePacket() > 0)
+  {
+    uint8_t d[8];
+    const int n = udp.read(d, sizeof(d));
+    if (n < 5 || (d[0] != ProtoBin::UdpAck && d[0] != ProtoBin::UdpRefus))
+      continue;
+    const uint32_t s = (uint32_t)d[1] | ((uint32_t)d[2] << 8) | ((uint32_t)d[3] << 16) | ((uint32_t)d[4] << 24);
+    for (ActionEnVol &a : enVol)
+    {
+      if (a.seq != s)
+        continue;
+      // Refus : session inconnue du serveur (siège hors ligne), le WebSocket tranchera
+      if (d[0] == ProtoBin::UdpRefus)
+        envoyerActionNumerotee(a.op, a.seq);
+      a.seq = 0;
+    }
+  }
+}
+
+// Sans acquittement : renvoi du même numéro, puis repli sur le WebSocket
+void WebSocket::relancerUdp()
+{
+  for (ActionEnVol &a : enVol)
+  {
+    if (a.seq == 0 || millis() - a.envoiMs < WEBSOCKET_UDP_RTO_MS)
+      continue;
+    if (a.essais < WEBSOCKET_UDP_ESSAIS)
+    {
+      envoyerDatagramme(a);
+      continue;
+    }
+    Serial.printf("[WebSocket] ⚠️ Action %u sans acquittement UDP, envoi par le WebSocket\n", (unsigned)a.seq);
+    envoyerActionNumerotee(a.op, a.seq);
+    a.seq = 0;
+  }
+}
+
+// Même numéro que le datagramme : appliquée une seule fois quel que soit le canal arrivé premier
+void WebSocket::envoyerActionNumerotee(uint8_t op, uint32_t s)
+{
+  if (!ws.isConnected())
+  {
+    Serial.printf("[WebSocket] ⚠️ Action %u perdue (hors ligne)\n", (unsigned)s);
+    return;
+  }
+  if (binaire)
+  {
+    const uint8_t d[5] = {op, (uint8_t)s, (uint8_t)(s >> 8), (uint8_t)(s >> 16), (uint8_t)(s >> 24)};
+    ws.sendBIN(d, sizeof(d));
+    return;
+  }
+  StaticJsonDocument<64> doc;
+  doc["action"] = op == ProtoBin::TirerCarte ? "tirer_carte" : op == ProtoBin::Rejouer ? "rejouer" : "pret";
+  doc["seq"] = s;
+  envoyer(doc);
+}
+
+// Nouveau jeton : numérotation des actions remise à zéro (fenêtre de doublons propre au siège)
+void WebSocket::nouvelleSession(uint64_t nouveauJeton, uint16_t port)
+{
+  if (nouveauJeton != jeton)
+  {
+    seqAction = 0;
+    for (ActionEnVol &a : enVol)
+      a.seq = 0;
+  }
+  jeton = nouveauJeton;
+  portUdp = port;
+}
+
 // ========================================================
 // 🔗 Logique de jeu liée aux événements serveur
 // ========================================================
@@ -104,6 +342,15 @@ void WebSocket::callbackLogiqueJeu(MainJoueur &main, Menu &menu, LGFX &tft)
 
     menu.definirEtat(EtatPartie::Terminee);
     menu.afficherBoutonRejouer(); });
+
+  // Reprise après coupure : retour direct à la table (la main est redessinée par l'état reçu)
+  onReprise([&](bool aJouer)
+            {
+    tft.fillScreen(TFT_DARKGREEN);
+    menu.afficherActions();
+    menu.definirEtat(EtatPartie::EnCours);
+    if (aJouer)
+      Serial.println("[WebSocket] 🎯 Décision en attente"); });
 }
 
 // ========================================================
@@ -125,6 +372,11 @@ void WebSocket::onFinPartie(std::function<void(const String &resultat)> cb)
   cbFinPartie = cb;
 }
 
+void WebSocket::onReprise(std::function<void(bool aJouer)> cb)
+{
+  cbReprise = cb;
+}
+
 // ========================================================
 // 📥 Réception des événements WebSocket
 // ========================================================
@@ -135,13 +387,23 @@ void WebSocket::onEvent(WStype_t type, uint8_t *payload, size_t length)
   {
   case WStype_CONNECTED:
     Serial.println("[WebSocket] 🔌 Serveur détecté — en attente des joueurs");
+    delaiReconnexion = WEBSOCKET_RECONNEXION_MIN_MS;
+    ws.setReconnectInterval(delaiReconnexion);
+    if (dejaConnecte)
+      telemetrie.reconnexions++;
+    dejaConnecte = true;
+    // Jeton d'une session précédente : reprise du même siège (main en cours renvoyée aussitôt).
+    // Sinon, réclame un siège : le serveur n'envoie la main et n'accepte les actions que pour ce siège
+    repriseEnCours = jeton != 0;
+    envoyerAction(repriseEnCours ? ActionWebSocket::Reprendre : ActionWebSocket::Rejoindre);
     break;
 
   case WStype_TEXT:
   {
     Serial.printf("[ESP32] 📨 Reçu %.*s\n", (int)length, reinterpret_cast<char *>(payload));
 
-    StaticJsonDocument<512> doc;
+    // "etat" porte toutes les mains de la table : document plus large que les événements
+    StaticJsonDocument<1536> doc;
     DeserializationError err = deserializeJson(doc, payload, length);
     if (err)
     {
@@ -153,35 +415,67 @@ void WebSocket::onEvent(WStype_t type, uint8_t *payload, size_t length)
     if (!action)
       return;
 
-    if (strcmp(action, "main_initiale") == 0 && cbMainInitiale)
+    if (strcmp(action, "siege_attribue") == 0)
+    {
+      siege = doc["siege"] | -1;
+      nouvelleSession(strtoull(doc["jeton"] | "0", nullptr, 16), doc["udp"] | 0);
+      Serial.printf("[WebSocket] 💺 Table %d, siège attribué : %d\n", (int)(doc["table"] | 0), siege);
+    }
+    else if (strcmp(action, "siege_refuse") == 0)
+    {
+      onSiegeRefuse();
+    }
+    else if (strcmp(action, "reprise") == 0)
     {
-      std::vector<int> indices;
-      for (int i : doc["cartes"].as<JsonArray>())
-      {
-        indices.push_back(i);
-      }
-      cbMainInitiale(indices);
+      std::vector<int> cartes;
+      for (int i : doc["main"].as<JsonArray>())
+        cartes.push_back(i);
+      jeton = strtoull(doc["jeton"] | "0", nullptr, 16);
+      appliquerReprise(doc["siege"] | -1, doc["seq"] | 0u, cartes, doc["a_jouer"] | false);
     }
-    else if (strcmp(action, "carte_envoyee") == 0 && cbCarteRecue)
+    else if (strcmp(action, "etat") == 0)
     {
-      std::vector<int> indices;
-      for (int i : doc["cartes"].as<JsonArray>())
-      {
-        indices.push_back(i);
-      }
-      cbCarteRecue(indices);
+      std::vector<int> cartes;
+      if (siege >= 0)
+        for (int i : doc["mains"][siege].as<JsonArray>())
+          cartes.push_back(i);
+      String resultat;
+      for (JsonObject r : doc["resultats"].as<JsonArray>())
+        if ((r["siege"] | -1) == siege)
+          resultat = r["resultat"] | "";
+      appliquerEtat(doc["seq"] | 0u, cartes, resultat);
     }
-    else if (strcmp(action, "fin_partie") == 0 && cbFinPartie)
+    else if (accepterSeq(doc["seq"] | 0u))
     {
-      const char *resultat = doc["resultat"];
-      cbFinPartie(resultat ? String(resultat) : "");
+      if (strcmp(action, "manche") == 0)
+        appliquerManche();
+      else if (strcmp(action, "carte") == 0)
+        appliquerCarte(doc["siege"] | -1, doc["carte"] | -1);
+      else if (strcmp(action, "resultat") == 0)
+        appliquerResultat(doc["siege"] | -1, doc["resultat"] | "");
+      // "tour" et "croupier" : seq seulement (non affichés sur le terminal)
     }
 
     break;
   }
 
+  case WStype_BIN:
+    if (!binaire)
+      Serial.println("[WebSocket] ⚡ Protocole binaire actif");
+    binaire = true;
+    onBinaire(payload, length);
+    break;
+
   case WStype_DISCONNECTED:
-    Serial.println("[WebSocket] ❌ Déconnecté du serveur");
+    Serial.printf("[WebSocket] ❌ Déconnecté du serveur (nouvel essai dans %lu ms)\n", delaiReconnexion);
+    // Le jeton est conservé : la reconnexion reprendra le siège
+    debutIntervalle = millis();
+    repriseEnCours = false;
+    siege = -1;
+    binaire = false;
+    synchro = false;
+    resyncDemande = false;
+    mainLocale.clear();
     if (length > 0 && payload)
     {
       String reason = String((char *)payload, length);
@@ -194,3 +488,196 @@ void WebSocket::onEvent(WStype_t type, uint8_t *payload, size_t length)
     break;
   }
 }
+
+// ========================================================
+// 🔢 Flux d'événements numérotés
+// ========================================================
+
+// true si l'événement seq doit être appliqué ; demande l'état complet en cas de trou
+bool WebSocket::accepterSeq(uint32_t s)
+{
+  if (!synchro || s <= seq)
+    return false; // en attente de l'état complet, ou événement déjà couvert par celui-ci
+  if (s != seq + 1)
+  {
+    if (!resyncDemande)
+    {
+      Serial.printf("[WebSocket] ⚠️ Trou de séquence (%u -> %u), resynchronisation\n", (unsigned)seq, (unsigned)s);
+      envoyerAction(ActionWebSocket::Resync);
+      resyncDemande = true;
+    }
+    return false;
+  }
+  seq = s;
+  return true;
+}
+
+void WebSocket::appliquerEtat(uint32_t s, const std::vector<int> &cartes, const String &resultat)
+{
+  seq = s;
+  synchro = true;
+  resyncDemande = false;
+  mainLocale = cartes;
+  if (!mainLocale.empty() && cbMainInitiale)
+    cbMainInitiale(mainLocale);
+  if (resultat.length() > 0 && cbFinPartie)
+    cbFinPartie(resultat);
+}
+
+void WebSocket::appliquerManche()
+{
+  mainLocale.clear();
+}
+
+void WebSocket::appliquerCarte(int siegeCarte, int carte)
+{
+  if (siegeCarte != siege || carte < 0)
+    return;
+  mainLocale.push_back(carte);
+  // Deux cartes : main initiale complète ; ensuite, seule la nouvelle carte est dessinée
+  if (mainLocale.size() == 2 && cbMainInitiale)
+    cbMainInitiale(mainLocale);
+  else if (mainLocale.size() > 2 && cbCarteRecue)
+    cbCarteRecue(std::vector<int>{carte});
+}
+
+void WebSocket::appliquerResultat(int siegeResultat, const String &resultat)
+{
+  if (siegeResultat == siege && cbFinPartie)
+    cbFinPartie(resultat);
+}
+
+// Siège rendu par le serveur : le flux reprend à s + 1, comme après un état complet
+void WebSocket::appliquerReprise(int siegeRepris, uint32_t s, const std::vector<int> &cartes, bool aJouer)
+{
+  Serial.printf("[WebSocket] ♻️ Session reprise, siège %d\n", siegeRepris);
+  siege = siegeRepris;
+  repriseEnCours = false;
+  seq = s;
+  synchro = true;
+  resyncDemande = false;
+  mainLocale = cartes;
+  if (cbReprise)
+    cbReprise(aJouer);
+  if (!mainLocale.empty() && cbMainInitiale)
+    cbMainInitiale(mainLocale);
+}
+
+// Jeton expiré (siège repris par un autre) : on redemande un siège ; sinon, lecture seule
+void WebSocket::onSiegeRefuse()
+{
+  siege = -1;
+  if (repriseEnCours)
+  {
+    Serial.println("[WebSocket] ⚠️ Session expirée, nouveau siège demandé");
+    repriseEnCours = false;
+    jeton = 0;
+    envoyerAction(ActionWebSocket::Rejoindre);
+    return;
+  }
+  Serial.println("[WebSocket] ⚠️ Aucun siège disponible (lecture seule)");
+}
+
+void WebSocket::onBinaire(const uint8_t *p, size_t length)
+{
+  if (length == 0)
+    return;
+
+  static const char *const resultats[] = {"Defaite", "Egalite", "Victoire", "Blackjack"};
+  auto nomResultat = [&](uint8_t code)
+  { return code < 4 ? String(resultats[code]) : String(""); };
+  auto lireU32 = [&](size_t pos) -> uint32_t
+  { return (uint32_t)p[pos] | ((uint32_t)p[pos + 1] << 8) | ((uint32_t)p[pos + 2] << 16) | ((uint32_t)p[pos + 3] << 24); };
+  auto lireU64 = [&](size_t pos) -> uint64_t
+  { return (uint64_t)lireU32(pos) | ((uint64_t)lireU32(pos + 4) << 32); };
+  // Taille minimale de chaque trame à seq (opcode + seq + champs fixes)
+  auto valide = [&](size_t n)
+  { return length >= n; };
+
+  switch (p[0])
+  {
+  case ProtoBin::SiegeAttribue:
+    if (!valide(3))
+      return;
+    siege = p[2];
+    if (valide(11))
+      nouvelleSession(lireU64(3), valide(13) ? (uint16_t)(p[11] | (p[12] << 8)) : 0);
+    Serial.printf("[WebSocket] 💺 Table %d, siège attribué : %d\n", (int)p[1], siege);
+    break;
+
+  case ProtoBin::SiegeRefuse:
+    onSiegeRefuse();
+    break;
+
+  case ProtoBin::Reprise:
+  {
+    // [op][table][siege][jeton u64][seq][round][croupier][mise u16][a_jouer][n][cartes]
+    if (!valide(24) || !valide(24 + (size_t)p[23]))
+      return;
+    std::vector<int> cartes(p + 24, p + 24 + p[23]);
+    jeton = lireU64(3);
+    appliquerReprise(p[2], lireU32(11), cartes, p[22] != 0);
+    break;
+  }
+
+  case ProtoBin::Manche:
+    if (valide(10) && accepterSeq(lireU32(1)))
+      appliquerManche();
+    break;
+
+  case ProtoBin::Carte:
+    if (valide(7) && accepterSeq(lireU32(1)))
+      appliquerCarte(p[5], p[6]);
+    break;
+
+  case ProtoBin::Tour:
+    if (valide(6))
+      accepterSeq(lireU32(1));
+    break;
+
+  case ProtoBin::Croupier:
+    if (valide(6))
+      accepterSeq(lireU32(1));
+    break;
+
+  case ProtoBin::Resultat:
+    // [op][seq][siege][total croupier][total joueur][delta i16][resultat]
+    if (valide(11) && accepterSeq(lireU32(1)))
+      appliquerResultat(p[5], nomResultat(p[10]));
+    break;
+
+  case ProtoBin::Etat:
+  {
+    // [op][seq][round][tour][n][croupier][nb sièges]{[n][cartes]}[nb résultats]{6 octets}
+    if (!valide(11))
+      return;
+    const uint32_t s = lireU32(1);
+    size_t pos = 10;
+    pos += 1 + p[pos]; // cartes du croupier (non affichées)
+    if (pos >= length)
+      return;
+    const int nbSieges = p[pos++];
+    std::vector<int> cartes;
+    for (int i = 0; i < nbSieges; ++i)
+    {
+      if (pos >= length || pos + 1 + p[pos] > length)
+        return;
+      const int n = p[pos++];
+      for (int k = 0; k < n; ++k, ++pos)
+        if (i == siege)
+          cartes.push_back(p[pos]);
+    }
+    String resultat;
+    const int nbRes = pos < length ? p[pos++] : 0;
+    for (int i = 0; i < nbRes && pos + 6 <= length; ++i, pos += 6)
+      if (p[pos] == siege)
+        resultat = nomResultat(p[pos + 5]);
+    appliquerEtat(s, cartes, resultat);
+    break;
+  }
+
+  default:
+    Serial.printf("[WebSocket] ⚠️ Opcode binaire inconnu 0x%02X\n", p[0]);
+    break;
+  }
+}